@@ -0,0 +1,25 @@
+# local/config.mk. Build configuration for Egg.
+# This file is specific to this one build host, and does not get committed.
+# Generated by etc/tool/configure.sh at Sun Oct 18 03:12:56 UTC 2026
+
+NATIVE_TARGET:=linux
+run:linux-run
+edit:demo-edit
+WAMR_SDK=
+WABT_SDK=
+WASMLESS_CLANG:=1
+
+linux_CC:=gcc -c -MMD -O3 -Isrc -Werror -Wno-incompatible-library-redeclaration -Wno-builtin-declaration-mismatch
+linux_AS:=$(linux_CC) -xassembler-with-cpp
+linux_LD:=gcc 
+linux_LDPOST:=-lm -lz -lpthread -lX11 -lGLESv2 -lEGL
+linux_AR:=ar
+linux_OPT_ENABLE:=alsafd evdev xegl
+linux_RUN_ARGS:=--input-config=local/input
+
+eggdev_CC:=$(linux_CC)
+eggdev_LD:=$(linux_LD)
+eggdev_LDPOST:=$(linux_LDPOST)
+eggdev_OPT_ENABLE:=$(linux_OPT_ENABLE)
+
+TARGETS:=eggdev demo test linux
@@ -0,0 +1,48 @@
+#ifndef EGG_ROM_TOC_H
+#define EGG_ROM_TOC_H
+
+#define EGG_TID_custom1 16
+#define EGG_TID_custom2 17
+#define EGG_TID_words 18
+#define EGG_TID_FOR_EACH_CUSTOM \
+  _(custom1) \
+  _(custom2) \
+  _(words) \
+
+#define RID_image_appicon 1
+#define RID_image_font9_0020 2
+#define RID_image_font9_00a1 3
+#define RID_image_font9_0400 4
+#define RID_image_tiles8 5
+#define RID_image_font6_0020 8
+#define RID_image_cursive_0020 9
+#define RID_image_witchy_0020 10
+#define RID_image_bgtiles 11
+#define RID_image_bigvga 12
+#define RID_sound_backup 1
+#define RID_sound_jump 2
+#define RID_sound_cowbell 3
+#define RID_sound_tom 4
+#define RID_song_doors_without_walls 1
+#define RID_song_heart_of_stone 2
+#define RID_song_dust_devil 3
+#define RID_song_sky_gardening 4
+#define RID_song_treasure_of_the_deep 5
+#define RID_song_left_hook 6
+#define RID_song_last_word 7
+#define RID_song_win_battle 8
+#define RID_song_tendrils_underfoot 9
+#define RID_song_scholar 10
+#define RID_song_light_chambers 11
+#define RID_song_prettier_with_lights_out 12
+#define RID_song_fatal 13
+#define RID_song_fourteen_circles 14
+#define RID_song_nothing_lasts_forever 15
+#define RID_map_brand_new 2
+#define RID_map_newer 3
+#define RID_tilesheet_tiles8 5
+#define RID_tilesheet_bgtiles 11
+#define RID_words_birds 1
+#define RID_words_rock_formations 2
+
+#endif
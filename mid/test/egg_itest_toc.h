@@ -0,0 +1,86 @@
+/* egg_itest_toc.h
+ * Generated at Sun Oct 18 05:04:31 UTC 2026
+ */
+#ifndef EGG_ITEST_TOC_H
+#define EGG_ITEST_TOC_H
+
+int minify_whitespace();
+int minify_number();
+int minify_undefined();
+int minify_resolve_expressions();
+int minify_add_sub_precedence();
+int strings_get_indexed();
+int strings_get_bench();
+int rawimg_round_trip();
+int png_unfilter_all_filters();
+int image_force_rgba_fast_paths();
+int png_encode_effort_and_threads();
+int png_decode_bench();
+int png_encode_bench();
+int render_bench_gl_calls();
+int render_bench_soft();
+int render_soft_pixels();
+int render_soft_blend_exact();
+int eggrt_store_background_save();
+int eggrt_store_long_path();
+int rom_index_matches_bsearch();
+int rom_index_bench();
+int rom_toc_matches_reader();
+int texatlas_placement();
+int texatlas_evict_lru();
+int texatlas_failed_load();
+int synth_steal_policies();
+int synth_steal_only_when_needed();
+int synth_steal_fades();
+int synth_bench_voice_throughput();
+int synth_queue_stress();
+int synth_workers_overflow();
+int synth_preprint_song_drums();
+int synth_pan_stereo();
+int synth_pan_lifecycle();
+
+static const struct egg_itest {
+  int (*fn)();
+  const char *name;
+  const char *tags;
+  int enable;
+  const char *file;
+  int line;
+} egg_itestv[]={
+  {minify_whitespace,"minify_whitespace","",1,"test_minify_e2e.c",7},
+  {minify_number,"minify_number","",1,"test_minify_e2e.c",21},
+  {minify_undefined,"minify_undefined","",1,"test_minify_e2e.c",32},
+  {minify_resolve_expressions,"minify_resolve_expressions","",1,"test_minify_e2e.c",43},
+  {minify_add_sub_precedence,"minify_add_sub_precedence","",1,"test_minify_e2e.c",58},
+  {strings_get_indexed,"strings_get_indexed","",1,"test_strings.c",70},
+  {strings_get_bench,"strings_get_bench","bench",0,"test_strings.c",111},
+  {rawimg_round_trip,"rawimg_round_trip","",1,"test_rawimg.c",24},
+  {png_unfilter_all_filters,"png_unfilter_all_filters","",1,"test_png.c",89},
+  {image_force_rgba_fast_paths,"image_force_rgba_fast_paths","",1,"test_png.c",119},
+  {png_encode_effort_and_threads,"png_encode_effort_and_threads","",1,"test_png.c",152},
+  {png_decode_bench,"png_decode_bench","bench",0,"test_png.c",215},
+  {png_encode_bench,"png_encode_bench","bench",0,"test_png.c",241},
+  {render_bench_gl_calls,"render_bench_gl_calls","bench",0,"test_render_bench.c",142},
+  {render_bench_soft,"render_bench_soft","bench",0,"test_render_bench.c",151},
+  {render_soft_pixels,"render_soft_pixels","",1,"test_render_soft.c",19},
+  {render_soft_blend_exact,"render_soft_blend_exact","",1,"test_render_soft.c",94},
+  {eggrt_store_background_save,"eggrt_store_background_save","",1,"test_eggrt_store.c",39},
+  {eggrt_store_long_path,"eggrt_store_long_path","",1,"test_eggrt_store.c",74},
+  {rom_index_matches_bsearch,"rom_index_matches_bsearch","",1,"test_rom_index.c",41},
+  {rom_index_bench,"rom_index_bench","bench",0,"test_rom_index.c",71},
+  {rom_toc_matches_reader,"rom_toc_matches_reader","",1,"test_rom_toc.c",19},
+  {texatlas_placement,"texatlas_placement","",1,"test_texatlas.c",74},
+  {texatlas_evict_lru,"texatlas_evict_lru","",1,"test_texatlas.c",137},
+  {texatlas_failed_load,"texatlas_failed_load","",1,"test_texatlas.c",194},
+  {synth_steal_policies,"synth_steal_policies","",1,"test_synth_steal.c",38},
+  {synth_steal_only_when_needed,"synth_steal_only_when_needed","",1,"test_synth_steal.c",89},
+  {synth_steal_fades,"synth_steal_fades","",1,"test_synth_steal.c",116},
+  {synth_bench_voice_throughput,"synth_bench_voice_throughput","bench",0,"test_synth_bench.c",81},
+  {synth_queue_stress,"synth_queue_stress","bench",0,"test_synth_queue.c",81},
+  {synth_workers_overflow,"synth_workers_overflow","",1,"test_synth_queue.c",120},
+  {synth_preprint_song_drums,"synth_preprint_song_drums","",1,"test_synth_queue.c",153},
+  {synth_pan_stereo,"synth_pan_stereo","",1,"test_synth_pan.c",45},
+  {synth_pan_lifecycle,"synth_pan_lifecycle","",1,"test_synth_pan.c",88},
+};
+
+#endif
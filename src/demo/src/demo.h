@@ -35,6 +35,7 @@ extern struct g {
   int romc;
   struct graf graf;
   struct texcache texcache;
+  struct texatlas texatlas;
   struct font *font;
   int pvinput;
   struct menu *menuv[MENU_LIMIT];
@@ -47,6 +47,8 @@ int egg_client_init() {
   if (egg_get_rom(g.rom,g.romc)!=g.romc) return -1;
   strings_set_rom(g.rom,g.romc);
   
+  g.texatlas.graf=&g.graf;
+  
   if (!(g.font=font_new())) return -1;
   if (font_add_image_resource(g.font,0x0020,RID_image_font9_0020)<0) return -1;
   if (font_add_image_resource(g.font,0x00a1,RID_image_font9_00a1)<0) return -1;
@@ -23,6 +23,7 @@ static void aux_draw_scene(int dsttexid,int dstx,int dsty) {
   graf_draw_line(&g.graf,dstx+1,dsty+1,dstx+158,dsty+88,0xffffffff);
   graf_draw_line(&g.graf,dstx+158,dsty+1,dstx+1,dsty+88,0xffffffff);
   graf_draw_decal(&g.graf,texcache_get_image(&g.texcache,RID_image_tiles8),dstx+64,dsty+29,0,64,32,32,0);
+  graf_draw_image(&g.graf,&g.texatlas,RID_image_appicon,dstx+8,dsty+8,0);
   graf_set_output(&g.graf,1);
 }
  
@@ -180,6 +180,8 @@ int egg_input_configure();
  * egg_audio_event() allows you to send raw MIDI events into the bus.
  * Beware that they may conflict with the song; avoiding that is up to you.
  * (durms) is only used by the non-MIDI event 0x98, indicating Note On now and a deferred Note Off.
+ * Control Change 0xb0 with (a) 0x0a sets the channel's pan: (b) 0x00=left, 0x40=center, 0x7f=right.
+ * Pan applies to notes that start after it, and resets to center when a song starts.
  */
 void egg_play_sound(int rid);
 void egg_play_song(int rid,int force,int repeat);
@@ -189,6 +191,8 @@ void egg_audio_event(int chid,int opcode,int a,int b,int durms);
  * Platform will try to guess how far along the last delivered buffer is,
  * and report the actual song time coming out the speaker right now.
  * Obviously that will never be perfect.
+ * Song changes and playhead moves are delivered to the synthesizer at its next update,
+ * so for up to one audio buffer after egg_play_song or egg_audio_set_playhead, you may still read the old song's playhead.
  */
 double egg_audio_get_playhead();
 void egg_audio_set_playhead(double s);
@@ -230,6 +234,17 @@ int egg_texture_load_image(int texid,int rid);
  */
 int egg_texture_load_raw(int texid,int w,int h,int stride,const void *src,int srcc);
 
+/* Write an image resource into part of a texture that already has its size.
+ * The image goes at (x,y), and the rest of the (w,h) box is cleared to transparent. No blending.
+ * Fails without touching anything if the image is larger than (w,h) or the box isn't entirely inside the texture.
+ * Pending draws are flushed first, as with the other loads.
+ */
+int egg_texture_load_image_sub(int texid,int x,int y,int w,int h,int rid);
+
+/* Size of an image resource, without decoding its pixels.
+ */
+int egg_image_get_size(int *w,int *h,int rid);
+
 /* (tint) is RGBA, default zero. If A is zero, no effect.
  * (alpha) is 0..255, default 255.
  * Globals reset to (0,255) at the start of each render cycle.
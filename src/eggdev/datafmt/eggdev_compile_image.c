@@ -76,6 +76,18 @@ static int eggdev_imgcvt_inner(struct eggdev_imgcvt *ctx,int to_rom) {
     if (err!=-2) fprintf(stderr,"%s: Invalid image comment '%.*s'\n",ctx->res->path,ctx->res->commentc,ctx->res->comment);
     return -2;
   }
+  
+  /* Pre-decoded images from `eggdev pack --image-format=` are not for editing. Unpack them to PNG.
+   */
+  if (!to_rom&&!ctx->format) {
+    switch (image_format_guess(ctx->res->serial,ctx->res->serialc)) {
+      case IMAGE_FORMAT_rawimg:
+      case IMAGE_FORMAT_lzimg: {
+          ctx->format=IMAGE_FORMAT_png;
+          eggdev_res_set_format(ctx->res,"png",3);
+        } break;
+    }
+  }
   if (!ctx->format&&!ctx->pixelsize&&!ctx->hint) return 0;
   
   if (!(ctx->image=image_decode(ctx->res->serial,ctx->res->serialc))) {
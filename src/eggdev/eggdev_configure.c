@@ -1,10 +1,14 @@
 #include "eggdev_internal.h"
+#include "opt/image/image.h"
+#if !USE_mswin
+  #include <unistd.h>
+#endif
 
 /* --help=pack
  */
  
 static void eggdev_print_help_pack() {
-  fprintf(stderr,"\nUsage: %s pack -oROM DIRECTORY... [--schema=PATH...]\n\n",eggdev.exename);
+  fprintf(stderr,"\nUsage: %s pack -oROM DIRECTORY... [--schema=PATH...] [--image-format=png|rawimg|lzimg] [--image-report] [--png-effort=fast|default|max] [--jobs=INT]\n\n",eggdev.exename);
   fprintf(stderr,
     "Generate a ROM file from loose inputs.\n"
     "IDs within each input must be unique.\n"
@@ -12,6 +16,20 @@ static void eggdev_print_help_pack() {
     "--schema names C header files that can be scanned for symbols used in the resources.\n"
     "ROM files, executables, and HTML bundles are also accepted as input.\n"
     "So we also serve as the reverse of 'eggdev bundle'.\n"
+    "Output has a TOC appended, so native runtimes can find resources without reading the whole file.\n"
+    "\n"
+    "--image-format converts images to a pre-decoded format, trading ROM size for load time:\n"
+    "  png: Default, leave them as is.\n"
+    "  rawimg: Uncompressed pixels. Native runtime uploads RGBA straight from the ROM, no decode at all.\n"
+    "  lzimg: LZ4-style compressed pixels. Much faster to decode than PNG, usually larger.\n"
+    "Images named by iconImage or posterImage in metadata stay PNG, as do images with an explicit format in their name.\n"
+    "--image-report prints each image's size and decode time in all three formats.\n"
+    "\n"
+    "--png-effort applies wherever we encode PNG, ie images converted by comment. Any command accepts it.\n"
+    "  fast: No filter trials and light deflate. For iteration builds.\n"
+    "  default: Trial filters and maximum deflate, in row groups for large images.\n"
+    "  max: Also try alternate filter heuristics and zlib strategies, keep the smallest. For release builds.\n"
+    "--jobs is how many threads the PNG encoder may use. Default is the number of CPUs. Output is the same either way.\n"
     "\n"
   );
 }
@@ -179,6 +197,21 @@ static void eggdev_print_help_sound() {
   );
 }
 
+/* --help=render
+ */
+ 
+static void eggdev_print_help_render() {
+  fprintf(stderr,"\nUsage: %s render ROM|DIRECTORY [-oDIRECTORY] [--jobs=INT] [--audio-rate=HZ] [--audio-chanc=1|2]\n\n",eggdev.exename);
+  fprintf(stderr,
+    "Print every song and sound to PCM, in parallel, each with its own synthesizer.\n"
+    "Prints one line per resource to stdout: Length, render time, speed relative to real time, peak level in dBFS, and the most voices running at once.\n"
+    "Levels are as the runtime would play them. Peaks above 0 dB are marked CLIPPED.\n"
+    "With '-o', also write each as a WAV file named like 'song-RID-NAME.wav'.\n"
+    "--jobs defaults to the number of CPUs. Default rate is 44100, mono.\n"
+    "\n"
+  );
+}
+
 /* --help=macicon
  */
 
@@ -213,7 +246,7 @@ static void eggdev_print_help_default() {
   fprintf(stderr,"\nUsage: %s COMMAND -oOUTPUT [INPUT...] [OPTIONS]\n\n",eggdev.exename);
   fprintf(stderr,
     "Try --help=COMMAND for more detail:\n"
-    "      pack -oROM DIRECTORY... [--schema=PATH...]\n"
+    "      pack -oROM DIRECTORY... [--schema=PATH...] [--image-format=png|rawimg|lzimg] [--image-report] [--png-effort=fast|default|max] [--jobs=INT]\n"
     "    unpack -oDIRECTORY ROM|EXE|HTML [--raw] [--schema=PATH...]\n"
     "    bundle -oEXE|HTML ROM [LIB|--recompile]\n"
     "      list ROM|EXE|HTML|DIRECTORY [-fFORMAT]\n"
@@ -224,6 +257,7 @@ static void eggdev_print_help_default() {
     "   project\n"
     "  metadata ROM [--lang=all|LANG] [--iconImage] [--posterImage]\n"
     "     sound [ROM TYPE:ID] [FILE] [-oPATH] [--audio=DRIVER] [--audio-rate=HZ] [--audio-chanc=1|2] [--audio-buffer=INT] [--audio-device=STRING] [--repeat]\n"
+    "    render ROM|DIRECTORY [-oDIRECTORY] [--jobs=INT] [--audio-rate=HZ] [--audio-chanc=1|2]\n"
     "   macicon -oICNS [ROM] [PNG...]\n"
     "    minify -oDST SRC\n"
     "\n"
@@ -247,6 +281,7 @@ void eggdev_print_help(const char *topic) {
   _(project)
   _(metadata)
   _(sound)
+  _(render)
   _(macicon)
   _(minify)
   #undef _
@@ -310,6 +345,21 @@ static int eggdev_configure_kv(const char *k,int kc,const char *v,int vc) {
     return 0;
   }
   
+  if ((kc==12)&&!memcmp(k,"image-format",12)) {
+    eggdev.image_format=v;
+    return 0;
+  }
+  
+  if ((kc==12)&&!memcmp(k,"image-report",12)) {
+    eggdev.image_report=vn;
+    return 0;
+  }
+  
+  if ((kc==10)&&!memcmp(k,"png-effort",10)) {
+    eggdev.png_effort=v;
+    return 0;
+  }
+  
   if ((kc==6)&&!memcmp(k,"htdocs",6)) {
     if (eggdev.htdocsc>=eggdev.htdocsa) {
       int na=eggdev.htdocsa+4;
@@ -410,6 +460,15 @@ static int eggdev_configure_kv(const char *k,int kc,const char *v,int vc) {
     return 0;
   }
   
+  if ((kc==4)&&!memcmp(k,"jobs",4)) {
+    eggdev.jobs=vn;
+    return 0;
+  }
+  if ((kc==1)&&!memcmp(k,"j",1)) {
+    eggdev.jobs=vn;
+    return 0;
+  }
+  
   fprintf(stderr,"%s: Unexpected option '%.*s' = '%.*s'\n",eggdev.exename,kc,k,vc,v);
   return -2;
 }
@@ -483,6 +542,28 @@ static int eggdev_configure_argv(int argc,char **argv) {
   return 0;
 }
 
+/* Apply --png-effort and --jobs to the PNG encoder.
+ */
+ 
+static int eggdev_configure_png() {
+  int effort=IMAGE_EFFORT_DEFAULT;
+  if (eggdev.png_effort) {
+    if (!strcmp(eggdev.png_effort,"fast")) effort=IMAGE_EFFORT_FAST;
+    else if (!strcmp(eggdev.png_effort,"default")) effort=IMAGE_EFFORT_DEFAULT;
+    else if (!strcmp(eggdev.png_effort,"max")) effort=IMAGE_EFFORT_MAX;
+    else {
+      fprintf(stderr,"%s: Unknown PNG effort '%s'. Expected fast, default, or max.\n",eggdev.exename,eggdev.png_effort);
+      return -2;
+    }
+  }
+  int threadc=eggdev.jobs;
+  #if !USE_mswin
+    if (threadc<1) threadc=sysconf(_SC_NPROCESSORS_ONLN);
+  #endif
+  png_encode_configure(effort,threadc);
+  return 0;
+}
+
 /* Configure.
  */
  
@@ -493,6 +574,7 @@ int eggdev_configure(int argc,char **argv) {
   else eggdev.exename="eggdev";
   
   if ((err=eggdev_configure_argv(argc,argv))<0) return err;
+  if ((err=eggdev_configure_png())<0) return err;
   
   return 0;
 }
@@ -38,6 +38,9 @@ extern struct eggdev {
   int raw;
   int recompile;
   const char *format;
+  const char *image_format; // (pack) null, "png", "rawimg", or "lzimg".
+  int image_report; // (pack)
+  const char *png_effort; // null, "fast", "default", or "max". Applies to every PNG we encode.
   const char **htdocsv;
   int htdocsc,htdocsa;
   const char *writepath;
@@ -54,6 +57,7 @@ extern struct eggdev {
   int audio_buffer;
   const char *audio_device;
   int repeat;
+  int jobs; // (render, PNG encoder) thread count, zero for default.
   const char **schemasrcv; // Holds --schema paths until we need them.
   int schemasrcc,schemasrca;
   int schema_volatile; // If nonzero, namespaces will keep (schemasrcv) populated and refresh its lists on demand. For server.
@@ -136,6 +140,7 @@ int eggdev_main_dump();
 int eggdev_main_project();
 int eggdev_main_metadata();
 int eggdev_main_sound();
+int eggdev_main_render();
 int eggdev_main_macicon();
 int eggdev_main_minify();
 
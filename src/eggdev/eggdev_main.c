@@ -24,6 +24,7 @@ int main(int argc,char **argv) {
   _(project)
   _(metadata)
   _(sound)
+  _(render)
   _(macicon)
   _(minify)
   #undef _
@@ -887,6 +887,68 @@ int eggdev_rom_encode(struct sr_encoder *dst,const struct eggdev_rom *rom) {
   return 0;
 }
 
+/* Append TOC.
+ * We read the encoded ROM back rather than working from the model, so offsets are right by construction.
+ */
+ 
+int eggdev_rom_append_toc(struct sr_encoder *dst,int romp) {
+  if (!dst||(romp<0)||(romp>dst->c)) return -1;
+  struct rom_reader reader;
+  if (rom_reader_init(&reader,(char*)dst->v+romp,dst->c-romp)<0) return -1;
+  int typec=0,recordc=0,tid=0;
+  struct rom_res *res;
+  while (res=rom_reader_next(&reader)) {
+    if (res->tid!=tid) {
+      typec++;
+      tid=res->tid;
+    }
+    recordc++;
+  }
+  if ((reader.status<0)||(reader.srcp!=dst->c-romp)) return -1;
+  if (typec>0xffff) return -1;
+  int tocp=reader.srcp;
+  // Reserve it all up front, so (dst->v) stays put while we read from it.
+  if (sr_encoder_require(dst,2+typec*8+recordc*10+8)<0) return -1;
+  
+  // Types. Resource counts can't exceed 0xffff, since rid can't.
+  if (sr_encode_intbe(dst,typec,2)<0) return -1;
+  int recordp=0,resc=0;
+  rom_reader_init(&reader,(char*)dst->v+romp,tocp);
+  tid=0;
+  while (res=rom_reader_next(&reader)) {
+    if (res->tid!=tid) {
+      if (tid) {
+        if (sr_encode_u8(dst,tid)<0) return -1;
+        if (sr_encode_u8(dst,0)<0) return -1;
+        if (sr_encode_intbe(dst,resc,2)<0) return -1;
+        if (sr_encode_intbe(dst,recordp,4)<0) return -1;
+        recordp+=resc;
+      }
+      tid=res->tid;
+      resc=0;
+    }
+    resc++;
+  }
+  if (tid) {
+    if (sr_encode_u8(dst,tid)<0) return -1;
+    if (sr_encode_u8(dst,0)<0) return -1;
+    if (sr_encode_intbe(dst,resc,2)<0) return -1;
+    if (sr_encode_intbe(dst,recordp,4)<0) return -1;
+  }
+  
+  // Records.
+  rom_reader_init(&reader,(char*)dst->v+romp,tocp);
+  while (res=rom_reader_next(&reader)) {
+    if (sr_encode_intbe(dst,res->rid,2)<0) return -1;
+    if (sr_encode_intbe(dst,(const unsigned char*)res->v-reader.src,4)<0) return -1;
+    if (sr_encode_intbe(dst,res->c,4)<0) return -1;
+  }
+  
+  if (sr_encode_intbe(dst,tocp,4)<0) return -1;
+  if (sr_encode_raw(dst,"\0TOC",4)<0) return -1;
+  return 0;
+}
+
 /* Ensure the global ROM is loaded.
  */
  
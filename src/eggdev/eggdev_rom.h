@@ -101,6 +101,11 @@ int eggdev_rom_validate(struct eggdev_rom *rom);
  */
 int eggdev_rom_encode(struct sr_encoder *dst,const struct eggdev_rom *rom);
 
+/* Append a TOC to the ROM that begins at (romp) in (dst) and ends there too, see rom.h.
+ * Runtimes use it to skip parsing at startup. Anything that reads ROMs generically ignores it.
+ */
+int eggdev_rom_append_toc(struct sr_encoder *dst,int romp);
+
 /* Brute force scan for ROM signature.
  * We validate the entire geometry of the ROM up to its terminator or EOF.
  * Signature with no resources doesn't count.
@@ -0,0 +1,301 @@
+#include "eggdev/eggdev_internal.h"
+#include <math.h>
+#include <time.h>
+#if USE_mswin
+  #include <sys/time.h>
+#else
+  #include <pthread.h>
+  #include <unistd.h>
+#endif
+
+#define EGGDEV_RENDER_THREAD_LIMIT 64
+#define EGGDEV_RENDER_SANITY_S 600 /* Stop any one resource after so many seconds of output. */
+ 
+/* One resource to render.
+ * Worker threads only touch their own job, after the main thread has set it up.
+ */
+struct eggdev_render_job {
+  struct eggdev_res *res; // WEAK, from (eggdev.rom). Serial is compiled before we start.
+  int framec;
+  double elapsed; // s, wall
+  float peak;
+  int voicec;
+  int truncated;
+  int err;
+};
+
+static struct eggdev_render {
+  struct eggdev_render_job *jobv;
+  int jobc,jobp;
+  int rate,chanc;
+  #if !USE_mswin
+    pthread_mutex_t mutex;
+  #endif
+} render={0};
+
+/* Current real time.
+ */
+ 
+static double now_real() {
+  #if USE_mswin
+    struct timeval tv={0};
+    gettimeofday(&tv,0);
+    return (double)tv.tv_sec+(double)tv.tv_usec/1000000.0;
+  #else
+    struct timespec tv={0};
+    clock_gettime(CLOCK_MONOTONIC,&tv);
+    return (double)tv.tv_sec+(double)tv.tv_nsec/1000000000.0;
+  #endif
+}
+
+/* Write a WAV file from float samples.
+ */
+ 
+static int eggdev_render_write_wav(const char *path,const float *src,int samplec,int rate,int chanc) {
+  struct sr_encoder dst={0};
+  int dlen=samplec<<1;
+  int flen=4+8+16+8+dlen;
+  int brate=(rate*chanc)<<1;
+  uint8_t hdr[44]={
+    'R','I','F','F',flen,flen>>8,flen>>16,flen>>24,'W','A','V','E',
+    'f','m','t',' ',16,0,0,0,
+      1,0,
+      chanc,0,
+      rate,rate>>8,rate>>16,rate>>24,
+      brate,brate>>8,brate>>16,brate>>24,
+      chanc<<1,0,
+      16,0,
+    'd','a','t','a',dlen,dlen>>8,dlen>>16,dlen>>24,
+  };
+  if ((sr_encode_raw(&dst,hdr,sizeof(hdr))<0)||(sr_encoder_require(&dst,dlen)<0)) {
+    sr_encoder_cleanup(&dst);
+    return -1;
+  }
+  uint8_t *p=(uint8_t*)dst.v+dst.c;
+  for (;samplec-->0;src++,p+=2) {
+    int sample;
+    if (*src<=-1.0f) sample=-32768;
+    else if (*src>=1.0f) sample=32767;
+    else sample=(int)((*src)*32767.0f);
+    p[0]=sample;
+    p[1]=sample>>8;
+  }
+  dst.c+=dlen;
+  int err=file_write(path,dst.v,dst.c);
+  sr_encoder_cleanup(&dst);
+  return err;
+}
+
+/* Render one job.
+ * Runs on a worker thread. Each job gets its own synth.
+ */
+ 
+static void eggdev_render_job_run(struct eggdev_render_job *job) {
+  struct synth *synth=synth_new(render.rate,render.chanc);
+  if (!synth) {
+    job->err=-1;
+    return;
+  }
+
+  const int framesperupdate=1024;
+  int samplesperupdate=framesperupdate*render.chanc;
+  int framelimit=render.rate*EGGDEV_RENDER_SANITY_S;
+  float *buf=0;
+  int bufa=0,bufc=0;
+
+  double starttime=now_real();
+  synth_play_song_borrow(synth,job->res->serial,job->res->serialc,0);
+  while (synth_get_song(synth)) {
+    if (job->framec>=framelimit) {
+      job->truncated=1;
+      break;
+    }
+    if (bufc>bufa-samplesperupdate) {
+      int na=bufa?(bufa<<1):(samplesperupdate<<4);
+      void *nv=realloc(buf,sizeof(float)*na);
+      if (!nv) {
+        job->err=-1;
+        break;
+      }
+      buf=nv;
+      bufa=na;
+    }
+    float *v=buf+bufc;
+    synth_updatef(v,samplesperupdate,synth);
+    int i=samplesperupdate;
+    for (;i-->0;v++) {
+      float a=(*v<0.0f)?-*v:*v;
+      if (a>job->peak) job->peak=a;
+    }
+    bufc+=samplesperupdate;
+    job->framec+=framesperupdate;
+  }
+  job->elapsed=now_real()-starttime;
+  job->voicec=synth_get_voice_high_water(synth);
+  synth_del(synth);
+
+  // Same trailing-silence trim as the editor's printer. Doesn't change what we report.
+  while ((bufc>=render.chanc)&&(buf[bufc-1]==0.0f)) bufc--;
+  bufc-=bufc%render.chanc;
+
+  if (!job->err&&eggdev.dstpath) {
+    char path[1024];
+    int pathc=snprintf(path,sizeof(path),"%s%c%s-%d%s%.*s.wav",
+      eggdev.dstpath,PATH_SEP_CHAR,eggdev_tid_repr(job->res->tid),job->res->rid,
+      job->res->namec?"-":"",job->res->namec,job->res->name
+    );
+    if ((pathc<1)||(pathc>=sizeof(path))) job->err=-1;
+    else if (eggdev_render_write_wav(path,buf,bufc,render.rate,render.chanc)<0) {
+      fprintf(stderr,"%s: Failed to write file, %d samples.\n",path,bufc);
+      job->err=-2;
+    }
+  }
+  if (buf) free(buf);
+}
+
+/* Worker thread: Take the next job until there are none.
+ */
+ 
+static void *eggdev_render_thread(void *arg) {
+  while (1) {
+    struct eggdev_render_job *job=0;
+    #if !USE_mswin
+      pthread_mutex_lock(&render.mutex);
+    #endif
+    if (render.jobp<render.jobc) job=render.jobv+render.jobp++;
+    #if !USE_mswin
+      pthread_mutex_unlock(&render.mutex);
+    #endif
+    if (!job) return 0;
+    eggdev_render_job_run(job);
+  }
+}
+
+/* Run all jobs on (threadc) threads, including the main one.
+ */
+ 
+static int eggdev_render_run(int threadc) {
+  #if USE_mswin
+    eggdev_render_thread(0);
+  #else
+    pthread_t threadv[EGGDEV_RENDER_THREAD_LIMIT];
+    int startc=0;
+    if (pthread_mutex_init(&render.mutex,0)) return -1;
+    while (startc<threadc-1) {
+      if (pthread_create(threadv+startc,0,eggdev_render_thread,0)) break;
+      startc++;
+    }
+    eggdev_render_thread(0);
+    while (startc-->0) pthread_join(threadv[startc],0);
+    pthread_mutex_destroy(&render.mutex);
+  #endif
+  return 0;
+}
+
+/* Guess how many threads to use, if the user didn't say.
+ */
+ 
+static int eggdev_render_guess_threadc() {
+  #if USE_mswin
+    return 1;
+  #else
+    long n=sysconf(_SC_NPROCESSORS_ONLN);
+    if (n<1) return 1;
+    if (n>EGGDEV_RENDER_THREAD_LIMIT) return EGGDEV_RENDER_THREAD_LIMIT;
+    return n;
+  #endif
+}
+
+/* Print the report to stdout.
+ */
+ 
+static int eggdev_render_report(int threadc,double elapsed) {
+  int errc=0;
+  double cpu=0.0,audio=0.0;
+  fprintf(stdout,"%-16s %8s %9s %8s %10s %6s\n","RESOURCE","LEN(S)","TIME(MS)","SPEED","PEAK(DB)","VOICES");
+  const struct eggdev_render_job *job=render.jobv;
+  int i=render.jobc;
+  for (;i-->0;job++) {
+    char id[64];
+    snprintf(id,sizeof(id),"%s:%d",eggdev_tid_repr(job->res->tid),job->res->rid);
+    if (job->err) {
+      fprintf(stdout,"%-16s ERROR %.*s\n",id,job->res->namec,job->res->name);
+      errc++;
+      continue;
+    }
+    double len=(double)job->framec/(double)render.rate;
+    double peakdb=(job->peak>0.0f)?(20.0*log10(job->peak)):-INFINITY;
+    fprintf(stdout,"%-16s %8.3f %9.3f %7.0fx %10.2f %6d %.*s%s%s\n",
+      id,len,job->elapsed*1000.0,(job->elapsed>0.0)?(len/job->elapsed):0.0,peakdb,job->voicec,
+      job->res->namec,job->res->name,
+      (job->peak>1.0f)?" CLIPPED":"",
+      job->truncated?" TRUNCATED":""
+    );
+    cpu+=job->elapsed;
+    audio+=len;
+  }
+  fprintf(stdout,
+    "%d resources, %.3f s of audio, in %.3f s on %d threads (%.3f s summed). %d errors.\n",
+    render.jobc,audio,elapsed,threadc,cpu,errc
+  );
+  return errc?-2:0;
+}
+
+/* render, main entry point.
+ */
+ 
+int eggdev_main_render() {
+  if (eggdev.srcpathc!=1) {
+    fprintf(stderr,"%s: Exactly one input is required for 'render'\n",eggdev.exename);
+    return -2;
+  }
+  int err=eggdev_require_rom(eggdev.srcpathv[0]);
+  if (err<0) return err;
+  if (eggdev.dstpath&&(dir_mkdirp(eggdev.dstpath)<0)) {
+    fprintf(stderr,"%s: Failed to create directory.\n",eggdev.dstpath);
+    return -2;
+  }
+
+  render.rate=eggdev.audio_rate?eggdev.audio_rate:44100;
+  render.chanc=eggdev.audio_chanc?eggdev.audio_chanc:1;
+  int threadc=eggdev.jobs?eggdev.jobs:eggdev_render_guess_threadc();
+  if (threadc<1) threadc=1;
+  else if (threadc>EGGDEV_RENDER_THREAD_LIMIT) threadc=EGGDEV_RENDER_THREAD_LIMIT;
+
+  /* Compile everything up front, on this thread.
+   * Compilers touch global state, and this is cheap compared to rendering anyway.
+   */
+  struct eggdev_res *res=eggdev.rom->resv;
+  int i=eggdev.rom->resc;
+  for (;i-->0;res++) {
+    if (res->tid==EGG_TID_song) err=eggdev_compile_song(res);
+    else if (res->tid==EGG_TID_sound) err=eggdev_compile_sound(res);
+    else continue;
+    if (err<0) {
+      if (err!=-2) fprintf(stderr,"%s:%d: Failed to compile resource\n",eggdev_tid_repr(res->tid),res->rid);
+      return -2;
+    }
+    if (render.jobc>=INT_MAX/sizeof(struct eggdev_render_job)) return -1;
+    void *nv=realloc(render.jobv,sizeof(struct eggdev_render_job)*(render.jobc+1));
+    if (!nv) return -1;
+    render.jobv=nv;
+    struct eggdev_render_job *job=render.jobv+render.jobc++;
+    memset(job,0,sizeof(struct eggdev_render_job));
+    job->res=res;
+  }
+  if (!render.jobc) {
+    fprintf(stderr,"%s: No songs or sounds.\n",eggdev.srcpathv[0]);
+    return 0;
+  }
+  if (threadc>render.jobc) threadc=render.jobc;
+
+  double starttime=now_real();
+  if ((err=eggdev_render_run(threadc))<0) return err;
+  double elapsed=now_real()-starttime;
+
+  err=eggdev_render_report(threadc,elapsed);
+  free(render.jobv);
+  render.jobv=0;
+  render.jobc=render.jobp=0;
+  return err;
+}
@@ -178,6 +178,10 @@ static int eggdev_bundle_rewrite_rom_without_code(struct eggdev_bundle_context *
     if (err!=-2) fprintf(stderr,"%s: Failed to reencode ROM.\n",ctx->modrompath);
     return -2;
   }
+  if (eggdev_rom_append_toc(&ctx->scratch,0)<0) {
+    fprintf(stderr,"%s: Failed to generate TOC.\n",ctx->modrompath);
+    return -2;
+  }
   if (file_write(ctx->modrompath,ctx->scratch.v,ctx->scratch.c)<0) {
     fprintf(stderr,"%s: Failed to write file, %d bytes\n",ctx->modrompath,ctx->scratch.c);
     return -2;
@@ -1,5 +1,10 @@
 #include "eggdev/eggdev_internal.h"
 #include "opt/synth/synth_formats.h"
+#include "opt/image/image.h"
+#include <time.h>
+#if USE_mswin
+  #include <sys/time.h>
+#endif
 
 static int eggdev_res_cmp(const void *a,const void *b) {
   const struct eggdev_res *A=a,*B=b;
@@ -58,6 +63,129 @@ static int eggdev_pack_convert(struct eggdev_rom *rom) {
   return 0;
 }
 
+/* Current real time.
+ */
+ 
+static double now_real() {
+  #if USE_mswin
+    struct timeval tv={0};
+    gettimeofday(&tv,0);
+    return (double)tv.tv_sec+(double)tv.tv_usec/1000000.0;
+  #else
+    struct timespec tv={0};
+    clock_gettime(CLOCK_MONOTONIC,&tv);
+    return (double)tv.tv_sec+(double)tv.tv_nsec/1000000000.0;
+  #endif
+}
+
+/* Average time to decode an image, in seconds.
+ * Repeats until a couple milliseconds have passed, so tiny images still measure something.
+ */
+ 
+static double eggdev_pack_time_decode(const void *src,int srcc) {
+  int repc=0;
+  double starttime=now_real(),elapsed=0.0;
+  do {
+    struct image *image=image_decode(src,srcc);
+    if (!image) return 0.0;
+    image_del(image);
+    repc++;
+  } while (((elapsed=now_real()-starttime)<0.002)&&(repc<1000));
+  return elapsed/repc;
+}
+
+/* Nonzero if this image must stay as it is: Metadata refers to it, or its name asks for a format.
+ */
+ 
+static int eggdev_pack_image_pinned(const struct eggdev_res *res) {
+  const char *v=0;
+  int vc,rid;
+  if ((vc=eggdev_metadata_get(&v,0,0,"iconImage",9))&&(sr_int_eval(&rid,v,vc)>=2)&&(rid==res->rid)) return 1;
+  if ((vc=eggdev_metadata_get(&v,0,0,"posterImage",11))&&(sr_int_eval(&rid,v,vc)>=2)&&(rid==res->rid)) return 1;
+  #define _(tag) if (eggdev_res_has_comment(res,#tag,sizeof(#tag)-1)) return 1;
+  IMAGE_FORMAT_FOR_EACH
+  #undef _
+  return 0;
+}
+
+/* Encode one image in each format and print sizes and decode times.
+ * The format we're going to store is starred.
+ */
+ 
+static void eggdev_pack_report_image(const struct eggdev_res *res,const struct image *image,int format) {
+  fprintf(stderr,"%s: image:%d %dx%d %d-bit",eggdev.exename,res->rid,image->w,image->h,image->pixelsize);
+  int informat=image_format_guess(res->serial,res->serialc);
+  int ckformat=1; for (;image_format_repr(ckformat);ckformat++) {
+    struct sr_encoder dst={0};
+    if (ckformat==informat) {
+      if (sr_encode_raw(&dst,res->serial,res->serialc)<0) continue;
+    } else {
+      // Encoders are allowed to reformat the image in place, so give them a copy.
+      struct image *copy=image_new_alloc(image->pixelsize,image->w,image->h);
+      if (!copy) continue;
+      const uint8_t *srcrow=image->v;
+      uint8_t *dstrow=copy->v;
+      int yi=image->h;
+      for (;yi-->0;srcrow+=image->stride,dstrow+=copy->stride) memcpy(dstrow,srcrow,copy->stride);
+      int err=image_encode(&dst,copy,ckformat);
+      image_del(copy);
+      if (err<0) {
+        sr_encoder_cleanup(&dst);
+        continue;
+      }
+    }
+    double elapsed=eggdev_pack_time_decode(dst.v,dst.c);
+    fprintf(stderr," %s%s=%d b/%.03f ms",(ckformat==format)?"*":"",image_format_repr(ckformat),dst.c,elapsed*1000.0);
+    sr_encoder_cleanup(&dst);
+  }
+  fprintf(stderr,"\n");
+}
+
+/* pack, convert images to the format requested by --image-format, and report on them if requested.
+ * This happens after regular compilation, so comment-driven conversions are already done.
+ */
+ 
+static int eggdev_pack_images(struct eggdev_rom *rom) {
+  if (eggdev.raw) return 0;
+  int format=IMAGE_FORMAT_png;
+  if (eggdev.image_format&&((format=image_format_eval(eggdev.image_format,-1))<1)) {
+    fprintf(stderr,"%s: Unknown image format '%s'. Expected png, rawimg, or lzimg.\n",eggdev.exename,eggdev.image_format);
+    return -2;
+  }
+  if ((format==IMAGE_FORMAT_png)&&!eggdev.image_report) return 0;
+  int beforec=0,afterc=0;
+  struct eggdev_res *res=rom->resv;
+  int i=rom->resc;
+  for (;i-->0;res++) {
+    if (res->tid!=EGG_TID_image) continue;
+    if (eggdev_res_has_comment(res,"raw",3)) continue;
+    struct image *image=image_decode(res->serial,res->serialc);
+    if (!image) {
+      fprintf(stderr,"%s: Failed to decode %d-byte image.\n",res->path,res->serialc);
+      return -2;
+    }
+    int pinned=eggdev_pack_image_pinned(res);
+    if (eggdev.image_report) eggdev_pack_report_image(res,image,pinned?image_format_guess(res->serial,res->serialc):format);
+    beforec+=res->serialc;
+    if (!pinned&&(image_format_guess(res->serial,res->serialc)!=format)) {
+      struct sr_encoder dst={0};
+      if (image_encode(&dst,image,format)<0) {
+        fprintf(stderr,"%s: Failed to reencode image to '%s'\n",res->path,image_format_repr(format));
+        sr_encoder_cleanup(&dst);
+        image_del(image);
+        return -2;
+      }
+      eggdev_res_handoff_serial(res,dst.v,dst.c);
+    }
+    afterc+=res->serialc;
+    image_del(image);
+  }
+  if (eggdev.image_report) {
+    fprintf(stderr,"%s: Images total %d bytes, was %d.\n",eggdev.exename,afterc,beforec);
+  }
+  return 0;
+}
+
 /* pack, main entry point.
  */
  
@@ -79,6 +207,10 @@ int eggdev_main_pack() {
     if (err!=-2) fprintf(stderr,"%s: Unspecified error compiling resources\n",eggdev.exename);
     return -2;
   }
+  if ((err=eggdev_pack_images(eggdev.rom))<0) {
+    if (err!=-2) fprintf(stderr,"%s: Unspecified error converting images\n",eggdev.exename);
+    return -2;
+  }
   if ((err=eggdev_rom_validate(eggdev.rom))<0) {
     if (err!=-2) fprintf(stderr,"%s: Unspecified error validating ROM\n",eggdev.exename);
     return -2;
@@ -89,6 +221,11 @@ int eggdev_main_pack() {
     sr_encoder_cleanup(&dst);
     return -2;
   }
+  if (eggdev_rom_append_toc(&dst,0)<0) {
+    fprintf(stderr,"%s: Failed to generate TOC\n",eggdev.exename);
+    sr_encoder_cleanup(&dst);
+    return -2;
+  }
   if (file_write(eggdev.dstpath,dst.v,dst.c)<0) {
     fprintf(stderr,"%s: Failed to write ROM file, %d bytes\n",eggdev.dstpath,dst.c);
     sr_encoder_cleanup(&dst);
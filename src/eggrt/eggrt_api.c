@@ -30,6 +30,8 @@ int egg_texture_get_status(int *w,int *h,int texid);
 int egg_texture_get_pixels(void *dst,int dsta,int texid);
 int egg_texture_load_image(int texid,int rid);
 int egg_texture_load_raw(int texid,int fmt,int w,int h,int stride,const void *src,int srcc);
+int egg_texture_load_image_sub(int texid,int x,int y,int w,int h,int rid);
+int egg_image_get_size(int *w,int *h,int rid);
 void egg_draw_globals(int tint,int alpha);
 void egg_draw_clear(int dsttexid,uint32_t rgba);
 void egg_draw_line(int dsttexid,const struct egg_draw_line *v,int c);
@@ -198,10 +200,14 @@ int egg_input_configure() {
 }
 
 /* Play sound from resource.
+ * Audio calls go through the synth's command queue, so we never wait for the audio thread.
+ * Only if the queue is full do we lock, drain it, and call the synth directly.
  */
  
 void egg_play_sound(int rid) {
+  if (synth_queue_sound(eggrt.synth,rid)>=0) return;
   if (hostio_audio_lock(eggrt.hostio)>=0) {
+    synth_flush_commands(eggrt.synth);
     synth_play_sound(eggrt.synth,rid);
     hostio_audio_unlock(eggrt.hostio);
   }
@@ -211,7 +217,9 @@ void egg_play_sound(int rid) {
  */
  
 void egg_play_song(int rid,int force,int repeat) {
+  if (synth_queue_song(eggrt.synth,rid,force,repeat)>=0) return;
   if (hostio_audio_lock(eggrt.hostio)>=0) {
+    synth_flush_commands(eggrt.synth);
     synth_play_song(eggrt.synth,rid,force,repeat);
     hostio_audio_unlock(eggrt.hostio);
   }
@@ -221,7 +229,9 @@ void egg_play_song(int rid,int force,int repeat) {
  */
  
 void egg_audio_event(int chid,int opcode,int a,int b,int durms) {
+  if (synth_queue_event(eggrt.synth,chid,opcode,a,b,durms)>=0) return;
   if (hostio_audio_lock(eggrt.hostio)>=0) {
+    synth_flush_commands(eggrt.synth);
     synth_event(eggrt.synth,chid,opcode,a,b,durms);
     hostio_audio_unlock(eggrt.hostio);
   }
@@ -241,7 +251,9 @@ double egg_audio_get_playhead() {
 }
 
 void egg_audio_set_playhead(double s) {
+  if (synth_queue_playhead(eggrt.synth,s)>=0) return;
   if (hostio_audio_lock(eggrt.hostio)>=0) {
+    synth_flush_commands(eggrt.synth);
     synth_set_playhead(eggrt.synth,s);
     hostio_audio_unlock(eggrt.hostio);
   }
@@ -273,25 +285,21 @@ int egg_texture_get_pixels(void *dst,int dsta,int texid) {
  */
 
 int egg_texture_load_image(int texid,int rid) {
-  const void *src=0;
-  int srcc=eggrt_rom_get(&src,EGG_TID_image,rid);
-  struct image *image=image_decode(src,srcc);
-  if (!image) return -1;
-  if (image->pixelsize!=32) {
-    if (image_force_rgba(image)<0) {
-      image_del(image);
-      return -1;
-    }
-  }
-  int err=egg_texture_load_raw(texid,image->w,image->h,image->stride,image->v,image->stride*image->h);
-  image_del(image);
-  return err;
+  return eggrt_imgcache_load_texture(texid,rid);
 }
 
 int egg_texture_load_raw(int texid,int w,int h,int stride,const void *src,int srcc) {
   return render_texture_load(eggrt.render,texid,w,h,stride,EGG_TEX_FMT_RGBA,src,srcc);
 }
 
+int egg_texture_load_image_sub(int texid,int x,int y,int w,int h,int rid) {
+  return eggrt_imgcache_load_texture_sub(texid,x,y,w,h,rid);
+}
+
+int egg_image_get_size(int *w,int *h,int rid) {
+  return eggrt_imgcache_get_size(w,h,rid);
+}
+
 /* Rendering.
  */
  
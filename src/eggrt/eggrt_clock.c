@@ -66,7 +66,10 @@ void eggrt_clock_init() {
 double eggrt_clock_update() {
   double now=eggrt_now_real();
   double elapsed=now-eggrt.pvtime;
-  if (elapsed<=0.0) {
+  if (eggrt.fast_playback) {
+    // Playback forces a fixed interval anyway. Don't wait for the real one.
+    elapsed=eggrt.framelen;
+  } else if (elapsed<=0.0) {
     eggrt.clock_faultc++;
     elapsed=eggrt.framelen;
   } else if (elapsed>EGGRT_TOO_LONG_DELAY) {
@@ -84,6 +87,38 @@ double eggrt_clock_update() {
   return elapsed;
 }
 
+/* Print one synth profile histogram on a single line.
+ */
+ 
+static void eggrt_clock_report_histogram(const char *name,const int *v) {
+  fprintf(stderr,"%s:   %-10s",eggrt.exename,name);
+  int i=0; for (;i<SYNTH_PROFILE_BUCKETS;i++) fprintf(stderr," %7d",v[i]);
+  fprintf(stderr,"\n");
+}
+
+/* Report synth profile, if enabled.
+ * Audio should be stopped first; the audio thread writes to it.
+ */
+ 
+static void eggrt_clock_report_synth() {
+  const struct synth_profile *profile=synth_get_profile(eggrt.synth);
+  if (!profile||(profile->updatec<1)) return;
+  double audio=(double)profile->framec/(double)eggrt.hostio->audio->rate;
+  fprintf(stderr,
+    "%s: Synth %d updates, %.03f s audio. Render %.03f ms mean, %.03f ms max. Load %.03f mean, %.03f max. %d underrun risks.\n",
+    eggrt.exename,profile->updatec,audio,
+    (profile->render*1000.0)/profile->updatec,profile->render_max*1000.0,
+    (audio>0.0)?(profile->render/audio):0.0,profile->load_max,profile->underrunc
+  );
+  fprintf(stderr,"%s:   Columns are tenths of buffer time (load), tenths of voice limit (voices), or count (printers).\n",eggrt.exename);
+  fprintf(stderr,"%s:   %-10s",eggrt.exename,"");
+  int i=0; for (;i<SYNTH_PROFILE_BUCKETS-1;i++) fprintf(stderr," %7d",i);
+  fprintf(stderr," %6d+\n",SYNTH_PROFILE_BUCKETS-1);
+  eggrt_clock_report_histogram("load",profile->loadv);
+  eggrt_clock_report_histogram("voices",profile->voicev);
+  eggrt_clock_report_histogram("printers",profile->printerv);
+}
+
 /* Report.
  */
  
@@ -95,4 +130,31 @@ void eggrt_clock_report() {
   double avgrate=(double)eggrt.framec/elapsed;
   double cpuload=(end_cpu-eggrt.starttime_cpu)/elapsed;
   fprintf(stderr,"%s: %d frames in %.03f s, average %.03f Hz, CPU load %.06f.\n",eggrt.exename,eggrt.framec,elapsed,avgrate,cpuload);
+  if (eggrt.render) {
+    struct render_stats total={0};
+    render_get_stats(0,&total,eggrt.render);
+    if (total.framec>0) {
+      fprintf(stderr,
+        "%s: GL average %.01f draws and %.01f state changes per frame.\n",
+        eggrt.exename,(double)total.drawc/total.framec,(double)total.statec/total.framec
+      );
+    }
+  }
+  if (eggrt.imgcache_hitc||eggrt.imgcache_missc) {
+    fprintf(stderr,
+      "%s: Image cache %d hits, %d misses, %d evictions. %d images, %d bytes at exit.\n",
+      eggrt.exename,eggrt.imgcache_hitc,eggrt.imgcache_missc,eggrt.imgcache_evictc,eggrt.imgcachec,eggrt.imgcache_size
+    );
+  }
+  if (eggrt.synth) {
+    int stolen=0,rejected=0;
+    synth_get_voice_stats(eggrt.synth,&stolen,&rejected);
+    if (stolen||rejected) {
+      fprintf(stderr,
+        "%s: Synth voices stolen %d (%.03f/s), rejected %d (%.03f/s).\n",
+        eggrt.exename,stolen,stolen/elapsed,rejected,rejected/elapsed
+      );
+    }
+    eggrt_clock_report_synth();
+  }
 }
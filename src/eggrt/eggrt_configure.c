@@ -58,12 +58,23 @@ static void eggrt_help_default() {
     "  --stereo                      --audio-chanc=2\n"
     "  --audio-buffer=FRAMES         Recommend audio buffer size.\n"
     "  --audio-device=STRING         Usage depends on driver.\n"
+    "  --voice-steal=POLICY          When every synth voice is busy: reject, oldest, or quietest, optionally with \",song-first\". Default \"quietest,song-first\".\n"
+    "  --synth-profile               Measure synthesizer load and report histograms at exit.\n"
+    "  --frame-profile               Time each phase of the main loop and report percentiles at exit.\n"
+    "  --frame-trace=PATH            --frame-profile, and also write the last few thousand frames as Chrome trace JSON.\n"
+    "  --image-cache=MB              Keep so much decoded image data, for reloading textures. Default " EGGRT_STR(EGGRT_IMAGE_CACHE_MB_DEFAULT) ", zero to disable.\n"
     "  --configure-input             Enter a special interactive mode to set up a gamepad.\n"
     "  --input-config=PATH           Where to load and save gamepad mappings.\n"
     "  --store=PATH                  Saved game. Blank for default, or \"none\" to disable.\n"
     "  --store:KEY=VALUE             Add or override a store field.\n"
+    "  --store-interval=MS           Minimum time between saves, default " EGGRT_STR(EGGRT_STORE_INTERVAL_MS_DEFAULT) ". Saves happen in the background, and always at quit.\n"
     "  --record=PATH                 Record session, and return a constant at egg_time_real() to circumvent RNG.\n"
     "  --playback=PATH               Play a recording.\n"
+    "  --fast-playback               With --playback: Run as fast as possible, headless, no audio. Report rate and state hash at exit.\n"
+    "  --render-every=N              With --fast-playback: Render every Nth frame, default " EGGRT_STR(EGGRT_RENDER_EVERY_DEFAULT) ", zero for never.\n"
+    "                                Each frame's hash covers input and store, plus the framebuffer only on frames we render.\n"
+    "                                So compare the final hash only between runs with the same N.\n"
+    "  --playback-hashes=PATH        With --fast-playback: Write each frame's state hash to a text file, \"FRAME INPUT HASH\" per line.\n"
     "\n"
   );
   fprintf(stderr,
@@ -214,6 +225,29 @@ static int eggrt_configure_kv(const char *k,int kc,const char *v,int vc) {
     return -2;
   }
   
+  // --voice-steal
+  if ((kc==11)&&!memcmp(k,"voice-steal",11)) {
+    int policy=-1,songfirst=0,vp=0;
+    while (vp<vc) {
+      const char *token=v+vp;
+      int tokenc=0;
+      while ((vp<vc)&&(v[vp++]!=',')) tokenc++;
+      if ((tokenc==10)&&!memcmp(token,"song-first",10)) { songfirst=SYNTH_STEAL_SONG_FIRST; continue; }
+      int base=-1;
+      if ((tokenc==6)&&!memcmp(token,"reject",6)) base=SYNTH_STEAL_REJECT;
+      else if ((tokenc==6)&&!memcmp(token,"oldest",6)) base=SYNTH_STEAL_OLDEST;
+      else if ((tokenc==8)&&!memcmp(token,"quietest",8)) base=SYNTH_STEAL_QUIETEST;
+      if ((base<0)||(policy>=0)) { policy=-1; break; } // Unknown, or more than one.
+      policy=base;
+    }
+    if (policy<0) {
+      fprintf(stderr,"%s: Expected one of 'reject', 'oldest', 'quietest', optionally with ',song-first', for '%.*s', found '%.*s'\n",eggrt.exename,kc,k,vc,v);
+      return -2;
+    }
+    eggrt.voice_steal=policy|songfirst;
+    return 0;
+  }
+  
   // --mono,--stereo
   if ((kc==4)&&!memcmp(k,"mono",4)) { eggrt.audio_chanc=1; return 0; }
   if ((kc==6)&&!memcmp(k,"stereo",6)) { eggrt.audio_chanc=2; return 0; }
@@ -241,10 +275,18 @@ static int eggrt_configure_kv(const char *k,int kc,const char *v,int vc) {
   INTOPT("audio-chanc",audio_chanc,0,8)
   INTOPT("audio-buffer",audio_buffer,0,100000)
   INTOPT("configure-input",configure_input,0,1)
+  INTOPT("synth-profile",synth_profile,0,1)
+  INTOPT("frame-profile",frame_profile,0,1)
+  INTOPT("image-cache",image_cache_mb,0,1024)
+  INTOPT("store-interval",store_interval_ms,0,600000)
+  INTOPT("fast-playback",fast_playback,0,1)
+  INTOPT("render-every",render_every,0,1000000)
+  STROPT("frame-trace",frame_trace_path)
   STROPT("input-config",inmgr_path)
   STROPT("store",storepath)
   STROPT("record",record_path)
   STROPT("playback",playback_path)
+  STROPT("playback-hashes",playback_hash_path)
   
   #undef STROPT
   #undef INTOPT
@@ -621,9 +663,24 @@ static int eggrt_configure_final() {
   if (eggrt.rompath) eggrt.rptname=eggrt.rompath;
   else eggrt.rptname=eggrt.exename;
   
+  /* --fast-playback replaces the video and audio drivers, and uses an empty in-memory store unless one was named explicitly.
+   * Whatever the user's saved game looks like today shouldn't change the outcome.
+   * The game can still write to it, same as when it was recorded. We just never save.
+   */
+  if (eggrt.fast_playback) {
+    if (!eggrt.playback_path) {
+      fprintf(stderr,"%s: '--fast-playback' requires '--playback=PATH'\n",eggrt.exename);
+      return -2;
+    }
+    if (eggrt_config_set_string(&eggrt.video_drivers,"headless",8)<0) return -1;
+    if (eggrt_config_set_string(&eggrt.audio_drivers,"dummy",5)<0) return -1;
+    if (!eggrt.storepath) eggrt.store_nosave=1;
+  }
+  
   // Pick a default (storepath) in the typical case where it wasn't provided.
-  if (!eggrt.storepath) eggrt.storepath=eggrt_configure_default_store();
-  else if (!strcmp(eggrt.storepath,"none")) {
+  if (!eggrt.storepath) {
+    if (!eggrt.store_nosave) eggrt.storepath=eggrt_configure_default_store();
+  } else if (!strcmp(eggrt.storepath,"none")) {
     free(eggrt.storepath);
     eggrt.storepath=0;
   }
@@ -655,6 +712,10 @@ int eggrt_configure(int argc,char **argv) {
 
   if ((argc>=1)&&argv&&argv[0]&&argv[0][0]) eggrt.exename=argv[0];
   else eggrt.exename="egg";
+  eggrt.image_cache_mb=EGGRT_IMAGE_CACHE_MB_DEFAULT;
+  eggrt.store_interval_ms=EGGRT_STORE_INTERVAL_MS_DEFAULT;
+  eggrt.render_every=EGGRT_RENDER_EVERY_DEFAULT;
+  eggrt.voice_steal=-1;
   
   if ((err=eggrt_configure_mainfile())<0) return err;
   if ((err=eggrt_configure_argv(argc,argv))<0) return err;
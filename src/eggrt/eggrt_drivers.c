@@ -188,8 +188,10 @@ static int eggrt_drivers_init_video() {
     return -2;
   }
   
-  // Create renderer.
-  if (!(eggrt.render=render_new())) {
+  // Create renderer. Software drivers don't have a GL context.
+  if (eggrt.hostio->video->type->software) {
+    if (!(eggrt.render=render_new_soft())) return -1;
+  } else if (!(eggrt.render=render_new())) {
     fprintf(stderr,"%s: Failed to initialize OpenGL.\n",eggrt.exename);
     return -2;
   }
@@ -216,23 +218,25 @@ static int eggrt_drivers_init_audio() {
     fprintf(stderr,"%s: Failed to initialize synthesizer.\n",eggrt.exename);
     return -2;
   }
+  if (eggrt.voice_steal>=0) synth_set_steal_policy(eggrt.synth,eggrt.voice_steal);
   
   if (eggrt.hostio->audio->type==&hostio_audio_type_dummy) {
     fprintf(stderr,"%s: Neutering synth due to dummy output.\n",eggrt.exename);
     synth_neuter(eggrt.synth);
+  } else {
+    synth_start_printers(eggrt.synth,2); // Failure is fine; sounds will print during update instead.
   }
+  if (eggrt.synth_profile&&(synth_enable_profile(eggrt.synth)<0)) return -1;
   
-  const struct rom_res *res=eggrt.resv;
-  int i=eggrt.resc;
-  for (;i-->0;res++) {
-    if (res->tid==EGG_TID_sound) {
-      if (synth_install_sound(eggrt.synth,res->rid,res->v,res->c)<0) return -1;
-    } else if (res->tid==EGG_TID_song) {
-      if (synth_install_song(eggrt.synth,res->rid,res->v,res->c)<0) return -1;
-    } else if ((res->tid>EGG_TID_sound)&&(res->tid>EGG_TID_song)) {
-      break;
-    }
+  struct rom_res res;
+  int p=0;
+  for (;eggrt_rom_get_by_index(&res,EGG_TID_sound,p)>0;p++) {
+    if (synth_install_sound(eggrt.synth,res.rid,res.v,res.c)<0) return -1;
+  }
+  for (p=0;eggrt_rom_get_by_index(&res,EGG_TID_song,p)>0;p++) {
+    if (synth_install_song(eggrt.synth,res.rid,res.v,res.c)<0) return -1;
   }
+  synth_preprint_sounds(eggrt.synth);
   
   return 0;
 }
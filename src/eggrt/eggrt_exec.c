@@ -168,6 +168,16 @@
     return egg_texture_load_raw(texid,w,h,stride,src,srcc);
   }
   
+  static int egg_wasm_texture_load_image_sub(wasm_exec_env_t ee,int texid,int x,int y,int w,int h,int rid) {
+    return egg_texture_load_image_sub(texid,x,y,w,h,rid);
+  }
+  
+  static int egg_wasm_image_get_size(wasm_exec_env_t ee,int wp,int hp,int rid) {
+    int *w=eggrt_wasm_get_client_memory(wp,4);
+    int *h=eggrt_wasm_get_client_memory(hp,4);
+    return egg_image_get_size(w,h,rid);
+  }
+  
   static void egg_wasm_draw_globals(wasm_exec_env_t ee,int tint,int alpha) {
     egg_draw_globals(tint,alpha);
   }
@@ -231,6 +241,8 @@
     {"egg_texture_get_pixels",egg_wasm_texture_get_pixels,"(*~i)i"},
     {"egg_texture_load_image",egg_wasm_texture_load_image,"(ii)i"},
     {"egg_texture_load_raw",egg_wasm_texture_load_raw,"(iiii*~)i"},
+    {"egg_texture_load_image_sub",egg_wasm_texture_load_image_sub,"(iiiiii)i"},
+    {"egg_image_get_size",egg_wasm_image_get_size,"(iii)i"},
     {"egg_draw_globals",egg_wasm_draw_globals,"(ii)"},
     {"egg_draw_clear",egg_wasm_draw_clear,"(ii)"},
     {"egg_draw_line",egg_wasm_draw_line,"(iii)"},
@@ -358,6 +370,16 @@
     return egg_texture_load_raw(texid,w,h,stride,src,srcc);
   }
   
+  int w2c_env_egg_texture_load_image_sub(struct w2c_env *env,int texid,int x,int y,int w,int h,int rid) {
+    return egg_texture_load_image_sub(texid,x,y,w,h,rid);
+  }
+  
+  int w2c_env_egg_image_get_size(struct w2c_env *env,uint32_t wp,uint32_t hp,int rid) {
+    int *w=HOSTADDR(wp,4);
+    int *h=HOSTADDR(hp,4);
+    return egg_image_get_size(w,h,rid);
+  }
+  
   void w2c_env_egg_draw_globals(struct w2c_env *env,int tint,int alpha) {
     egg_draw_globals(tint,alpha);
   }
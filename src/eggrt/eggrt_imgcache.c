@@ -0,0 +1,177 @@
+/* eggrt_imgcache.c
+ * Decoded RGBA images, keyed by rid, so egg_texture_load_image doesn't inflate the same PNG over and over.
+ * Bounded by total pixel bytes (--image-cache=MB), and we evict least recently used.
+ * An image larger than the whole budget is decoded each time and never cached. Zero budget disables the cache.
+ * Uncompressed RGBA rawimg resources skip all this, and upload straight from the ROM.
+ */
+
+#include "eggrt_internal.h"
+#include "opt/image/image.h"
+
+/* Quit.
+ */
+
+void eggrt_imgcache_quit() {
+  if (eggrt.imgcachev) {
+    while (eggrt.imgcachec-->0) free(eggrt.imgcachev[eggrt.imgcachec].v);
+    free(eggrt.imgcachev);
+  }
+  eggrt.imgcachev=0;
+  eggrt.imgcachec=0;
+  eggrt.imgcachea=0;
+  eggrt.imgcache_size=0;
+}
+
+/* Evict least recently used until (addc) more bytes fit.
+ */
+
+static void eggrt_imgcache_make_room(int limit,int addc) {
+  while (eggrt.imgcachec&&(eggrt.imgcache_size>limit-addc)) {
+    struct eggrt_imgcache_entry *oldest=eggrt.imgcachev;
+    struct eggrt_imgcache_entry *entry=eggrt.imgcachev;
+    int i=eggrt.imgcachec;
+    for (;i-->0;entry++) if (entry->seq<oldest->seq) oldest=entry;
+    eggrt.imgcache_size-=oldest->w*oldest->h*4;
+    free(oldest->v);
+    eggrt.imgcachec--;
+    *oldest=eggrt.imgcachev[eggrt.imgcachec];
+    eggrt.imgcache_evictc++;
+  }
+}
+
+/* Present a cache entry as a WEAK image.
+ */
+
+static struct image *eggrt_imgcache_view(const struct eggrt_imgcache_entry *entry) {
+  static struct image view={0};
+  view.v=entry->v;
+  view.w=entry->w;
+  view.h=entry->h;
+  view.stride=entry->w<<2;
+  view.pixelsize=32;
+  return &view;
+}
+
+/* Get image, decoding and caching if needed.
+ * On success, (*image) is either WEAK from the cache, or (*owned) is nonzero and caller must image_del it.
+ */
+
+static int eggrt_imgcache_get(struct image **image,int *owned,int rid,const void *src,int srcc) {
+  *owned=0;
+  struct eggrt_imgcache_entry *entry=eggrt.imgcachev;
+  int i=eggrt.imgcachec;
+  for (;i-->0;entry++) {
+    if (entry->rid!=rid) continue;
+    eggrt.imgcache_hitc++;
+    entry->seq=++(eggrt.imgcache_seq);
+    *image=eggrt_imgcache_view(entry);
+    return 0;
+  }
+  eggrt.imgcache_missc++;
+
+  struct image *decoded=image_decode(src,srcc);
+  if (!decoded) return -1;
+  if ((decoded->pixelsize!=32)&&(image_force_rgba(decoded)<0)) {
+    image_del(decoded);
+    return -1;
+  }
+
+  /* Cache it if it fits, otherwise hand it off.
+   * The cache wants minimal stride, which decoders always produce for RGBA but let's be sure.
+   */
+  int limit=eggrt.image_cache_mb<<20; // Option is capped so this can't overflow.
+  int size=decoded->w*decoded->h*4;
+  if ((decoded->stride!=decoded->w<<2)||(size>limit)) {
+    *image=decoded;
+    *owned=1;
+    return 0;
+  }
+  eggrt_imgcache_make_room(limit,size);
+  if (eggrt.imgcachec>=eggrt.imgcachea) {
+    int na=eggrt.imgcachea+16;
+    void *nv=realloc(eggrt.imgcachev,sizeof(struct eggrt_imgcache_entry)*na);
+    if (!nv) {
+      *image=decoded;
+      *owned=1;
+      return 0;
+    }
+    eggrt.imgcachev=nv;
+    eggrt.imgcachea=na;
+  }
+  entry=eggrt.imgcachev+eggrt.imgcachec++;
+  entry->rid=rid;
+  entry->w=decoded->w;
+  entry->h=decoded->h;
+  entry->v=decoded->v;
+  entry->seq=++(eggrt.imgcache_seq);
+  eggrt.imgcache_size+=size;
+  decoded->v=0;
+  image_del(decoded);
+  *image=eggrt_imgcache_view(entry);
+  return 0;
+}
+
+/* Load texture from image resource.
+ */
+
+int eggrt_imgcache_load_texture(int texid,int rid) {
+  const void *src=0;
+  int srcc=eggrt_rom_get(&src,EGG_TID_image,rid);
+  struct image weak={0};
+  if ((rawimg_decode_weak(&weak,src,srcc)>=0)&&(weak.pixelsize==32)) {
+    return render_texture_load(eggrt.render,texid,weak.w,weak.h,weak.stride,EGG_TEX_FMT_RGBA,weak.v,weak.stride*weak.h);
+  }
+  struct image *image=0;
+  int owned=0;
+  if (eggrt_imgcache_get(&image,&owned,rid,src,srcc)<0) return -1;
+  int err=render_texture_load(eggrt.render,texid,image->w,image->h,image->stride,EGG_TEX_FMT_RGBA,image->v,image->stride*image->h);
+  if (owned) image_del(image);
+  return err;
+}
+
+/* Size of image resource, from its header only.
+ */
+
+int eggrt_imgcache_get_size(int *w,int *h,int rid) {
+  const void *src=0;
+  int srcc=eggrt_rom_get(&src,EGG_TID_image,rid);
+  struct image header={0};
+  if (image_decode_header(&header,src,srcc)<0) return -1;
+  if (w) *w=header.w;
+  if (h) *h=header.h;
+  return 0;
+}
+
+/* Load image resource into part of a texture.
+ * Image goes in the top-left corner of (x,y,w,h), and the rest of that box is cleared to transparent.
+ */
+
+int eggrt_imgcache_load_texture_sub(int texid,int x,int y,int w,int h,int rid) {
+  if ((w<1)||(h<1)||(w>EGG_TEXTURE_SIZE_LIMIT)||(h>EGG_TEXTURE_SIZE_LIMIT)) return -1;
+  int texw=0,texh=0,texfmt=0;
+  render_texture_get_header(&texw,&texh,&texfmt,eggrt.render,texid);
+  if ((texfmt!=EGG_TEX_FMT_RGBA)||(x<0)||(y<0)||(x>texw-w)||(y>texh-h)) return -1;
+  const void *src=0;
+  int srcc=eggrt_rom_get(&src,EGG_TID_image,rid);
+  struct image weak={0},*image=0;
+  int owned=0;
+  if ((rawimg_decode_weak(&weak,src,srcc)>=0)&&(weak.pixelsize==32)) {
+    image=&weak;
+  } else if (eggrt_imgcache_get(&image,&owned,rid,src,srcc)<0) {
+    return -1;
+  }
+  int err=-1;
+  if ((image->w<=w)&&(image->h<=h)) {
+    int stride=w<<2;
+    uint8_t *box=calloc(stride,h);
+    if (box) {
+      uint8_t *dstrow=box;
+      const uint8_t *srcrow=image->v;
+      int yi=image->h; for (;yi-->0;dstrow+=stride,srcrow+=image->stride) memcpy(dstrow,srcrow,image->w<<2);
+      err=render_texture_load_sub(eggrt.render,texid,x,y,w,h,stride,box,stride*h);
+      free(box);
+    }
+  }
+  if (owned) image_del(image);
+  return err;
+}
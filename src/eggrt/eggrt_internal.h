@@ -27,6 +27,29 @@
 #define EGGRT_RECORDING_UPDATE_INTERVAL 0.016666
 #define EGGRT_RECORDING_FAKE_TIME 1000000000.0
 
+// How often --fast-playback renders, if not specified by --render-every.
+#define EGGRT_RENDER_EVERY_DEFAULT 1
+
+// Budget for decoded images, in MB, if not specified by --image-cache.
+#define EGGRT_IMAGE_CACHE_MB_DEFAULT 32
+
+// Minimum time between saves, if not specified by --store-interval.
+#define EGGRT_STORE_INTERVAL_MS_DEFAULT 1000
+
+#define EGGRT_STR_(v) #v
+#define EGGRT_STR(v) EGGRT_STR_(v)
+
+// Main loop phases, for the frame profiler.
+#define EGGRT_PHASE_DRIVERS 0 /* eggrt_drivers_update */
+#define EGGRT_PHASE_UPDATE 1 /* Client or incfg update. */
+#define EGGRT_PHASE_RENDER 2 /* gx_begin and client render. */
+#define EGGRT_PHASE_PRESENT 3 /* render_draw_to_main, put_frame, gx_end */
+#define EGGRT_PHASE_STORE 4 /* eggrt_store_update */
+#define EGGRT_PHASE_INPUT 5 /* inmgr_save */
+#define EGGRT_PHASE_COUNT 6
+
+struct eggrt_profile;
+
 extern struct eggrt {
 
   // Acquired at eggrt_configure():
@@ -46,17 +69,30 @@ extern struct eggrt {
   int audio_buffer;
   int configure_input;
   char *storepath;
+  int store_nosave; // Store lives in memory only: Writes succeed but never reach a file. (storepath) is null.
+  int store_interval_ms;
   char *inmgr_path;
   char *store_extra; // JSON, composed from '--store:KEY=VALUE' args
   char *cfgpath;
   char *record_path;
   char *playback_path;
+  int fast_playback; // With (playback_path): No clock, dummy drivers, and hash every frame.
+  int render_every; // With (fast_playback): Render only every Nth frame, or never if zero.
+  char *playback_hash_path; // With (fast_playback): Write each frame's hash here.
+  int voice_steal; // SYNTH_STEAL_*, or <0 for synth's default.
+  int synth_profile;
+  int frame_profile;
+  char *frame_trace_path;
+  int image_cache_mb;
   
   // eggrt_romsrc.c:
   const void *romserial;
   int romserialc;
+  int rommapped; // Nonzero if (romserial) is mmap'd rather than heap.
+  struct rom_toc romtoc; // If (romtoc.typec) nonzero, we use it and (resv) stays empty.
   struct rom_res *resv; // Contains all resources, and payloads point into (romserial).
   int resc,resa;
+  struct rom_index romindex; // Over (resv), when there's no TOC.
   
   // eggrt_exec.c: (also it has a bunch of its own private globals elsewhere)
   int exec_callstate; // (0,1,2)=(none,initted,quitted)
@@ -69,6 +105,9 @@ extern struct eggrt {
   double starttime_cpu;
   int clock_faultc;
   
+  // eggrt_profile.c:
+  struct eggrt_profile *profile; // Null if disabled.
+  
   // eggrt_store.c:
   struct eggrt_store_field {
     char *k,*v;
@@ -77,6 +116,18 @@ extern struct eggrt {
   int storec,storea;
   int store_dirty;
   
+  // eggrt_imgcache.c:
+  struct eggrt_imgcache_entry {
+    int rid;
+    int w,h; // RGBA, stride is (w*4).
+    void *v;
+    int seq;
+  } *imgcachev;
+  int imgcachec,imgcachea;
+  int imgcache_size; // Sum of pixel bytes.
+  int imgcache_seq;
+  int imgcache_hitc,imgcache_missc,imgcache_evictc;
+  
   // eggrt_drivers.c:
   struct hostio *hostio;
   int devid_keyboard;
@@ -102,6 +153,7 @@ extern const int eggrt_has_embedded_rom;
 int eggrt_romsrc_init();
 void eggrt_romsrc_quit();
 int eggrt_rom_get(void *dstpp,int tid,int rid);
+int eggrt_rom_get_by_index(struct rom_res *dst,int tid,int p); // >0 if populated; (p) counts within (tid).
 
 void eggrt_exec_quit();
 int eggrt_exec_init();
@@ -117,11 +169,30 @@ double eggrt_now_real();
 double eggrt_now_cpu();
 void eggrt_sleep(double s);
 
+/* Frame profiler. Everything is a cheap noop when disabled.
+ * Call eggrt_profile_frame() at the start of each frame, then bracket each phase with begin/end.
+ * Frames that never begin EGGRT_PHASE_UPDATE (unfocused, debugger) are discarded.
+ * eggrt_profile_finish() prints the report and writes the trace if requested.
+ */
+void eggrt_profile_quit();
+int eggrt_profile_init();
+void eggrt_profile_frame();
+void eggrt_profile_begin(int phase);
+void eggrt_profile_end(int phase);
+void eggrt_profile_finish();
+
 void eggrt_store_quit();
 int eggrt_store_init();
 struct eggrt_store_field *eggrt_store_get_field(const char *k,int kc,int create);
 int eggrt_store_set_field(struct eggrt_store_field *field,const char *v,int vc); // (field) must have been returned by eggrt_store_get_field
-int eggrt_store_save(); // Writes file whether dirty or not; caller should check first.
+int eggrt_store_save(); // Encodes and queues for the writer whether dirty or not; caller should check first.
+int eggrt_store_update(); // Save if dirty and --store-interval has elapsed. Once per frame.
+void eggrt_store_flush(); // Save if dirty, and wait for the writer to finish. Quit does this too.
+
+void eggrt_imgcache_quit();
+int eggrt_imgcache_load_texture(int texid,int rid);
+int eggrt_imgcache_load_texture_sub(int texid,int x,int y,int w,int h,int rid);
+int eggrt_imgcache_get_size(int *w,int *h,int rid);
 
 void eggrt_drivers_quit();
 int eggrt_drivers_init();
@@ -130,5 +201,7 @@ int eggrt_drivers_update();
 void eggrt_record_quit();
 int eggrt_record_init();
 double eggrt_record_update(double elapsed);
+int eggrt_record_should_render(); // Always true except during --fast-playback.
+void eggrt_record_hash_frame(int rendered); // --fast-playback only. Call once per frame after render or its absence.
 
 #endif
@@ -20,17 +20,17 @@ static void eggrt_signal(int sigid) {
  */
  
 static void eggrt_quit() {
-  int err;
   hostio_audio_play(eggrt.hostio,0);
   eggrt_exec_client_quit(eggrt.exitstatus);
-  if (eggrt.store_dirty&&((err=eggrt_store_save())<0)) {
-    if (err!=-2) fprintf(stderr,"%s: Unspecified error saving game.\n",eggrt.storepath);
-  }
+  eggrt_store_flush();
   eggrt_record_quit();
   if (!eggrt.exitstatus) {
     eggrt_clock_report();
+    eggrt_profile_finish();
   }
+  eggrt_profile_quit();
   eggrt_drivers_quit();
+  eggrt_imgcache_quit();
   eggrt_store_quit();
   eggrt_exec_quit();
   eggrt_romsrc_quit();
@@ -74,8 +74,15 @@ static int eggrt_init() {
     return -2;
   }
   
-  // Now that the client started, add some artificial delay to the song player. Sometimes a little bit at the beginning gets lopped off.
-  synth_delay_song(eggrt.synth,1.0);
+  /* Now that the client started, add some artificial delay to the song player. Sometimes a little bit at the beginning gets lopped off.
+   * Client init's egg_play_song is only queued at this point, and starting a song clears the delay.
+   * So apply the queue first.
+   */
+  if (hostio_audio_lock(eggrt.hostio)>=0) {
+    synth_flush_commands(eggrt.synth);
+    synth_delay_song(eggrt.synth,1.0);
+    hostio_audio_unlock(eggrt.hostio);
+  }
   
   // With --configure-input, start the input configurator immediately.
   if (eggrt.configure_input) {
@@ -85,12 +92,89 @@ static int eggrt_init() {
     }
   }
   
+  if ((err=eggrt_profile_init())<0) return err;
   hostio_audio_play(eggrt.hostio,1);
   eggrt_clock_init();
   
   return 0;
 }
 
+/* Render one frame: Everything up to the client's framebuffer being complete.
+ */
+ 
+static int eggrt_render_client() {
+  int err;
+  if (eggrt.hostio->video->type->gx_begin(eggrt.hostio->video)<0) return -1;
+  egg_draw_globals(0,0xff);
+  if (eggrt.incfg) {
+    if ((err=incfg_render(eggrt.incfg))<0) {
+      if (err!=-2) fprintf(stderr,"%s: Unspecified error rendering frame.\n",eggrt.rptname);
+      return -2;
+    }
+  } else if (eggrt.romserialc) {
+    if ((err=eggrt_exec_client_render())<0) {
+      if (err!=-2) fprintf(stderr,"%s: Unspecified error rendering frame.\n",eggrt.rptname);
+      return -2;
+    }
+  }
+  return 0;
+}
+
+/* Deliver the rendered frame to the video driver.
+ */
+ 
+static int eggrt_present() {
+  if (!eggrt.incfg&&eggrt.romserialc) {
+    render_draw_to_main(eggrt.render,eggrt.hostio->video->w*eggrt.hostio->video->viewscale,eggrt.hostio->video->h*eggrt.hostio->video->viewscale,1);
+  }
+  if (eggrt.hostio->video->type->put_frame) {
+    int mainw=0,mainh=0;
+    const void *mainv=render_get_main(&mainw,&mainh,eggrt.render);
+    if (mainv&&(eggrt.hostio->video->type->put_frame(eggrt.hostio->video,mainv,mainw,mainh)<0)) return -1;
+  }
+  if (eggrt.hostio->video->type->gx_end(eggrt.hostio->video)<0) return -1;
+  return 0;
+}
+
+/* Render and present, with each phase closed on every path out of it.
+ */
+ 
+static int eggrt_render() {
+  eggrt_profile_begin(EGGRT_PHASE_RENDER);
+  int err=eggrt_render_client();
+  eggrt_profile_end(EGGRT_PHASE_RENDER);
+  if (err<0) return err;
+  eggrt_profile_begin(EGGRT_PHASE_PRESENT);
+  err=eggrt_present();
+  eggrt_profile_end(EGGRT_PHASE_PRESENT);
+  return err;
+}
+
+/* Update the client, or the input configurator in its place.
+ * Returns >0 if we mustn't render this frame.
+ */
+ 
+static int eggrt_update_client(double elapsed) {
+  int err;
+  if (eggrt.incfg) {
+    if ((err=incfg_update(eggrt.incfg,elapsed))<0) {
+      if (err!=-2) fprintf(stderr,"%s: Unspecified error updating input configurator.\n",eggrt.rptname);
+      return -2;
+    }
+    // incfg may delete itself during update, when it's done.
+    // That's perfectly fine. But don't proceed to render on this frame, since the client won't have updated.
+    if (!eggrt.incfg) return 1;
+  } else if (eggrt.romserialc) {
+    if ((err=eggrt_exec_client_update(elapsed))<0) {
+      if (err!=-2) fprintf(stderr,"%s: Unspecified error updating game model.\n",eggrt.rptname);
+      return -2;
+    }
+  } else {
+    eggrt.terminate=1;
+  }
+  return 0;
+}
+
 /* Update.
  */
  
@@ -99,9 +183,13 @@ static int eggrt_update() {
   
   // Tick the master clock.
   double elapsed=eggrt_clock_update();
+  eggrt_profile_frame();
   
   // Update drivers.
-  if ((err=eggrt_drivers_update())<0) {
+  eggrt_profile_begin(EGGRT_PHASE_DRIVERS);
+  err=eggrt_drivers_update();
+  eggrt_profile_end(EGGRT_PHASE_DRIVERS);
+  if (err<0) {
     if (err!=-2) fprintf(stderr,"%s: Unspecified error updating platform drivers.\n",eggrt.exename);
     return -2;
   }
@@ -123,52 +211,38 @@ static int eggrt_update() {
   }
   
   // Update client.
-  if (eggrt.incfg) {
-    if ((err=incfg_update(eggrt.incfg,elapsed))<0) {
-      if (err!=-2) fprintf(stderr,"%s: Unspecified error updating input configurator.\n",eggrt.rptname);
-      return -2;
-    }
-    // incfg may delete itself during update, when it's done.
-    // That's perfectly fine. But don't proceed to render on this frame, since the client won't have updated.
-    if (!eggrt.incfg) return 0;
-  } else if (eggrt.romserialc) {
-    if ((err=eggrt_exec_client_update(elapsed))<0) {
-      if (err!=-2) fprintf(stderr,"%s: Unspecified error updating game model.\n",eggrt.rptname);
-      return -2;
+  eggrt_profile_begin(EGGRT_PHASE_UPDATE);
+  err=eggrt_update_client(elapsed);
+  eggrt_profile_end(EGGRT_PHASE_UPDATE);
+  if (err<0) return err;
+  if (err>0) return 0;
+  if (eggrt.store_dirty) {
+    eggrt_profile_begin(EGGRT_PHASE_STORE);
+    if ((err=eggrt_store_update())<0) {
+      if (err!=-2) fprintf(stderr,"%s: Unspecified error saving game.\n",eggrt.storepath);
     }
-  } else {
-    eggrt.terminate=1;
-  }
-  if (eggrt.store_dirty&&((err=eggrt_store_save())<0)) {
-    if (err!=-2) fprintf(stderr,"%s: Unspecified error saving game.\n",eggrt.storepath);
+    eggrt_profile_end(EGGRT_PHASE_STORE);
   }
   if (eggrt.terminate) return 0;
   
-  // Render.
-  if (eggrt.hostio->video->type->gx_begin(eggrt.hostio->video)<0) return -1;
-  egg_draw_globals(0,0xff);
-  if (eggrt.incfg) {
-    if ((err=incfg_render(eggrt.incfg))<0) {
-      if (err!=-2) fprintf(stderr,"%s: Unspecified error rendering frame.\n",eggrt.rptname);
-      return -2;
-    }
-  } else if (eggrt.romserialc) {
-    if ((err=eggrt_exec_client_render())<0) {
-      if (err!=-2) fprintf(stderr,"%s: Unspecified error rendering frame.\n",eggrt.rptname);
-      return -2;
-    }
-    render_draw_to_main(eggrt.render,eggrt.hostio->video->w*eggrt.hostio->video->viewscale,eggrt.hostio->video->h*eggrt.hostio->video->viewscale,1);
+  // Render. --fast-playback may skip it, and hashes each frame whether rendered or not.
+  if (eggrt_record_should_render()) {
+    if ((err=eggrt_render())<0) return err;
+    if (eggrt.fast_playback) eggrt_record_hash_frame(1);
+  } else {
+    eggrt_record_hash_frame(0);
   }
-  if (eggrt.hostio->video->type->gx_end(eggrt.hostio->video)<0) return -1;
   
   // Save inmgr if it's dirty.
   if (eggrt.inmgr_dirty) {
+    eggrt_profile_begin(EGGRT_PHASE_INPUT);
     eggrt.inmgr_dirty=0;
     if (inmgr_save()<0) {
       fprintf(stderr,"%s: Failed to save input config.\n",eggrt.exename);
     } else {
       fprintf(stderr,"%s: Saved input config.\n",eggrt.exename);
     }
+    eggrt_profile_end(EGGRT_PHASE_INPUT);
   }
   
   return 0;
@@ -0,0 +1,181 @@
+/* eggrt_profile.c
+ * Optional per-phase timing of the main loop, enabled by --frame-profile or --frame-trace=PATH.
+ * We keep the most recent EGGRT_PROFILE_RING frames, report percentiles at exit,
+ * and with --frame-trace, dump those same frames as Chrome trace JSON (chrome://tracing or ui.perfetto.dev).
+ */
+
+#include "eggrt_internal.h"
+
+#define EGGRT_PROFILE_RING 8192
+
+static const char *eggrt_phase_names[EGGRT_PHASE_COUNT]={
+  [EGGRT_PHASE_DRIVERS]="drivers",
+  [EGGRT_PHASE_UPDATE]="update",
+  [EGGRT_PHASE_RENDER]="render",
+  [EGGRT_PHASE_PRESENT]="present",
+  [EGGRT_PHASE_STORE]="store",
+  [EGGRT_PHASE_INPUT]="input",
+};
+
+struct eggrt_profile {
+  double starttime;
+  struct eggrt_profile_frame {
+    double startv[EGGRT_PHASE_COUNT]; // Real time, zero if the phase didn't run.
+    float durv[EGGRT_PHASE_COUNT]; // s
+  } *framev;
+  int framep; // Next to write.
+  int framec; // Total recorded, can exceed the ring.
+  struct eggrt_profile_frame *frame; // Current, always (pending) once started.
+  struct eggrt_profile_frame pending; // Goes into the ring only if it reaches UPDATE.
+};
+
+/* Init.
+ */
+
+int eggrt_profile_init() {
+  if (!eggrt.frame_profile&&!eggrt.frame_trace_path) return 0;
+  if (!(eggrt.profile=calloc(1,sizeof(struct eggrt_profile)))) return -1;
+  if (!(eggrt.profile->framev=calloc(EGGRT_PROFILE_RING,sizeof(struct eggrt_profile_frame)))) return -1;
+  eggrt.profile->starttime=eggrt_now_real();
+  return 0;
+}
+
+/* Quit.
+ */
+
+void eggrt_profile_quit() {
+  if (!eggrt.profile) return;
+  if (eggrt.profile->framev) free(eggrt.profile->framev);
+  free(eggrt.profile);
+  eggrt.profile=0;
+}
+
+/* Record.
+ */
+
+/* Commit the current frame to the ring, unless it never reached UPDATE.
+ * Those are frames where we were unfocused or stopped in the debugger, and counting them would skew every phase toward zero.
+ */
+
+static void eggrt_profile_commit(struct eggrt_profile *profile) {
+  if (!profile->frame) return;
+  profile->frame=0;
+  if (profile->pending.startv[EGGRT_PHASE_UPDATE]<=0.0) return;
+  profile->framev[profile->framep++]=profile->pending;
+  if (profile->framep>=EGGRT_PROFILE_RING) profile->framep=0;
+  profile->framec++;
+}
+
+void eggrt_profile_frame() {
+  struct eggrt_profile *profile=eggrt.profile;
+  if (!profile) return;
+  eggrt_profile_commit(profile);
+  profile->frame=&profile->pending;
+  memset(profile->frame,0,sizeof(struct eggrt_profile_frame));
+}
+
+void eggrt_profile_begin(int phase) {
+  struct eggrt_profile *profile=eggrt.profile;
+  if (!profile||!profile->frame) return;
+  profile->frame->startv[phase]=eggrt_now_real();
+}
+
+void eggrt_profile_end(int phase) {
+  struct eggrt_profile *profile=eggrt.profile;
+  if (!profile||!profile->frame||(profile->frame->startv[phase]<=0.0)) return;
+  profile->frame->durv[phase]=eggrt_now_real()-profile->frame->startv[phase];
+}
+
+/* Report percentiles.
+ */
+
+static int eggrt_profile_cmp(const void *a,const void *b) {
+  float fa=*(const float*)a,fb=*(const float*)b;
+  if (fa<fb) return -1;
+  if (fa>fb) return 1;
+  return 0;
+}
+
+static void eggrt_profile_report_row(const char *name,float *v,int c) {
+  double sum=0.0;
+  int i=c; while (i-->0) sum+=v[i];
+  qsort(v,c,sizeof(float),eggrt_profile_cmp);
+  fprintf(stderr,
+    "%s:   %-8s %9.03f %9.03f %9.03f %9.03f %9.03f\n",
+    eggrt.exename,name,(sum*1000.0)/c,
+    v[c/2]*1000.0,v[(c*9)/10]*1000.0,v[(c*99)/100]*1000.0,v[c-1]*1000.0
+  );
+}
+
+static void eggrt_profile_report(struct eggrt_profile *profile) {
+  int c=(profile->framec<EGGRT_PROFILE_RING)?profile->framec:EGGRT_PROFILE_RING;
+  if (c<1) return;
+  float *v=malloc(sizeof(float)*c);
+  float *totalv=calloc(c,sizeof(float));
+  if (!v||!totalv) {
+    if (v) free(v);
+    if (totalv) free(totalv);
+    return;
+  }
+  fprintf(stderr,"%s: Frame profile, last %d of %d frames, in ms:\n",eggrt.exename,c,profile->framec);
+  fprintf(stderr,"%s:   %-8s %9s %9s %9s %9s %9s\n",eggrt.exename,"PHASE","MEAN","P50","P90","P99","MAX");
+  int phase=0; for (;phase<EGGRT_PHASE_COUNT;phase++) {
+    int i=0; for (;i<c;i++) {
+      v[i]=profile->framev[i].durv[phase];
+      totalv[i]+=v[i];
+    }
+    eggrt_profile_report_row(eggrt_phase_names[phase],v,c);
+  }
+  eggrt_profile_report_row("total",totalv,c);
+  free(v);
+  free(totalv);
+}
+
+/* Chrome trace: One complete ("X") event per phase per frame, oldest first.
+ */
+
+static int eggrt_profile_write_trace(struct eggrt_profile *profile,const char *path) {
+  FILE *f=fopen(path,"w");
+  if (!f) {
+    fprintf(stderr,"%s: Failed to open file for writing.\n",path);
+    return -2;
+  }
+  fprintf(f,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  int c=profile->framec,p=0;
+  if (c>EGGRT_PROFILE_RING) {
+    c=EGGRT_PROFILE_RING;
+    p=profile->framep;
+  }
+  int first=1;
+  for (;c-->0;p++) {
+    if (p>=EGGRT_PROFILE_RING) p=0;
+    const struct eggrt_profile_frame *frame=profile->framev+p;
+    int phase=0; for (;phase<EGGRT_PHASE_COUNT;phase++) {
+      if (frame->startv[phase]<=0.0) continue;
+      fprintf(f,
+        "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.03f,\"dur\":%.03f}",
+        first?"":",\n",eggrt_phase_names[phase],
+        (frame->startv[phase]-profile->starttime)*1000000.0,frame->durv[phase]*1000000.0
+      );
+      first=0;
+    }
+  }
+  fprintf(f,"\n]}\n");
+  if (fclose(f)) {
+    fprintf(stderr,"%s: Error writing file.\n",path);
+    return -2;
+  }
+  fprintf(stderr,"%s: Wrote frame trace.\n",path);
+  return 0;
+}
+
+/* Report, public.
+ */
+
+void eggrt_profile_finish() {
+  struct eggrt_profile *profile=eggrt.profile;
+  if (!profile) return;
+  eggrt_profile_commit(profile);
+  eggrt_profile_report(profile);
+  if (eggrt.frame_trace_path) eggrt_profile_write_trace(profile,eggrt.frame_trace_path);
+}
@@ -1,5 +1,9 @@
 #include "eggrt_internal.h"
 
+// FNV-1a 64, except we take 4 bytes at a time. Framebuffers are big.
+#define EGGRT_HASH_INIT 0xcbf29ce484222325ull
+#define EGGRT_HASH_PRIME 0x00000100000001b3ull
+
 /* Globals.
  */
  
@@ -11,8 +15,42 @@ static struct {
   int pbp,pbc;
   int pb_framec;
   int pb_state;
+  // --fast-playback:
+  int ff_framec;
+  int ff_renderc;
+  uint64_t ff_hash; // Every frame's hash, chained.
+  FILE *ff_hashfile;
 } eggrt_record={0};
 
+/* Hash.
+ */
+ 
+static uint64_t eggrt_record_hash(uint64_t hash,const void *v,int c) {
+  const uint8_t *src=v;
+  for (;c>=4;c-=4,src+=4) {
+    hash^=src[0]|(src[1]<<8)|(src[2]<<16)|((uint32_t)src[3]<<24);
+    hash*=EGGRT_HASH_PRIME;
+  }
+  for (;c-->0;src++) {
+    hash^=*src;
+    hash*=EGGRT_HASH_PRIME;
+  }
+  return hash;
+}
+
+/* Report fast playback.
+ */
+ 
+static void eggrt_record_report() {
+  if (eggrt_record.ff_framec<1) return;
+  double elapsed=eggrt_now_real()-eggrt.starttime_real;
+  fprintf(stderr,
+    "%s: Fast playback: %d frames (%d rendered) in %.03f s, %.01f frames/s. State hash %016llx.\n",
+    eggrt.exename,eggrt_record.ff_framec,eggrt_record.ff_renderc,elapsed,
+    (elapsed>0.0)?(eggrt_record.ff_framec/elapsed):0.0,(unsigned long long)eggrt_record.ff_hash
+  );
+}
+
 /* Quit.
  */
  
@@ -26,6 +64,9 @@ void eggrt_record_quit() {
     }
   }
 
+  if (eggrt.fast_playback) eggrt_record_report();
+  if (eggrt_record.ff_hashfile) fclose(eggrt_record.ff_hashfile);
+
   sr_encoder_cleanup(&eggrt_record.rec);
   if (eggrt_record.pb) free(eggrt_record.pb);
   memset(&eggrt_record,0,sizeof(eggrt_record));
@@ -43,6 +84,13 @@ int eggrt_record_init() {
       return -2;
     }
   }
+  eggrt_record.ff_hash=EGGRT_HASH_INIT;
+  if (eggrt.fast_playback&&eggrt.playback_hash_path) {
+    if (!(eggrt_record.ff_hashfile=fopen(eggrt.playback_hash_path,"w"))) {
+      fprintf(stderr,"%s: Failed to open file for writing.\n",eggrt.playback_hash_path);
+      return -2;
+    }
+  }
   return 0;
 }
 
@@ -85,3 +133,40 @@ double eggrt_record_update(double elapsed) {
   
   return elapsed;
 }
+
+/* Fast playback: Should we render this frame?
+ */
+ 
+int eggrt_record_should_render() {
+  if (!eggrt.fast_playback) return 1;
+  if (eggrt.render_every<1) return 0;
+  return !(eggrt_record.ff_framec%eggrt.render_every);
+}
+
+/* Fast playback: Hash the state we can see from outside the client.
+ * That's the input state, the store, and the framebuffer if we rendered one.
+ * Client memory would be better, but native clients don't expose it.
+ */
+ 
+void eggrt_record_hash_frame(int rendered) {
+  uint64_t hash=EGGRT_HASH_INIT;
+  uint8_t state[2]={eggrt_record.pb_state>>8,eggrt_record.pb_state};
+  hash=eggrt_record_hash(hash,state,2);
+  const struct eggrt_store_field *field=eggrt.storev;
+  int i=eggrt.storec;
+  for (;i-->0;field++) {
+    hash=eggrt_record_hash(hash,field->k,field->kc+1); // Include the terminator, to keep "ab"="c" distinct from "a"="bc".
+    hash=eggrt_record_hash(hash,field->v,field->vc+1);
+  }
+  if (rendered) {
+    int w=0,h=0;
+    const void *rgba=render_get_main(&w,&h,eggrt.render);
+    if (rgba) hash=eggrt_record_hash(hash,rgba,(w*h)<<2);
+    eggrt_record.ff_renderc++;
+  }
+  if (eggrt_record.ff_hashfile) {
+    fprintf(eggrt_record.ff_hashfile,"%d %04x %016llx\n",eggrt_record.ff_framec,eggrt_record.pb_state,(unsigned long long)hash);
+  }
+  eggrt_record.ff_hash=(eggrt_record.ff_hash^hash)*EGGRT_HASH_PRIME;
+  eggrt_record.ff_framec++;
+}
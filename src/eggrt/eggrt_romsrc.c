@@ -11,6 +11,12 @@
 #elif ROMSRC==EXTERNAL
   const int eggrt_has_embedded_rom=0;
   #include "opt/fs/fs.h"
+  #if !USE_mswin
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+  #endif
   
 #else
   #error "Please build with -DROMSRC=EMBEDDED or -DROMSRC=EXTERNAL"
@@ -23,36 +29,49 @@ void eggrt_romsrc_quit() {
   if (eggrt.resv) free(eggrt.resv);
   eggrt.resv=0;
   eggrt.resc=eggrt.resa=0;
+  memset(&eggrt.romindex,0,sizeof(eggrt.romindex));
   #if ROMSRC==EXTERNAL
+    #if !USE_mswin
+      if (eggrt.rommapped) munmap((void*)eggrt.romserial,eggrt.romserialc);
+      else
+    #endif
     if (eggrt.romserial) free((void*)eggrt.romserial);
   #endif
   eggrt.romserial=0;
   eggrt.romserialc=0;
+  eggrt.rommapped=0;
+  memset(&eggrt.romtoc,0,sizeof(eggrt.romtoc));
 }
 
-/* Init.
+/* Map the ROM file read-only, so pages we never touch are never read.
+ * Returns <0 if it can't be mapped for any reason; caller should fall back to file_read.
  */
  
-int eggrt_romsrc_init() {
-
-  // Acquire the encoded ROM.
-  #if ROMSRC==EMBEDDED
-    eggrt.romserial=egg_embedded_rom;
-    eggrt.romserialc=egg_embedded_rom_size;
-  #elif ROMSRC==EXTERNAL
-    if (!eggrt.rompath) {
-      if (eggrt.configure_input) return 0;
-      fprintf(stderr,"%s: ROM required.\n",eggrt.exename);
-      return -2;
-    }
-    if ((eggrt.romserialc=file_read(&eggrt.romserial,eggrt.rompath))<0) {
-      eggrt.romserialc=0;
-      fprintf(stderr,"%s: Failed to read file.\n",eggrt.rompath);
-      return -2;
-    }
+#if ROMSRC==EXTERNAL
+static int eggrt_romsrc_map(const char *path) {
+  #if USE_mswin
+    return -1;
+  #else
+    int fd=open(path,O_RDONLY);
+    if (fd<0) return -1;
+    struct stat st;
+    if (fstat(fd,&st)<0) { close(fd); return -1; }
+    if ((st.st_size<1)||(st.st_size>INT_MAX)) { close(fd); return -1; }
+    void *v=mmap(0,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if (v==MAP_FAILED) return -1;
+    eggrt.romserial=v;
+    eggrt.romserialc=st.st_size;
+    eggrt.rommapped=1;
+    return 0;
   #endif
-  
-  // Split into a handy TOC.
+}
+#endif
+
+/* Read the full ROM into (resv). For ROMs without a TOC.
+ */
+ 
+static int eggrt_romsrc_scan() {
   eggrt.resc=0;
   struct rom_reader reader;
   if (rom_reader_init(&reader,eggrt.romserial,eggrt.romserialc)<0) {
@@ -72,11 +91,52 @@ int eggrt_romsrc_init() {
     memcpy(eggrt.resv+eggrt.resc,res,sizeof(struct rom_res));
     eggrt.resc++;
   }
+  if (rom_index_init(&eggrt.romindex,eggrt.resv,eggrt.resc,sizeof(struct rom_res))<0) return -1;
+  return 0;
+}
+
+/* Init.
+ */
+ 
+int eggrt_romsrc_init() {
+
+  // Acquire the encoded ROM.
+  #if ROMSRC==EMBEDDED
+    eggrt.romserial=egg_embedded_rom;
+    eggrt.romserialc=egg_embedded_rom_size;
+  #elif ROMSRC==EXTERNAL
+    if (!eggrt.rompath) {
+      if (eggrt.configure_input) return 0;
+      fprintf(stderr,"%s: ROM required.\n",eggrt.exename);
+      return -2;
+    }
+    if (eggrt_romsrc_map(eggrt.rompath)<0) {
+      if ((eggrt.romserialc=file_read(&eggrt.romserial,eggrt.rompath))<0) {
+        eggrt.romserialc=0;
+        fprintf(stderr,"%s: Failed to read file.\n",eggrt.rompath);
+        return -2;
+      }
+    }
+  #endif
   
-  // Confirm that metadata:1 is first. Elsewhere in eggrt, we will assume that that is so.
-  if ((eggrt.resc<1)||(eggrt.resv->tid!=EGG_TID_metadata)||(eggrt.resv->rid!=1)) {
-    fprintf(stderr,"%s: ROM does not begin with metadata:1 as required.\n",eggrt.rptname);
-    return -2;
+  /* Use the TOC if eggdev gave us one, otherwise split into our own.
+   * Either way, confirm that metadata:1 is first. Elsewhere in eggrt, we will assume that that is so.
+   */
+  struct rom_reader reader;
+  if ((rom_reader_init(&reader,eggrt.romserial,eggrt.romserialc)>=0)&&(rom_toc_init(&eggrt.romtoc,eggrt.romserial,eggrt.romserialc)>=0)) {
+    struct rom_res res;
+    if ((rom_toc_get_by_index(&res,&eggrt.romtoc,EGG_TID_metadata,0)<1)||(res.rid!=1)||(eggrt.romtoc.typev[0]!=EGG_TID_metadata)) {
+      fprintf(stderr,"%s: ROM does not begin with metadata:1 as required.\n",eggrt.rptname);
+      return -2;
+    }
+  } else {
+    memset(&eggrt.romtoc,0,sizeof(eggrt.romtoc));
+    int err=eggrt_romsrc_scan();
+    if (err<0) return err;
+    if ((eggrt.resc<1)||(eggrt.resv->tid!=EGG_TID_metadata)||(eggrt.resv->rid!=1)) {
+      fprintf(stderr,"%s: ROM does not begin with metadata:1 as required.\n",eggrt.rptname);
+      return -2;
+    }
   }
   
   //fprintf(stderr,"%s: Acquired %d-byte ROM with %d resources.\n",eggrt.rptname,eggrt.romserialc,eggrt.resc);
@@ -88,18 +148,27 @@ int eggrt_romsrc_init() {
  */
  
 int eggrt_rom_get(void *dstpp,int tid,int rid) {
-  int lo=0,hi=eggrt.resc;
-  while (lo<hi) {
-    int ck=(lo+hi)>>1;
-    const struct rom_res *res=eggrt.resv+ck;
-         if (tid<res->tid) hi=ck;
-    else if (tid>res->tid) lo=ck+1;
-    else if (rid<res->rid) hi=ck;
-    else if (rid>res->rid) lo=ck+1;
-    else {
-      *(const void**)dstpp=res->v;
-      return res->c;
-    }
+  if (eggrt.romtoc.typec) {
+    struct rom_res res;
+    if (rom_toc_get(&res,&eggrt.romtoc,tid,rid)<1) return 0;
+    *(const void**)dstpp=res.v;
+    return res.c;
   }
-  return 0;
+  int p=rom_index_search(&eggrt.romindex,tid,rid);
+  if (p<0) return 0;
+  const struct rom_res *res=eggrt.resv+p;
+  *(const void**)dstpp=res->v;
+  return res->c;
+}
+
+/* Get resource by index within type.
+ */
+ 
+int eggrt_rom_get_by_index(struct rom_res *dst,int tid,int p) {
+  if (eggrt.romtoc.typec) return rom_toc_get_by_index(dst,&eggrt.romtoc,tid,p);
+  if ((tid<0)||(tid>0xff)) return 0;
+  const struct rom_index_type *type=eggrt.romindex.typev+tid;
+  if ((p<0)||(p>=type->c)) return 0;
+  *dst=eggrt.resv[type->p+p];
+  return 1;
 }
@@ -1,5 +1,162 @@
 #include "eggrt_internal.h"
 
+/* Saving happens on a background thread, so games that touch the store every frame don't stall on disk.
+ * Main thread encodes the store and hands off the encoded text. If a write is still pending, the newer one replaces it.
+ * We write to a temp file and rename, so a crash mid-write leaves the previous save intact.
+ * Where we don't have pthreads, we write synchronously, but still honor --store-interval.
+ */
+#ifndef EGGRT_STORE_USE_THREADS
+  #if USE_mswin
+    #define EGGRT_STORE_USE_THREADS 0
+  #else
+    #define EGGRT_STORE_USE_THREADS 1
+  #endif
+#endif
+
+#if EGGRT_STORE_USE_THREADS
+  #include <pthread.h>
+#endif
+#if !USE_mswin
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+static struct eggrt_store_writer {
+  #if EGGRT_STORE_USE_THREADS
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int running; // Thread, mutex, and cond all initialized.
+  #endif
+  char *pending; // Encoded store waiting to be written. STRONG.
+  int pendingc;
+  int busy; // Writer thread is writing something it already took from (pending).
+  int stop;
+  double lastsave; // eggrt_now_real() at the last eggrt_store_save().
+} eggrt_store_writer={0};
+
+/* Write file atomically: Temp file, then rename over the real one, then sync the directory so the rename sticks.
+ * Safe to call from any thread; touches nothing global but (eggrt.storepath), which is constant.
+ */
+ 
+static int eggrt_store_write_file(const char *path,const void *src,int srcc) {
+  #if USE_mswin
+    return file_write(path,src,srcc);
+  #else
+    int pathc=0; while (path[pathc]) pathc++;
+    char *tmppath=malloc(pathc+5);
+    if (!tmppath) return -1;
+    memcpy(tmppath,path,pathc);
+    memcpy(tmppath+pathc,".tmp",5);
+    int fd=open(tmppath,O_WRONLY|O_CREAT|O_TRUNC,0666);
+    if (fd<0) {
+      free(tmppath);
+      return -1;
+    }
+    int srcp=0;
+    while (srcp<srcc) {
+      int err=write(fd,(char*)src+srcp,srcc-srcp);
+      if (err<=0) {
+        close(fd);
+        unlink(tmppath);
+        free(tmppath);
+        return -1;
+      }
+      srcp+=err;
+    }
+    if (fsync(fd)<0) {
+      close(fd);
+      unlink(tmppath);
+      free(tmppath);
+      return -1;
+    }
+    close(fd);
+    if (rename(tmppath,path)<0) {
+      unlink(tmppath);
+      free(tmppath);
+      return -1;
+    }
+    
+    // The new file's contents are durable, but its name isn't until the directory is.
+    // Some filesystems refuse to fsync a directory. The rename did happen, so that's not an error.
+    int slashp=pathc; while ((slashp>0)&&(tmppath[slashp-1]!='/')) slashp--;
+    if (!slashp) memcpy(tmppath,".",2);
+    else if (slashp==1) tmppath[1]=0;
+    else tmppath[slashp-1]=0;
+    if ((fd=open(tmppath,O_RDONLY))>=0) {
+      fsync(fd);
+      close(fd);
+    }
+    free(tmppath);
+    return 0;
+  #endif
+}
+
+/* Writer thread.
+ */
+ 
+#if EGGRT_STORE_USE_THREADS
+static void *eggrt_store_writer_main(void *arg) {
+  struct eggrt_store_writer *writer=arg;
+  pthread_mutex_lock(&writer->mutex);
+  for (;;) {
+    while (!writer->stop&&!writer->pending) pthread_cond_wait(&writer->cond,&writer->mutex);
+    if (!writer->pending) break; // Stopping, and nothing left to write.
+    char *v=writer->pending;
+    int c=writer->pendingc;
+    writer->pending=0;
+    writer->pendingc=0;
+    writer->busy=1;
+    pthread_mutex_unlock(&writer->mutex);
+    
+    if (eggrt_store_write_file(eggrt.storepath,v,c)<0) {
+      fprintf(stderr,"%s: Failed to write saved game, %d bytes.\n",eggrt.storepath,c);
+    }
+    free(v);
+    
+    pthread_mutex_lock(&writer->mutex);
+    writer->busy=0;
+    pthread_cond_broadcast(&writer->cond);
+  }
+  pthread_mutex_unlock(&writer->mutex);
+  return 0;
+}
+
+static int eggrt_store_writer_start(struct eggrt_store_writer *writer) {
+  if (writer->running) return 0;
+  if (pthread_mutex_init(&writer->mutex,0)) return -1;
+  if (pthread_cond_init(&writer->cond,0)) {
+    pthread_mutex_destroy(&writer->mutex);
+    return -1;
+  }
+  if (pthread_create(&writer->thread,0,eggrt_store_writer_main,writer)) {
+    pthread_cond_destroy(&writer->cond);
+    pthread_mutex_destroy(&writer->mutex);
+    return -1;
+  }
+  writer->running=1;
+  return 0;
+}
+#endif
+
+/* Flush: Save if dirty, and block until everything is on disk.
+ */
+ 
+void eggrt_store_flush() {
+  int err;
+  if (eggrt.store_dirty&&((err=eggrt_store_save())<0)) {
+    if (err!=-2) fprintf(stderr,"%s: Unspecified error saving game.\n",eggrt.storepath);
+  }
+  #if EGGRT_STORE_USE_THREADS
+    struct eggrt_store_writer *writer=&eggrt_store_writer;
+    if (writer->running) {
+      pthread_mutex_lock(&writer->mutex);
+      while (writer->pending||writer->busy) pthread_cond_wait(&writer->cond,&writer->mutex);
+      pthread_mutex_unlock(&writer->mutex);
+    }
+  #endif
+}
+
 /* Quit.
  */
  
@@ -9,6 +166,21 @@ static void eggrt_store_field_cleanup(struct eggrt_store_field *field) {
 }
  
 void eggrt_store_quit() {
+  eggrt_store_flush();
+  #if EGGRT_STORE_USE_THREADS
+    struct eggrt_store_writer *writer=&eggrt_store_writer;
+    if (writer->running) {
+      pthread_mutex_lock(&writer->mutex);
+      writer->stop=1;
+      pthread_cond_broadcast(&writer->cond);
+      pthread_mutex_unlock(&writer->mutex);
+      pthread_join(writer->thread,0);
+      pthread_cond_destroy(&writer->cond);
+      pthread_mutex_destroy(&writer->mutex);
+    }
+  #endif
+  if (eggrt_store_writer.pending) free(eggrt_store_writer.pending);
+  memset(&eggrt_store_writer,0,sizeof(eggrt_store_writer));
   if (eggrt.storev) {
     while (eggrt.storec-->0) eggrt_store_field_cleanup(eggrt.storev+eggrt.storec);
     free(eggrt.storev);
@@ -89,6 +261,8 @@ int eggrt_store_init() {
   int err;
   if (eggrt.storepath) {
     if ((err=eggrt_store_load_file(eggrt.storepath))<0) return err;
+  } else if (eggrt.store_nosave) {
+    fprintf(stderr,"%s: Starting with an empty store, which will not be saved.\n",eggrt.exename);
   } else {
     fprintf(stderr,"%s: Will not save game as --store unset.\n",eggrt.exename);
   }
@@ -105,14 +279,31 @@ int eggrt_store_init() {
  */
  
 int eggrt_store_save() {
+  if (eggrt.store_nosave) {
+    eggrt.store_dirty=0;
+    return 0;
+  }
   if (!eggrt.storepath) return -1;
   eggrt.store_dirty=0; // Clear dirty flag even if it fails. We won't try again until the next change.
+  eggrt_store_writer.lastsave=eggrt_now_real();
   struct sr_encoder encoder={0};
   if (eggrt_store_encode(&encoder)<0) {
     sr_encoder_cleanup(&encoder);
     return -1;
   }
-  int err=file_write(eggrt.storepath,encoder.v,encoder.c);
+  #if EGGRT_STORE_USE_THREADS
+    struct eggrt_store_writer *writer=&eggrt_store_writer;
+    if (writer->running||(eggrt_store_writer_start(writer)>=0)) {
+      pthread_mutex_lock(&writer->mutex);
+      if (writer->pending) free(writer->pending); // Never written, and now it's stale.
+      writer->pending=encoder.v; // HANDOFF
+      writer->pendingc=encoder.c;
+      pthread_cond_broadcast(&writer->cond);
+      pthread_mutex_unlock(&writer->mutex);
+      return 0;
+    }
+  #endif
+  int err=eggrt_store_write_file(eggrt.storepath,encoder.v,encoder.c);
   sr_encoder_cleanup(&encoder);
   if (err<0) {
     fprintf(stderr,"%s: Failed to write saved game, %d bytes.\n",eggrt.storepath,encoder.c);
@@ -121,6 +312,18 @@ int eggrt_store_save() {
   return 0;
 }
 
+/* Save if dirty and it's been long enough since the last one.
+ */
+ 
+int eggrt_store_update() {
+  if (!eggrt.store_dirty) return 0;
+  if (eggrt.store_interval_ms>0) {
+    double now=eggrt_now_real();
+    if (now-eggrt_store_writer.lastsave<eggrt.store_interval_ms/1000.0) return 0;
+  }
+  return eggrt_store_save();
+}
+
 /* Validate text.
  */
  
@@ -194,7 +397,7 @@ struct eggrt_store_field *eggrt_store_get_field(const char *k,int kc,int create)
  */
  
 int eggrt_store_set_field(struct eggrt_store_field *field,const char *v,int vc) {
-  if (!eggrt.storepath) return -1; // No saving, and we won't pretend to.
+  if (!eggrt.storepath&&!eggrt.store_nosave) return -1; // No saving, and we won't pretend to.
   if (!field) return -1;
   if ((field<eggrt.storev)||(field-eggrt.storev>=eggrt.storec)) return -1;
   if (!v) vc=0; else if (vc<0) { vc=0; while (v[vc]) vc++; }
@@ -106,4 +106,55 @@ struct texcache {
 
 int texcache_get_image(struct texcache *tc,int imageid);
 
+/* (struct texatlas) packs small read-only images into a few shared textures ("pages").
+ * texatlas_get_image returns the page's texid, and the image's bounds within it.
+ * Decals from different images on the same page are the same srctexid to graf, so they batch into one draw.
+ * Images larger than TEXATLAS_IMAGE_SIZE_LIMIT on either axis are refused; use texcache for those.
+ * Images decode straight into their slot with egg_texture_load_image_sub; the rest of the page is untouched.
+ * When everything is full, we evict the least recently used image whose slot is large enough, and reuse just that slot.
+ * That does flush (graf) first, if you set it.
+ * Initialize to zero, and texatlas_cleanup when you're done.
+ *******************************************************************************/
+
+#define TEXATLAS_PAGE_SIZE 512
+#define TEXATLAS_PAGE_LIMIT 4
+#define TEXATLAS_IMAGE_LIMIT 64
+#define TEXATLAS_IMAGE_SIZE_LIMIT 256
+#define TEXATLAS_SHELF_LIMIT 32
+
+struct texatlas {
+  struct texatlas_page {
+    int texid;
+    struct texatlas_shelf {
+      int y,h; // Shelves run the full width of the page, and new ones stack downward.
+      int x; // Next free column.
+    } shelfv[TEXATLAS_SHELF_LIMIT];
+    int shelfc;
+  } pagev[TEXATLAS_PAGE_LIMIT];
+  int pagec;
+  struct texatlas_entry {
+    int imageid;
+    int pagep;
+    int x,y,w,h; // Image's bounds in the page.
+    int slotw,sloth; // Space reserved for it, which might be larger if we've evicted into it.
+    int seq;
+  } entryv[TEXATLAS_IMAGE_LIMIT];
+  int entryc;
+  int seq;
+  int evictc; // Monitor for performance reporting, same as texcache.
+  struct graf *graf; // WEAK, optional.
+};
+
+void texatlas_cleanup(struct texatlas *ta);
+
+/* Returns texid, or zero on errors.
+ * (x,y,w,h) are the image's bounds within that texture. Each is optional.
+ */
+int texatlas_get_image(int *x,int *y,int *w,int *h,struct texatlas *ta,int imageid);
+
+/* graf_draw_decal of the whole image, fetching it from (ta).
+ * Consecutive images from the same page batch into one draw.
+ */
+void graf_draw_image(struct graf *graf,struct texatlas *ta,int imageid,int16_t dstx,int16_t dsty,uint8_t xform);
+
 #endif
@@ -0,0 +1,166 @@
+#include "graf.h"
+#include "egg/egg.h"
+#include "opt/stdlib/egg-stdlib.h"
+
+/* Images are placed with this much space after them on both axes, so interpolated mode7 doesn't bleed into neighbors.
+ */
+#define TEXATLAS_GUTTER 1
+
+/* Cleanup.
+ */
+
+void texatlas_cleanup(struct texatlas *ta) {
+  struct texatlas_page *page=ta->pagev;
+  int i=ta->pagec;
+  for (;i-->0;page++) {
+    if (page->texid) egg_texture_del(page->texid);
+  }
+  memset(ta,0,sizeof(struct texatlas));
+}
+
+/* Find space for a (w,h) slot in one page, using the shortest shelf that fits.
+ */
+
+static int texatlas_page_place(int *x,int *y,struct texatlas_page *page,int w,int h) {
+  struct texatlas_shelf *best=0,*shelf=page->shelfv;
+  int i=page->shelfc,nexty=0;
+  for (;i-->0;shelf++) {
+    if (shelf->y+shelf->h>nexty) nexty=shelf->y+shelf->h;
+    if (shelf->h<h) continue;
+    if (shelf->x>TEXATLAS_PAGE_SIZE-w) continue;
+    if (!best||(shelf->h<best->h)) best=shelf;
+  }
+  if (!best) {
+    if (page->shelfc>=TEXATLAS_SHELF_LIMIT) return -1;
+    if (nexty>TEXATLAS_PAGE_SIZE-h) return -1;
+    best=page->shelfv+page->shelfc++;
+    best->y=nexty;
+    best->h=h;
+    best->x=0;
+  }
+  *x=best->x;
+  *y=best->y;
+  best->x+=w;
+  return 0;
+}
+
+/* Find space for a new image, adding a page if needed.
+ */
+
+static int texatlas_place(int *pagep,int *x,int *y,struct texatlas *ta,int w,int h) {
+  int i=0; for (;i<ta->pagec;i++) {
+    if (texatlas_page_place(x,y,ta->pagev+i,w,h)>=0) {
+      *pagep=i;
+      return 0;
+    }
+  }
+  if (ta->pagec>=TEXATLAS_PAGE_LIMIT) return -1;
+  struct texatlas_page *page=ta->pagev+ta->pagec;
+  memset(page,0,sizeof(struct texatlas_page));
+  if ((page->texid=egg_texture_new())<1) {
+    page->texid=0;
+    return -1;
+  }
+  if (egg_texture_load_raw(page->texid,TEXATLAS_PAGE_SIZE,TEXATLAS_PAGE_SIZE,TEXATLAS_PAGE_SIZE<<2,0,0)<0) {
+    egg_texture_del(page->texid);
+    page->texid=0;
+    return -1;
+  }
+  ta->pagec++;
+  *pagep=ta->pagec-1;
+  return texatlas_page_place(x,y,page,w,h);
+}
+
+/* Entry freed by a failed load, whose slot can hold (w,h).
+ */
+
+static struct texatlas_entry *texatlas_find_free(struct texatlas *ta,int w,int h) {
+  struct texatlas_entry *entry=ta->entryv;
+  int i=ta->entryc;
+  for (;i-->0;entry++) {
+    if (entry->imageid) continue;
+    if ((entry->slotw<w)||(entry->sloth<h)) continue;
+    return entry;
+  }
+  return 0;
+}
+
+/* Least recently used entry whose slot can hold (w,h).
+ */
+
+static struct texatlas_entry *texatlas_find_victim(struct texatlas *ta,int w,int h) {
+  struct texatlas_entry *victim=0,*entry=ta->entryv;
+  int i=ta->entryc;
+  for (;i-->0;entry++) {
+    if ((entry->slotw<w)||(entry->sloth<h)) continue;
+    if (!victim||(entry->seq<victim->seq)) victim=entry;
+  }
+  return victim;
+}
+
+/* Get image.
+ */
+
+int texatlas_get_image(int *x,int *y,int *w,int *h,struct texatlas *ta,int imageid) {
+  if (!imageid) return 0; // Zero marks a free slot.
+  struct texatlas_entry *entry=ta->entryv;
+  int i=ta->entryc;
+  for (;i-->0;entry++) {
+    if (entry->imageid!=imageid) continue;
+    entry->seq=++(ta->seq);
+    if (x) *x=entry->x;
+    if (y) *y=entry->y;
+    if (w) *w=entry->w;
+    if (h) *h=entry->h;
+    return ta->pagev[entry->pagep].texid;
+  }
+
+  int imgw=0,imgh=0;
+  if (egg_image_get_size(&imgw,&imgh,imageid)<0) return 0;
+  if ((imgw<1)||(imgh<1)||(imgw>TEXATLAS_IMAGE_SIZE_LIMIT)||(imgh>TEXATLAS_IMAGE_SIZE_LIMIT)) return 0;
+  int slotw=imgw+TEXATLAS_GUTTER,sloth=imgh+TEXATLAS_GUTTER;
+
+  // Reuse a freed slot, or make a new one if there's room, otherwise evict.
+  int pagep,slotx,sloty;
+  if (entry=texatlas_find_free(ta,slotw,sloth)) {
+    // Nothing drawn references a free slot, so no flush.
+  } else if ((ta->entryc<TEXATLAS_IMAGE_LIMIT)&&(texatlas_place(&pagep,&slotx,&sloty,ta,slotw,sloth)>=0)) {
+    entry=ta->entryv+ta->entryc++;
+    entry->pagep=pagep;
+    entry->x=slotx;
+    entry->y=sloty;
+    entry->slotw=slotw;
+    entry->sloth=sloth;
+  } else {
+    if (!(entry=texatlas_find_victim(ta,slotw,sloth))) return 0;
+    if (ta->graf) graf_flush(ta->graf);
+    ta->evictc++;
+  }
+  entry->imageid=imageid;
+  entry->w=imgw;
+  entry->h=imgh;
+  entry->seq=++(ta->seq);
+  // Decode straight into the slot. This also clears the gutter and whatever we evicted.
+  // If it fails, free the slot: lookups skip it, and the next image that fits takes it without evicting anything.
+  if (egg_texture_load_image_sub(ta->pagev[entry->pagep].texid,entry->x,entry->y,entry->slotw,entry->sloth,imageid)<0) {
+    entry->imageid=0;
+    entry->seq=0;
+    return 0;
+  }
+
+  if (x) *x=entry->x;
+  if (y) *y=entry->y;
+  if (w) *w=entry->w;
+  if (h) *h=entry->h;
+  return ta->pagev[entry->pagep].texid;
+}
+
+/* Draw image from atlas.
+ */
+ 
+void graf_draw_image(struct graf *graf,struct texatlas *ta,int imageid,int16_t dstx,int16_t dsty,uint8_t xform) {
+  int x,y,w,h;
+  int texid=texatlas_get_image(&x,&y,&w,&h,ta,imageid);
+  if (!texid) return;
+  graf_draw_decal(graf,texid,dstx,dsty,x,y,w,h,xform);
+}
@@ -60,6 +60,12 @@ struct hostio_video_type {
   
   int (*gx_begin)(struct hostio_video *driver);
   int (*gx_end)(struct hostio_video *driver);
+  
+  /* Software drivers have no GL context. Owner must use a software renderer, and deliver each frame via put_frame.
+   * (rgba) is (w*4) stride, top row first. Called between gx_begin and gx_end.
+   */
+  int software;
+  int (*put_frame)(struct hostio_video *driver,const void *rgba,int w,int h);
 };
 
 void hostio_video_del(struct hostio_video *driver);
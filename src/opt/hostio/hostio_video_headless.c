@@ -0,0 +1,115 @@
+/* hostio_video_headless.c
+ * Video driver with no window and no GL. Owner renders in software and gives us each frame.
+ * Never selected by default; ask for it with "--video=headless".
+ * If (device) is given, it's a directory and we write each frame there as a binary PPM: "000000.ppm", "000001.ppm", ...
+ * Otherwise frames are discarded.
+ */
+
+#include "hostio_internal.h"
+
+struct hostio_video_headless {
+  struct hostio_video hdr;
+  char *dir;
+  int framec;
+  uint8_t *rowbuf;
+  int rowbufa;
+};
+
+#define DRIVER ((struct hostio_video_headless*)driver)
+
+/* Delete.
+ */
+
+static void _headless_del(struct hostio_video *driver) {
+  if (DRIVER->dir) free(DRIVER->dir);
+  if (DRIVER->rowbuf) free(DRIVER->rowbuf);
+}
+
+/* Init.
+ * Window size is exactly the framebuffer, there's no reason to scale.
+ */
+
+static int _headless_init(struct hostio_video *driver,const struct hostio_video_setup *setup) {
+  if ((setup->fbw>0)&&(setup->fbh>0)) {
+    driver->w=setup->fbw;
+    driver->h=setup->fbh;
+  } else if ((setup->w>0)&&(setup->h>0)) {
+    driver->w=setup->w;
+    driver->h=setup->h;
+  } else {
+    driver->w=640;
+    driver->h=360;
+  }
+  driver->viewscale=1;
+  if (setup->device&&setup->device[0]) {
+    if (!(DRIVER->dir=strdup(setup->device))) return -1;
+  }
+  return 0;
+}
+
+/* GX fences, noop.
+ */
+
+static int _headless_gx_begin(struct hostio_video *driver) {
+  return 0;
+}
+
+static int _headless_gx_end(struct hostio_video *driver) {
+  return 0;
+}
+
+/* Receive frame.
+ */
+
+static int _headless_put_frame(struct hostio_video *driver,const void *rgba,int w,int h) {
+  int frameid=DRIVER->framec++;
+  if (!DRIVER->dir||!rgba||(w<1)||(h<1)) return 0;
+  char path[1024];
+  int pathc=snprintf(path,sizeof(path),"%s/%06d.ppm",DRIVER->dir,frameid);
+  if ((pathc<1)||(pathc>=sizeof(path))) return -1;
+  if (w*3>DRIVER->rowbufa) {
+    void *nv=realloc(DRIVER->rowbuf,w*3);
+    if (!nv) return -1;
+    DRIVER->rowbuf=nv;
+    DRIVER->rowbufa=w*3;
+  }
+  FILE *f=fopen(path,"wb");
+  if (!f) {
+    fprintf(stderr,"%s: Failed to open file for writing.\n",path);
+    return -2;
+  }
+  fprintf(f,"P6\n%d %d\n255\n",w,h);
+  const uint8_t *src=rgba;
+  int yi=h; for (;yi-->0;) {
+    uint8_t *dst=DRIVER->rowbuf;
+    int xi=w; for (;xi-->0;dst+=3,src+=4) {
+      dst[0]=src[0];
+      dst[1]=src[1];
+      dst[2]=src[2];
+    }
+    if (fwrite(DRIVER->rowbuf,3,w,f)!=w) {
+      fclose(f);
+      fprintf(stderr,"%s: Error writing file.\n",path);
+      return -2;
+    }
+  }
+  fclose(f);
+  return 0;
+}
+
+/* Type definition.
+ */
+
+const struct hostio_video_type hostio_video_type_headless={
+  .name="headless",
+  .desc="No window, software rendering. --video-device=DIR to dump frames.",
+  .objlen=sizeof(struct hostio_video_headless),
+  .appointment_only=1,
+  .provides_input=0,
+  .del=_headless_del,
+  .init=_headless_init,
+  .gx_begin=_headless_gx_begin,
+  .gx_end=_headless_gx_end,
+  .software=1,
+  .put_frame=_headless_put_frame,
+};
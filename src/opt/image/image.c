@@ -196,6 +196,67 @@ static int image_cvt_32_1(int pixel,void *userdata) {
   return pixel?0xffffffff:0;
 }
 
+static int image_cvt_32_24(int pixel,void *userdata) {
+  return (pixel<<8)|0xff;
+}
+
+/* Fast paths for the common conversions to RGBA, bypassing the iterator.
+ * Must produce exactly what the generic path would, with the default converters.
+ * Returns nonzero if handled.
+ */
+ 
+static int image_reformat_fast(uint8_t *dst,int dstpixelsize,int dstw,int dsth,int dststride,const struct image *srcimage) {
+  if ((dstpixelsize!=32)||(dstw!=srcimage->w)||(dsth!=srcimage->h)) return 0;
+  const uint8_t *srcrow=srcimage->v;
+  int yi=dsth;
+  switch (srcimage->pixelsize) {
+  
+    case 1: for (;yi-->0;dst+=dststride,srcrow+=srcimage->stride) {
+        uint8_t *dstp=dst;
+        const uint8_t *srcp=srcrow;
+        int xi=dstw;
+        for (;xi>=8;xi-=8,srcp++,dstp+=32) {
+          uint8_t bits=*srcp;
+          if (!bits) { memset(dstp,0,32); continue; }
+          if (bits==0xff) { memset(dstp,0xff,32); continue; }
+          uint8_t mask=0x80,i=0;
+          for (;mask;mask>>=1,i+=4) memset(dstp+i,(bits&mask)?0xff:0,4);
+        }
+        if (xi) {
+          uint8_t mask=0x80;
+          for (;xi-->0;mask>>=1,dstp+=4) memset(dstp,((*srcp)&mask)?0xff:0,4);
+        }
+      } return 1;
+      
+    case 8: for (;yi-->0;dst+=dststride,srcrow+=srcimage->stride) {
+        uint8_t *dstp=dst;
+        const uint8_t *srcp=srcrow;
+        int xi=dstw;
+        for (;xi-->0;srcp++,dstp+=4) {
+          dstp[0]=dstp[1]=dstp[2]=0;
+          dstp[3]=*srcp;
+        }
+      } return 1;
+      
+    case 24: for (;yi-->0;dst+=dststride,srcrow+=srcimage->stride) {
+        uint8_t *dstp=dst;
+        const uint8_t *srcp=srcrow;
+        int xi=dstw;
+        for (;xi-->0;srcp+=3,dstp+=4) {
+          dstp[0]=srcp[0];
+          dstp[1]=srcp[1];
+          dstp[2]=srcp[2];
+          dstp[3]=0xff;
+        }
+      } return 1;
+      
+    case 32: for (;yi-->0;dst+=dststride,srcrow+=srcimage->stride) {
+        memmove(dst,srcrow,dstw<<2);
+      } return 1;
+  }
+  return 0;
+}
+
 /* Generic reformat.
  */
  
@@ -205,6 +266,7 @@ static void image_reformat_inner(
   int (*cvt)(int pixel,void *userdata),
   void *userdata
 ) {
+  if ((!cvt||(cvt==image_cvt_32_1)||(cvt==image_cvt_32_24))&&image_reformat_fast(dst,dstpixelsize,dstw,dsth,dststride,srcimage)) return;
   const uint8_t *srcrow=srcimage->v;
   int cpw=(dstw<srcimage->w)?dstw:srcimage->w;
   int cph=(dsth<srcimage->h)?dsth:srcimage->h;
@@ -244,6 +306,7 @@ int image_reformat_in_place(
   if ((image->pixelsize==pixelsize)&&(image->w==w)&&(image->h==h)&&(image->stride==nstride)) return 0;
   if (!cvt) {
     if ((image->pixelsize==1)&&(pixelsize==32)) cvt=image_cvt_32_1;
+    else if ((image->pixelsize==24)&&(pixelsize==32)) cvt=image_cvt_32_24;
   }
   if (nstride>INT_MAX/h) return -1;
   int nlen=nstride*h;
@@ -307,9 +370,10 @@ const char *image_format_repr(int format) {
 
 int image_format_guess(const void *src,int srcc) {
   if (!src) return 0;
+  const uint8_t *b=src;
   #if IMAGE_FORMAT_png
-    const uint8_t *b=src;
     if ((srcc>=8)&&!memcmp(src,"\x89PNG\r\n\x1a\n",8)) return IMAGE_FORMAT_png;
   #endif
+  if ((srcc>=10)&&!memcmp(src,"\0EI\xff",4)) return b[9]?IMAGE_FORMAT_lzimg:IMAGE_FORMAT_rawimg;
   return 0;
 }
@@ -11,11 +11,17 @@ struct sr_encoder;
  * But I've eliminated runtime image decoding, so now we can only support formats that browsers also support.
  * If we ever feel like supporting GIF, BMP, JPEG, etc, we could add them here.
  * But I think the recommendation will be to use PNG for everything.
+ * Exception: "rawimg" and "lzimg" are our own pre-decoded formats, see rawimg.c.
+ * `eggdev pack --image-format=` produces them, for games that prefer load time over ROM size.
  */
 #define IMAGE_FORMAT_png 1
+#define IMAGE_FORMAT_rawimg 2
+#define IMAGE_FORMAT_lzimg 3
 
 #define IMAGE_FORMAT_FOR_EACH \
-  _(png)
+  _(png) \
+  _(rawimg) \
+  _(lzimg)
   
 #define IMAGE_HINT_ALPHA   0x01
 #define IMAGE_HINT_LUMA    0x02
@@ -84,6 +90,23 @@ int image_encode(struct sr_encoder *dst,struct image *image,int format);
 IMAGE_FORMAT_FOR_EACH
 #undef _
 
+/* If (src) is an uncompressed rawimg, populate (dst) with (v) pointing into (src) and return the pixels length.
+ * That's WEAK; don't modify or free it. Lets the runtime upload pre-decoded images straight from the ROM.
+ */
+int rawimg_decode_weak(struct image *dst,const void *src,int srcc);
+
+/* Global settings for png_encode. Not thread-safe; set once before encoding.
+ * FAST picks filters without trials and deflates at level 1, for iteration builds.
+ * DEFAULT is what we've always done: trial filters and Z_BEST_COMPRESSION.
+ * MAX also tries alternate filter heuristics and zlib strategies, and keeps the smallest.
+ * (threadc) is for large images: FAST and DEFAULT deflate in independent row groups, stitched into one stream.
+ * Output does not depend on (threadc).
+ */
+#define IMAGE_EFFORT_FAST 1
+#define IMAGE_EFFORT_DEFAULT 2
+#define IMAGE_EFFORT_MAX 3
+void png_encode_configure(int effort,int threadc);
+
 int image_format_eval(const char *src,int srcc);
 const char *image_format_repr(int format); // null if unknown
 
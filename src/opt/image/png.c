@@ -2,10 +2,39 @@
   int png_dummy=0;
 #else
 
+/* Unfiltering uses SSE2 when the compiler targets it. Build with -DIMAGE_USE_SIMD=0 to force scalar.
+ * Encoding may use threads, see png_encode_configure(). Build with -DIMAGE_USE_THREADS=0 to keep it all on the caller's thread.
+ */
+#ifndef IMAGE_USE_SIMD
+  #if defined(__SSE2__)
+    #define IMAGE_USE_SIMD 1
+  #else
+    #define IMAGE_USE_SIMD 0
+  #endif
+#endif
+#ifndef IMAGE_USE_THREADS
+  #if USE_mswin
+    #define IMAGE_USE_THREADS 0
+  #else
+    #define IMAGE_USE_THREADS 1
+  #endif
+#endif
+
+/* PNG needs zlib, so it's only ever built natively, and we can use the real libc.
+ * Its headers would conflict with egg-stdlib, which we used to include here.
+ */
 #include "image.h"
 #include "opt/serial/serial.h"
-#include "opt/stdlib/egg-stdlib.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 #include <zlib.h>
+#if IMAGE_USE_SIMD
+  #include <emmintrin.h>
+#endif
+#if IMAGE_USE_THREADS
+  #include <pthread.h>
+#endif
 
 #ifndef IMAGE_ENABLE_ENCODERS
   #define IMAGE_ENABLE_ENCODERS 1
@@ -140,6 +169,101 @@ static void png_unfilter_PAETH(uint8_t *dst,const uint8_t *src,const uint8_t *pr
   }
 }
 
+#if IMAGE_USE_SIMD
+
+/* SIMD unfilters.
+ * UP has no horizontal dependency, so it goes 16 bytes at a time.
+ * The others depend on the pixel to their left, so they go one pixel at a time, all channels at once.
+ * (xstride) must be 3 or 4, and (prv) not null except for SUB.
+ */
+ 
+static inline __m128i png_load_pixel(const uint8_t *src,int xstride) {
+  uint32_t v=0;
+  if (xstride==4) memcpy(&v,src,4); // Constant lengths, so these inline.
+  else memcpy(&v,src,3);
+  return _mm_cvtsi32_si128(v);
+}
+
+static inline void png_store_pixel(uint8_t *dst,__m128i v,int xstride) {
+  uint32_t w=_mm_cvtsi128_si32(v);
+  if (xstride==4) memcpy(dst,&w,4);
+  else memcpy(dst,&w,3);
+}
+ 
+static void png_unfilter_UP_simd(uint8_t *dst,const uint8_t *src,const uint8_t *prv,int stride) {
+  for (;stride>=16;stride-=16,dst+=16,src+=16,prv+=16) {
+    __m128i s=_mm_loadu_si128((const __m128i*)src);
+    __m128i p=_mm_loadu_si128((const __m128i*)prv);
+    _mm_storeu_si128((__m128i*)dst,_mm_add_epi8(s,p));
+  }
+  for (;stride-->0;dst++,src++,prv++) *dst=(*src)+(*prv);
+}
+ 
+static void png_unfilter_SUB_simd(uint8_t *dst,const uint8_t *src,int stride,int xstride) {
+  __m128i a=_mm_setzero_si128();
+  for (;stride>=xstride;stride-=xstride,dst+=xstride,src+=xstride) {
+    a=_mm_add_epi8(png_load_pixel(src,xstride),a);
+    png_store_pixel(dst,a,xstride);
+  }
+}
+
+static void png_unfilter_AVG_simd(uint8_t *dst,const uint8_t *src,const uint8_t *prv,int stride,int xstride) {
+  // _mm_avg_epu8 rounds up, PNG rounds down. Subtract the low bit of (a^b) to fix.
+  const __m128i one=_mm_set1_epi8(1);
+  __m128i a=_mm_setzero_si128();
+  for (;stride>=xstride;stride-=xstride,dst+=xstride,src+=xstride,prv+=xstride) {
+    __m128i b=png_load_pixel(prv,xstride);
+    __m128i avg=_mm_sub_epi8(_mm_avg_epu8(a,b),_mm_and_si128(_mm_xor_si128(a,b),one));
+    a=_mm_add_epi8(png_load_pixel(src,xstride),avg);
+    png_store_pixel(dst,a,xstride);
+  }
+}
+
+static void png_unfilter_PAETH_simd(uint8_t *dst,const uint8_t *src,const uint8_t *prv,int stride,int xstride) {
+  // Predictor in 16-bit lanes: pa=|b-c|, pb=|a-c|, pc=|a+b-2c|, then pick a, b, or c as the scalar version does.
+  const __m128i zero=_mm_setzero_si128();
+  __m128i a=zero,c=zero;
+  for (;stride>=xstride;stride-=xstride,dst+=xstride,src+=xstride,prv+=xstride) {
+    __m128i b=_mm_unpacklo_epi8(png_load_pixel(prv,xstride),zero);
+    __m128i pa=_mm_sub_epi16(b,c);
+    __m128i pb=_mm_sub_epi16(a,c);
+    __m128i pc=_mm_add_epi16(pa,pb);
+    pa=_mm_max_epi16(pa,_mm_sub_epi16(zero,pa));
+    pb=_mm_max_epi16(pb,_mm_sub_epi16(zero,pb));
+    pc=_mm_max_epi16(pc,_mm_sub_epi16(zero,pc));
+    __m128i pc_lt_pb=_mm_cmpgt_epi16(pb,pc);
+    __m128i use_b=_mm_andnot_si128(pc_lt_pb,_mm_cmpgt_epi16(pa,pb));
+    __m128i use_c=_mm_and_si128(pc_lt_pb,_mm_cmpgt_epi16(pa,pc));
+    __m128i pred=_mm_andnot_si128(_mm_or_si128(use_b,use_c),a);
+    pred=_mm_or_si128(pred,_mm_and_si128(use_b,b));
+    pred=_mm_or_si128(pred,_mm_and_si128(use_c,c));
+    __m128i out=_mm_add_epi8(png_load_pixel(src,xstride),_mm_packus_epi16(pred,zero));
+    png_store_pixel(dst,out,xstride);
+    a=_mm_unpacklo_epi8(out,zero);
+    c=b;
+  }
+}
+
+/* Nonzero if we unfiltered it, zero to fall back to scalar.
+ */
+ 
+static int png_unfilter_simd(uint8_t *dst,const uint8_t *src,const uint8_t *prv,int filter,int stride,int xstride) {
+  if (filter==2) {
+    if (!prv) return 0;
+    png_unfilter_UP_simd(dst,src,prv,stride);
+    return 1;
+  }
+  if ((xstride!=3)&&(xstride!=4)) return 0;
+  switch (filter) {
+    case 1: png_unfilter_SUB_simd(dst,src,stride,xstride); return 1;
+    case 3: if (!prv) return 0; png_unfilter_AVG_simd(dst,src,prv,stride,xstride); return 1;
+    case 4: if (!prv) return 0; png_unfilter_PAETH_simd(dst,src,prv,stride,xstride); return 1;
+  }
+  return 0;
+}
+
+#endif
+
 /* Receive filtered pixels from (decoder->rowbuf).
  */
  
@@ -149,6 +273,12 @@ static int png_decoder_finish_row(struct png_decoder *decoder) {
     dst+=decoder->image->stride*decoder->y;
     const uint8_t *prv=0;
     if (decoder->y) prv=dst-decoder->image->stride;
+    #if IMAGE_USE_SIMD
+      if (png_unfilter_simd(dst,decoder->rowbuf+1,prv,decoder->rowbuf[0],decoder->image->stride,decoder->xstride)) {
+        decoder->y++;
+        return 0;
+      }
+    #endif
     switch (decoder->rowbuf[0]) {
       case 0: memcpy(dst,decoder->rowbuf+1,decoder->image->stride); break;
       case 1: png_unfilter_SUB(dst,decoder->rowbuf+1,prv,decoder->image->stride,decoder->xstride); break;
@@ -328,19 +458,87 @@ int png_decode_header(struct image *dst,const void *_src,int srcc) {
 struct png_encoder {
   struct sr_encoder *dst; // WEAK
   struct image *image; // WEAK
-  uint8_t *rowbuf;
   int rowbufc; // including filter byte, ie 1+stride
   int xstride; // bytes column to column for filter purposes (min 1)
   int stride; // May be less than input.
-  z_stream *z; // Initialized if not null.
+  uint8_t *filtered[2]; // (rowbufc*h), filter bytes and filtered rows. Second only for IMAGE_EFFORT_MAX.
 };
 
 static void png_encoder_cleanup(struct png_encoder *ctx) {
-  if (ctx->rowbuf) free(ctx->rowbuf);
-  if (ctx->z) {
-    deflateEnd(ctx->z);
-    free(ctx->z);
+  if (ctx->filtered[0]) free(ctx->filtered[0]);
+  if (ctx->filtered[1]) free(ctx->filtered[1]);
+}
+
+/* Global settings.
+ */
+ 
+static int png_encode_effort=IMAGE_EFFORT_DEFAULT;
+static int png_encode_threadc=1;
+
+#define PNG_THREAD_LIMIT 64
+#define PNG_GROUP_SIZE (256<<10) /* Filtered bytes per independently-deflated row group. Affects output, not just speed. */
+#define PNG_WINDOW_SIZE 32768
+
+void png_encode_configure(int effort,int threadc) {
+  switch (effort) {
+    case IMAGE_EFFORT_FAST: case IMAGE_EFFORT_DEFAULT: case IMAGE_EFFORT_MAX: png_encode_effort=effort; break;
+    default: png_encode_effort=IMAGE_EFFORT_DEFAULT;
   }
+  if (threadc<1) png_encode_threadc=1;
+  else if (threadc>PNG_THREAD_LIMIT) png_encode_threadc=PNG_THREAD_LIMIT;
+  else png_encode_threadc=threadc;
+}
+
+/* Run a list of jobs on up to (png_encode_threadc) threads, including the caller's.
+ * Jobs must not depend on each other.
+ */
+ 
+struct png_runner {
+  void (*fn)(void *job);
+  uint8_t *jobv;
+  int jobsize,jobc,next;
+  #if IMAGE_USE_THREADS
+    pthread_mutex_t mutex;
+  #endif
+};
+
+#if IMAGE_USE_THREADS
+static void *png_runner_thread(void *arg) {
+  struct png_runner *runner=arg;
+  for (;;) {
+    pthread_mutex_lock(&runner->mutex);
+    int p=runner->next++;
+    pthread_mutex_unlock(&runner->mutex);
+    if (p>=runner->jobc) return 0;
+    runner->fn(runner->jobv+p*runner->jobsize);
+  }
+}
+#endif
+
+static void png_run_jobs(void (*fn)(void *job),void *jobv,int jobsize,int jobc) {
+  int threadc=(png_encode_threadc<jobc)?png_encode_threadc:jobc;
+  #if IMAGE_USE_THREADS
+    struct png_runner runner={
+      .fn=fn,
+      .jobv=jobv,
+      .jobsize=jobsize,
+      .jobc=jobc,
+    };
+    if ((threadc>1)&&!pthread_mutex_init(&runner.mutex,0)) {
+      pthread_t threadv[PNG_THREAD_LIMIT];
+      int startc=0;
+      while (startc<threadc-1) {
+        if (pthread_create(threadv+startc,0,png_runner_thread,&runner)) break;
+        startc++;
+      }
+      png_runner_thread(&runner);
+      while (startc-->0) pthread_join(threadv[startc],0);
+      pthread_mutex_destroy(&runner.mutex);
+      return;
+    }
+  #endif
+  uint8_t *job=jobv;
+  for (;jobc-->0;job+=jobsize) fn(job);
 }
 
 /* Add one chunk to encoder.
@@ -503,46 +701,224 @@ static uint8_t png_filter_row(uint8_t *dst,const uint8_t *src,const uint8_t *prv
   return 3;
 }
 
-/* Allocate more space in master output if needed, and point zlib to it.
+/* Alternate filter selection for IMAGE_EFFORT_MAX: Minimum sum of absolute differences, as libpng does.
+ * Results vary by image whether this or counting zeroes compresses better, so max effort tries both.
  */
  
-static int png_encoder_require_zlib_output(struct png_encoder *ctx) {
-  if (sr_encoder_require(ctx->dst,8192)<0) return -1;
-  ctx->z->next_out=(Bytef*)ctx->dst->v+ctx->dst->c;
-  ctx->z->avail_out=ctx->dst->a-ctx->dst->c;
-  return 0;
+static int png_sum_abs(const uint8_t *v,int c) {
+  int sum=0;
+  for (;c-->0;v++) sum+=(*v<0x80)?*v:(0x100-*v);
+  return sum;
+}
+ 
+static uint8_t png_filter_row_minsum(uint8_t *dst,const uint8_t *src,const uint8_t *prv,int c,int xstride) {
+  int (*filterv[5])(uint8_t*,const uint8_t*,const uint8_t*,int,int)={
+    png_filter_row_NONE,png_filter_row_SUB,png_filter_row_UP,png_filter_row_AVG,png_filter_row_PAETH,
+  };
+  int best=0,bestscore=INT_MAX;
+  int filter=prv?4:1; // Only NONE and SUB for the first row.
+  for (;filter>=0;filter--) {
+    filterv[filter](dst,src,prv,c,xstride);
+    int score=png_sum_abs(dst,c);
+    if (score<=bestscore) {
+      best=filter;
+      bestscore=score;
+    }
+  }
+  // NONE was the last one run, so it's already in (dst).
+  if (best) filterv[best](dst,src,prv,c,xstride);
+  return best;
 }
 
-/* Feed (rowbuf) into zlib, and advance output as needed.
+/* Filter selection for IMAGE_EFFORT_FAST: No trials.
+ * NONE for sub-byte pixels as libpng recommends, otherwise PAETH, which is usually the best single choice.
  */
  
-static int png_encode_row(struct png_encoder *ctx) {
-  ctx->z->next_in=(Bytef*)ctx->rowbuf;
-  ctx->z->avail_in=ctx->rowbufc;
-  while (ctx->z->avail_in) {
-    if (png_encoder_require_zlib_output(ctx)<0) return -1;
-    int out0=ctx->z->total_out;
-    int err=deflate(ctx->z,Z_NO_FLUSH);
-    if (err<0) return -1;
-    int outadd=ctx->z->total_out-out0;
-    ctx->dst->c+=outadd;
+static uint8_t png_filter_row_fast(uint8_t *dst,const uint8_t *src,const uint8_t *prv,int c,int xstride,int pixelsize) {
+  if (pixelsize<8) {
+    memcpy(dst,src,c);
+    return 0;
+  }
+  if (!prv) {
+    png_filter_row_SUB(dst,src,0,c,xstride);
+    return 1;
+  }
+  png_filter_row_PAETH(dst,src,prv,c,xstride);
+  return 4;
+}
+
+/* Filter a range of rows into the encoder's filtered buffer.
+ * Rows only depend on the input, so these can run in parallel.
+ */
+ 
+struct png_filter_job {
+  struct png_encoder *ctx;
+  uint8_t *dst;
+  int y0,y1;
+  int heuristic; // 0=zeroes, 1=minsum, 2=fast
+};
+
+static void png_filter_job_run(void *arg) {
+  struct png_filter_job *job=arg;
+  struct png_encoder *ctx=job->ctx;
+  const uint8_t *srcrow=(uint8_t*)ctx->image->v+job->y0*ctx->image->stride;
+  const uint8_t *pvrow=job->y0?(srcrow-ctx->image->stride):0;
+  uint8_t *dst=job->dst+job->y0*ctx->rowbufc;
+  int y=job->y0;
+  for (;y<job->y1;y++,pvrow=srcrow,srcrow+=ctx->image->stride,dst+=ctx->rowbufc) {
+    switch (job->heuristic) {
+      case 0: dst[0]=png_filter_row(dst+1,srcrow,pvrow,ctx->stride,ctx->xstride); break;
+      case 1: dst[0]=png_filter_row_minsum(dst+1,srcrow,pvrow,ctx->stride,ctx->xstride); break;
+      case 2: dst[0]=png_filter_row_fast(dst+1,srcrow,pvrow,ctx->stride,ctx->xstride,ctx->image->pixelsize); break;
+    }
+  }
+}
+
+/* Deflate one run of filtered data into its own buffer.
+ * Either a complete zlib stream (wrap), or a raw deflate fragment for stitching.
+ * Fragments after the first are primed with the preceding 32 kB, so they lose very little to the split.
+ */
+ 
+struct png_deflate_job {
+  const uint8_t *src;
+  int srcc;
+  int dictc; // Bytes before (src) to use as preset dictionary. Raw only.
+  int level,memlevel,strategy;
+  int wrap;
+  int last; // Raw only: Finish the deflate stream, otherwise sync-flush.
+  struct sr_encoder dst;
+  uint32_t adler; // Raw only, of (src).
+  int err;
+};
+
+static void png_deflate_job_run(void *arg) {
+  struct png_deflate_job *job=arg;
+  job->err=-1;
+  z_stream z={
+    .zalloc=zalloc,
+    .zfree=zfree,
+  };
+  if (deflateInit2(&z,job->level,Z_DEFLATED,job->wrap?15:-15,job->memlevel,job->strategy)<0) return;
+  if (!job->wrap) {
+    job->adler=adler32(adler32(0,0,0),job->src,job->srcc);
+    if (job->dictc&&(deflateSetDictionary(&z,job->src-job->dictc,job->dictc)<0)) {
+      deflateEnd(&z);
+      return;
+    }
+  }
+  int flush=(job->wrap||job->last)?Z_FINISH:Z_SYNC_FLUSH;
+  z.next_in=(Bytef*)job->src;
+  z.avail_in=job->srcc;
+  for (;;) {
+    if (sr_encoder_require(&job->dst,8192)<0) break;
+    z.next_out=(Bytef*)job->dst.v+job->dst.c;
+    z.avail_out=job->dst.a-job->dst.c;
+    int err=deflate(&z,flush);
+    if ((err<0)&&(err!=Z_BUF_ERROR)) break;
+    job->dst.c=(char*)z.next_out-(char*)job->dst.v;
+    if (flush==Z_FINISH) {
+      if (err==Z_STREAM_END) { job->err=0; break; }
+    } else if (!z.avail_in&&z.avail_out) {
+      job->err=0;
+      break;
+    }
   }
+  deflateEnd(&z);
+}
+
+/* Compress (ctx->filtered[0]) in row groups, stitched into one zlib stream.
+ * Group boundaries depend only on the image, so output is the same regardless of thread count.
+ * A single group is a plain zlib stream, exactly what we'd produce without groups.
+ */
+ 
+static int png_encode_groups(struct png_encoder *ctx,int level) {
+  int rowspergroup=PNG_GROUP_SIZE/ctx->rowbufc;
+  if (rowspergroup<1) rowspergroup=1;
+  int groupc=(ctx->image->h+rowspergroup-1)/rowspergroup;
+  struct png_deflate_job *jobv=calloc(groupc,sizeof(struct png_deflate_job));
+  if (!jobv) return -1;
+  int i=0; for (;i<groupc;i++) {
+    struct png_deflate_job *job=jobv+i;
+    int y0=i*rowspergroup;
+    int y1=y0+rowspergroup;
+    if (y1>ctx->image->h) y1=ctx->image->h;
+    job->src=ctx->filtered[0]+y0*ctx->rowbufc;
+    job->srcc=(y1-y0)*ctx->rowbufc;
+    job->dictc=(y0*ctx->rowbufc<PNG_WINDOW_SIZE)?(y0*ctx->rowbufc):PNG_WINDOW_SIZE;
+    job->level=level;
+    job->memlevel=8;
+    job->strategy=Z_DEFAULT_STRATEGY;
+    job->wrap=(groupc==1);
+    job->last=(i==groupc-1);
+  }
+  png_run_jobs(png_deflate_job_run,jobv,sizeof(struct png_deflate_job),groupc);
+  int err=0;
+  if (groupc>1) {
+    // zlib header: Deflate with 32k window, no dictionary, and FLEVEL to match. FCHECK makes it a multiple of 31.
+    uint8_t flg=(level<=1)?0x01:(level>=7)?0xda:0x9c;
+    if ((sr_encode_u8(ctx->dst,0x78)<0)||(sr_encode_u8(ctx->dst,flg)<0)) err=-1;
+  }
+  uint32_t adler=adler32(0,0,0);
+  for (i=0;i<groupc;i++) {
+    struct png_deflate_job *job=jobv+i;
+    if (!err&&(job->err<0)) err=-1;
+    if (!err&&(sr_encode_raw(ctx->dst,job->dst.v,job->dst.c)<0)) err=-1;
+    adler=adler32_combine(adler,job->adler,job->srcc);
+    sr_encoder_cleanup(&job->dst);
+  }
+  free(jobv);
+  if (err<0) return -1;
+  if ((groupc>1)&&(sr_encode_intbe(ctx->dst,adler,4)<0)) return -1;
   return 0;
 }
 
-/* Flush zlib out.
+/* Max effort: Try both filter heuristics and two zlib strategies, keep the smallest.
+ * The four candidates compress in parallel, each as one unbroken stream.
  */
  
-static int png_encode_end_of_image(struct png_encoder *ctx) {
-  while (1) {
-    if (png_encoder_require_zlib_output(ctx)<0) return -1;
-    int out0=ctx->z->total_out;
-    int err=deflate(ctx->z,Z_FINISH);
-    if (err<0) return -1;
-    int outadd=ctx->z->total_out-out0;
-    ctx->dst->c+=outadd;
-    if (err=Z_STREAM_END) break;
+static int png_encode_best(struct png_encoder *ctx) {
+  struct png_deflate_job jobv[4]={0};
+  int i=0; for (;i<4;i++) {
+    jobv[i].src=ctx->filtered[i>>1];
+    jobv[i].srcc=ctx->rowbufc*ctx->image->h;
+    jobv[i].level=Z_BEST_COMPRESSION;
+    jobv[i].memlevel=9;
+    jobv[i].strategy=(i&1)?Z_FILTERED:Z_DEFAULT_STRATEGY;
+    jobv[i].wrap=1;
   }
+  png_run_jobs(png_deflate_job_run,jobv,sizeof(struct png_deflate_job),4);
+  struct png_deflate_job *best=0;
+  for (i=0;i<4;i++) {
+    if (jobv[i].err<0) continue;
+    if (!best||(jobv[i].dst.c<best->dst.c)) best=jobv+i;
+  }
+  int err=-1;
+  if (best) err=sr_encode_raw(ctx->dst,best->dst.v,best->dst.c);
+  for (i=0;i<4;i++) sr_encoder_cleanup(&jobv[i].dst);
+  return err;
+}
+
+/* Filter the whole image, with parallel row groups.
+ */
+ 
+static int png_encode_filter(struct png_encoder *ctx,int bufp,int heuristic) {
+  int len=ctx->rowbufc*ctx->image->h;
+  if (!(ctx->filtered[bufp]=malloc(len))) return -1;
+  int rowspergroup=PNG_GROUP_SIZE/ctx->rowbufc;
+  if (rowspergroup<1) rowspergroup=1;
+  int jobc=(ctx->image->h+rowspergroup-1)/rowspergroup;
+  struct png_filter_job *jobv=calloc(jobc,sizeof(struct png_filter_job));
+  if (!jobv) return -1;
+  int i=0; for (;i<jobc;i++) {
+    jobv[i].ctx=ctx;
+    jobv[i].dst=ctx->filtered[bufp];
+    jobv[i].y0=i*rowspergroup;
+    jobv[i].y1=jobv[i].y0+rowspergroup;
+    if (jobv[i].y1>ctx->image->h) jobv[i].y1=ctx->image->h;
+    jobv[i].heuristic=heuristic;
+  }
+  png_run_jobs(png_filter_job_run,jobv,sizeof(struct png_filter_job),jobc);
+  free(jobv);
   return 0;
 }
 
@@ -555,28 +931,26 @@ static int png_encode_IDAT(struct png_encoder *ctx) {
   if (sr_encode_raw(ctx->dst,"\0\0\0\0IDAT",8)<0) return -1;
   
   ctx->rowbufc=1+ctx->stride;
-  if (!(ctx->rowbuf=malloc(ctx->rowbufc))) return -1;
   ctx->xstride=(ctx->image->pixelsize+7)>>3;
+  if ((ctx->image->w<1)||(ctx->image->h<1)) return -1;
+  if (ctx->rowbufc>INT_MAX/ctx->image->h) return -1;
   
-  if (!(ctx->z=calloc(1,sizeof(z_stream)))) return -1;
-  ctx->z->zalloc=zalloc;
-  ctx->z->zfree=zfree;
-  if (deflateInit(ctx->z,Z_BEST_COMPRESSION)<0) {
-    free(ctx->z);
-    ctx->z=0;
-    return -1;
+  switch (png_encode_effort) {
+    case IMAGE_EFFORT_FAST: {
+        if (png_encode_filter(ctx,0,2)<0) return -1;
+        if (png_encode_groups(ctx,1)<0) return -1;
+      } break;
+    case IMAGE_EFFORT_MAX: {
+        if (png_encode_filter(ctx,0,0)<0) return -1;
+        if (png_encode_filter(ctx,1,1)<0) return -1;
+        if (png_encode_best(ctx)<0) return -1;
+      } break;
+    default: {
+        if (png_encode_filter(ctx,0,0)<0) return -1;
+        if (png_encode_groups(ctx,Z_BEST_COMPRESSION)<0) return -1;
+      }
   }
   
-  const uint8_t *pvrow=0;
-  const uint8_t *srcrow=ctx->image->v;
-  int y=0;
-  for (;y<ctx->image->h;y++,srcrow+=ctx->image->stride) {
-    ctx->rowbuf[0]=png_filter_row(ctx->rowbuf+1,srcrow,pvrow,ctx->stride,ctx->xstride);
-    if (png_encode_row(ctx)<0) return -1;
-    pvrow=srcrow;
-  }
-  if (png_encode_end_of_image(ctx)<0) return -1;
-  
   int len=ctx->dst->c-lenp-8;
   int crc=crc32(crc32(0,0,0),((Bytef*)ctx->dst->v)+lenp+4,ctx->dst->c-lenp-4);
   if (sr_encode_intbe(ctx->dst,crc,4)<0) return -1;
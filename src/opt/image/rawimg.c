@@ -0,0 +1,254 @@
+/* rawimg.c
+ * Our own pre-decoded image format, for ROMs that would rather spend bytes than load time.
+ * Two format names share one container: "rawimg" stores pixels verbatim, and "lzimg" compresses them LZ4-style.
+ *
+ * Header, 12 bytes:
+ *   0000   4 Signature: "\0EI\xff"
+ *   0004   2 Width, big-endian.
+ *   0006   2 Height, big-endian.
+ *   0008   1 Pixelsize: 1, 8, or 32. (A1, A8 or Y8, RGBA). Same meaning as struct image.
+ *   0009   1 Compression: 0=none (rawimg), 1=LZ (lzimg)
+ *   000a   2 Reserved, zero.
+ *   000c ... Pixels, minimum stride.
+ *
+ * LZ payload is a sequence of LZ4 block-format sequences, decompressing to exactly (stride*h) bytes:
+ *   u8 token: (literal count<<4)|(match length-4). 15 in either field means more bytes follow, each added, until one is not 0xff.
+ *   ... literals
+ *   u16 offset, little-endian. Omitted for the final sequence, which is literals only.
+ */
+
+#if defined(IMAGE_USE_RAWIMG) && !IMAGE_USE_RAWIMG
+  int rawimg_dummy=0;
+#else
+
+#include "image.h"
+#include "opt/serial/serial.h"
+#include "opt/stdlib/egg-stdlib.h"
+
+#ifndef IMAGE_ENABLE_ENCODERS
+  #define IMAGE_ENABLE_ENCODERS 1
+#endif
+
+#define RAWIMG_HEADER_SIZE 12
+#define RAWIMG_COMPRESSION_NONE 0
+#define RAWIMG_COMPRESSION_LZ 1
+
+/* Decode header.
+ * Returns the compression, and populates (dst) with everything but (v).
+ */
+
+static int rawimg_decode_header_inner(struct image *dst,const uint8_t *src,int srcc) {
+  if ((srcc<RAWIMG_HEADER_SIZE)||memcmp(src,"\0EI\xff",4)) return -1;
+  int w=(src[4]<<8)|src[5];
+  int h=(src[6]<<8)|src[7];
+  int pixelsize=src[8];
+  int compression=src[9];
+  if ((w<1)||(w>0x7fff)||(h<1)||(h>0x7fff)) return -1;
+  switch (pixelsize) {
+    case 1: case 8: case 32: break;
+    default: return -1;
+  }
+  switch (compression) {
+    case RAWIMG_COMPRESSION_NONE: case RAWIMG_COMPRESSION_LZ: break;
+    default: return -1;
+  }
+  int stride=(w*pixelsize+7)>>3;
+  if (stride>INT_MAX/h) return -1;
+  dst->w=w;
+  dst->h=h;
+  dst->stride=stride;
+  dst->pixelsize=pixelsize;
+  return compression;
+}
+
+int rawimg_decode_header(struct image *dst,const void *src,int srcc) {
+  if (rawimg_decode_header_inner(dst,src,srcc)<0) return -1;
+  return dst->stride*dst->h;
+}
+
+int lzimg_decode_header(struct image *dst,const void *src,int srcc) {
+  return rawimg_decode_header(dst,src,srcc);
+}
+
+/* Decompress LZ payload.
+ * Output must fill (dst) exactly.
+ */
+
+static int rawimg_lz_decompress(uint8_t *dst,int dstc,const uint8_t *src,int srcc) {
+  int dstp=0,srcp=0;
+  while (srcp<srcc) {
+    uint8_t token=src[srcp++];
+    int litc=token>>4;
+    if (litc==15) {
+      uint8_t more;
+      do {
+        if (srcp>=srcc) return -1;
+        litc+=(more=src[srcp++]);
+      } while (more==0xff);
+    }
+    if ((srcp>srcc-litc)||(dstp>dstc-litc)) return -1;
+    memcpy(dst+dstp,src+srcp,litc);
+    srcp+=litc;
+    dstp+=litc;
+    if (srcp>=srcc) break;
+    if (srcp>srcc-2) return -1;
+    int offset=src[srcp]|(src[srcp+1]<<8);
+    srcp+=2;
+    if ((offset<1)||(offset>dstp)) return -1;
+    int matchc=token&15;
+    if (matchc==15) {
+      uint8_t more;
+      do {
+        if (srcp>=srcc) return -1;
+        matchc+=(more=src[srcp++]);
+      } while (more==0xff);
+    }
+    matchc+=4;
+    if (dstp>dstc-matchc) return -1;
+    if (offset>=matchc) {
+      memcpy(dst+dstp,dst+dstp-offset,matchc);
+      dstp+=matchc;
+    } else {
+      // Overlapping match, eg a run of one repeated pixel. Must go byte by byte.
+      const uint8_t *from=dst+dstp-offset;
+      uint8_t *to=dst+dstp;
+      dstp+=matchc;
+      while (matchc-->0) *(to++)=*(from++);
+    }
+  }
+  if (dstp!=dstc) return -1;
+  return 0;
+}
+
+/* Decode.
+ */
+
+struct image *rawimg_decode(const void *_src,int srcc) {
+  const uint8_t *src=_src;
+  struct image header={0};
+  int compression=rawimg_decode_header_inner(&header,src,srcc);
+  if (compression<0) return 0;
+  int len=header.stride*header.h;
+  if ((compression==RAWIMG_COMPRESSION_NONE)&&(srcc-RAWIMG_HEADER_SIZE<len)) return 0;
+  struct image *image=image_new_alloc(header.pixelsize,header.w,header.h);
+  if (!image) return 0;
+  if (compression==RAWIMG_COMPRESSION_NONE) {
+    memcpy(image->v,src+RAWIMG_HEADER_SIZE,len);
+  } else if (rawimg_lz_decompress(image->v,len,src+RAWIMG_HEADER_SIZE,srcc-RAWIMG_HEADER_SIZE)<0) {
+    image_del(image);
+    return 0;
+  }
+  return image;
+}
+
+struct image *lzimg_decode(const void *src,int srcc) {
+  return rawimg_decode(src,srcc);
+}
+
+/* Point into uncompressed serial data.
+ */
+
+int rawimg_decode_weak(struct image *dst,const void *src,int srcc) {
+  if (rawimg_decode_header_inner(dst,src,srcc)!=RAWIMG_COMPRESSION_NONE) return -1;
+  int len=dst->stride*dst->h;
+  if (srcc-RAWIMG_HEADER_SIZE<len) return -1;
+  dst->v=(uint8_t*)src+RAWIMG_HEADER_SIZE;
+  return len;
+}
+
+#if IMAGE_ENABLE_ENCODERS
+
+/* Compress LZ payload.
+ * Greedy, with a single-entry hash table of 4-byte sequences. Fast and good enough for pixels.
+ */
+
+#define RAWIMG_HASH_BITS 14
+#define RAWIMG_MIN_MATCH 4
+#define RAWIMG_MAX_OFFSET 0xffff
+
+static inline uint32_t rawimg_hash(const uint8_t *v) {
+  uint32_t seq=v[0]|(v[1]<<8)|(v[2]<<16)|(v[3]<<24);
+  return (seq*2654435761u)>>(32-RAWIMG_HASH_BITS);
+}
+
+static int rawimg_lz_encode_length(struct sr_encoder *dst,int n) {
+  for (;n>=0xff;n-=0xff) {
+    if (sr_encode_u8(dst,0xff)<0) return -1;
+  }
+  return sr_encode_u8(dst,n);
+}
+
+static int rawimg_lz_encode_sequence(struct sr_encoder *dst,const uint8_t *lit,int litc,int offset,int matchc) {
+  int matchx=matchc?(matchc-RAWIMG_MIN_MATCH):0;
+  uint8_t token=((litc<15)?litc:15)<<4;
+  token|=(matchx<15)?matchx:15;
+  if (sr_encode_u8(dst,token)<0) return -1;
+  if ((litc>=15)&&(rawimg_lz_encode_length(dst,litc-15)<0)) return -1;
+  if (sr_encode_raw(dst,lit,litc)<0) return -1;
+  if (!matchc) return 0;
+  if (sr_encode_u8(dst,offset)<0) return -1;
+  if (sr_encode_u8(dst,offset>>8)<0) return -1;
+  if ((matchx>=15)&&(rawimg_lz_encode_length(dst,matchx-15)<0)) return -1;
+  return 0;
+}
+
+static int rawimg_lz_compress(struct sr_encoder *dst,const uint8_t *src,int srcc) {
+  int *table=malloc(sizeof(int)<<RAWIMG_HASH_BITS);
+  if (!table) return -1;
+  int i=1<<RAWIMG_HASH_BITS; while (i-->0) table[i]=-1;
+  int srcp=0,litp=0;
+  while (srcp<=srcc-RAWIMG_MIN_MATCH) {
+    uint32_t hash=rawimg_hash(src+srcp);
+    int candidate=table[hash];
+    table[hash]=srcp;
+    if ((candidate<0)||(srcp-candidate>RAWIMG_MAX_OFFSET)||memcmp(src+candidate,src+srcp,RAWIMG_MIN_MATCH)) {
+      srcp++;
+      continue;
+    }
+    int matchc=RAWIMG_MIN_MATCH;
+    while ((srcp+matchc<srcc)&&(src[candidate+matchc]==src[srcp+matchc])) matchc++;
+    if (rawimg_lz_encode_sequence(dst,src+litp,srcp-litp,srcp-candidate,matchc)<0) {
+      free(table);
+      return -1;
+    }
+    srcp+=matchc;
+    litp=srcp;
+  }
+  free(table);
+  return rawimg_lz_encode_sequence(dst,src+litp,srcc-litp,0,0);
+}
+
+/* Encode.
+ */
+
+static int rawimg_encode_inner(struct sr_encoder *dst,struct image *image,int compression) {
+  if (!dst||!image) return -1;
+  switch (image->pixelsize) {
+    case 1: case 8: case 32: break;
+    default: if (image_force_rgba(image)<0) return -1;
+  }
+  int stride=(image->w*image->pixelsize+7)>>3;
+  if (image->stride!=stride) {
+    if (image_reformat_in_place(image,0,0,0,0,0)<0) return -1;
+  }
+  if (sr_encode_raw(dst,"\0EI\xff",4)<0) return -1;
+  if (sr_encode_intbe(dst,image->w,2)<0) return -1;
+  if (sr_encode_intbe(dst,image->h,2)<0) return -1;
+  if (sr_encode_u8(dst,image->pixelsize)<0) return -1;
+  if (sr_encode_u8(dst,compression)<0) return -1;
+  if (sr_encode_raw(dst,"\0\0",2)<0) return -1;
+  int len=stride*image->h;
+  if (compression==RAWIMG_COMPRESSION_LZ) return rawimg_lz_compress(dst,image->v,len);
+  return sr_encode_raw(dst,image->v,len);
+}
+
+int rawimg_encode(struct sr_encoder *dst,struct image *image) {
+  return rawimg_encode_inner(dst,image,RAWIMG_COMPRESSION_NONE);
+}
+
+int lzimg_encode(struct sr_encoder *dst,struct image *image) {
+  return rawimg_encode_inner(dst,image,RAWIMG_COMPRESSION_LZ);
+}
+
+#endif
+#endif
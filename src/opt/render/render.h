@@ -1,5 +1,6 @@
 /* render.h
  * Egg's default renderer, using GLES2.
+ * Or with render_new_soft(), the same thing on the CPU, for headless hosts.
  */
  
 #ifndef RENDER_H
@@ -23,6 +24,13 @@ struct egg_draw_mode7;
 void render_del(struct render *render);
 struct render *render_new();
 
+/* Software renderer: Same API, no GL context required.
+ * Output of render_draw_to_main() goes to a buffer, read it with render_get_main(): RGBA, top row first, stride (w*4).
+ * render_get_main() returns null for GL renderers, or before the first frame.
+ */
+struct render *render_new_soft();
+const void *render_get_main(int *w,int *h,const struct render *render);
+
 void render_texture_del(struct render *render,int texid);
 int render_texture_new(struct render *render);
 
@@ -38,6 +46,11 @@ int render_texture_require(struct render *render,int texid);
  */
 int render_texture_load(struct render *render,int texid,int w,int h,int stride,int fmt,const void *src,int srcc);
 
+/* Overwrite a region of an RGBA texture with RGBA pixels, without blending.
+ * Texture must already have its size, and (x,y,w,h) must be entirely inside it.
+ */
+int render_texture_load_sub(struct render *render,int texid,int x,int y,int w,int h,int stride,const void *src,int srcc);
+
 // Caller should do this after loading, so we can restore from resources on save state.
 // Resets to (0,0) on render_texture_load().
 void render_texture_set_origin(struct render *render,int texid,int qual,int rid);
@@ -61,6 +74,23 @@ void render_draw_mode7(struct render *render,int dsttexid,int srctexid,const str
 
 void render_draw_to_main(struct render *render,int mainw,int mainh,int texid);
 
+/* Lines, trigs, and rects are deferred, and consecutive ones with the same output and globals go out in one draw call.
+ * Everything else that touches GL flushes them first, including render_draw_to_main.
+ * You only need this if you want them drawn without doing anything else after.
+ */
+void render_flush(struct render *render);
+
+/* Counts of GL calls, for diagnostics.
+ * (frame) is the last one completed by render_draw_to_main, and (total) since construction. Either may be null.
+ * "draws" are glDrawArrays and glClear. "states" are bindings, program switches, viewport, uniforms, and so on.
+ */
+struct render_stats {
+  int framec;
+  int drawc;
+  int statec;
+};
+void render_get_stats(struct render_stats *frame,struct render_stats *total,const struct render *render);
+
 /* We take pains to ensure that OOB coords coming in are also OOB going out.
  */
 void render_coords_fb_from_screen(struct render *render,int *x,int *y);
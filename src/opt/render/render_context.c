@@ -3,19 +3,35 @@
 /* Delete.
  */
  
-static void render_texture_cleanup(struct render_texture *texture) {
-  if (texture->texid) glDeleteTextures(1,&texture->texid);
-  if (texture->fbid) glDeleteFramebuffers(1,&texture->fbid);
+static void render_texture_cleanup(struct render *render,struct render_texture *texture) {
+  if (render->soft) {
+    if (texture->softv) free(texture->softv);
+    texture->softv=0;
+    return;
+  }
+  // Deleting a bound object reverts that binding to zero, but let's not count on it.
+  if (texture->texid) {
+    glDeleteTextures(1,&texture->texid);
+    render->cur_texid=-1;
+  }
+  if (texture->fbid) {
+    glDeleteFramebuffers(1,&texture->fbid);
+    render->cur_fbid=-1;
+  }
 }
  
 void render_del(struct render *render) {
   if (!render) return;
   if (render->texturev) {
-    while (render->texturec-->0) render_texture_cleanup(render->texturev+render->texturec);
+    while (render->texturec-->0) render_texture_cleanup(render,render->texturev+render->texturec);
     free(render->texturev);
   }
   if (render->textmp) free(render->textmp);
   if (render->rvtxv) free(render->rvtxv);
+  if (render->dvtxv) free(render->dvtxv);
+  if (render->vbo) glDeleteBuffers(1,&render->vbo);
+  if (render->softrow) free(render->softrow);
+  if (render->mainv) free(render->mainv);
   free(render);
 }
 
@@ -27,6 +43,12 @@ struct render *render_new() {
   if (!render) return 0;
   
   render->alpha=0xff;
+  render->cur_fbid=-1;
+  render->cur_vieww=-1;
+  render->cur_viewh=-1;
+  render->cur_pgm=-1;
+  render->cur_texid=-1;
+  render->texlimit[0]=render->texlimit[1]=render->texlimit[2]=render->texlimit[3]=-1.0f;
   
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
@@ -47,10 +69,11 @@ struct render *render_new() {
  */
  
 void render_drop_textures(struct render *render) {
+  render_flush(render);
   while (render->texturec>1) {
     render->texturec--;
     struct render_texture *texture=render->texturev+render->texturec;
-    render_texture_cleanup(texture);
+    render_texture_cleanup(render,texture);
   }
 }
 
@@ -68,9 +91,10 @@ int render_texid_by_index(const struct render *render,int p) {
 
 void render_texture_del(struct render *render,int texid) {
   if ((texid<2)||(texid>render->texturec)) return; // sic "<2", no deleting the main
+  render_flush(render);
   texid--;
   struct render_texture *texture=render->texturev+texid;
-  render_texture_cleanup(texture);
+  render_texture_cleanup(render,texture);
   memset(texture,0,sizeof(struct render_texture));
 }
 
@@ -112,6 +136,11 @@ int render_texture_new(struct render *render) {
   }
   memset(texture,0,sizeof(struct render_texture));
   
+  if (render->soft) {
+    texture->texid=1;
+    return (texture-render->texturev)+1;
+  }
+  
   glGenTextures(1,&texture->texid);
   if (!texture->texid) {
     glGenTextures(1,&texture->texid);
@@ -120,7 +149,7 @@ int render_texture_new(struct render *render) {
     }
   }
   
-  glBindTexture(GL_TEXTURE_2D,texture->texid);
+  render_bind_texture(render,texture->texid);
   glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
@@ -219,13 +248,17 @@ static int render_texture_upload(struct render *render,struct render_texture *te
     default: return -1;
   }
   if (stride!=w*chanc) return -1;
-  if (!v) {
-    texture->edge_extra=32;
+  if (render->soft) {
+    if (render_soft_store(texture,w,h,fmt,v)<0) return -1;
   } else {
-    texture->edge_extra=0;
+    if (!v) {
+      texture->edge_extra=32;
+    } else {
+      texture->edge_extra=0;
+    }
+    render_bind_texture(render,texture->texid);
+    glTexImage2D(GL_TEXTURE_2D,0,ifmt,w+texture->edge_extra*2,h+texture->edge_extra*2,0,glfmt,type,v);
   }
-  glBindTexture(GL_TEXTURE_2D,texture->texid);
-  glTexImage2D(GL_TEXTURE_2D,0,ifmt,w+texture->edge_extra*2,h+texture->edge_extra*2,0,glfmt,type,v);
   texture->w=w;
   texture->h=h;
   texture->fmt=fmt;
@@ -254,6 +287,7 @@ int render_texture_load(struct render *render,int texid,int w,int h,int stride,i
   if (!srcc) src=0;
   if ((texid<1)||(texid>render->texturec)) return -1;
   struct render_texture *texture=render->texturev+texid-1;
+  render_flush(render);
   
   /* If format is completely unspecified, (src) may be an encoded image.
    * Not permitted for texid 1.
@@ -305,6 +339,41 @@ int render_texture_load(struct render *render,int texid,int w,int h,int stride,i
   return 0;
 }
 
+/* Load part of a texture.
+ */
+ 
+int render_texture_load_sub(struct render *render,int texid,int x,int y,int w,int h,int stride,const void *src,int srcc) {
+  if ((texid<1)||(texid>render->texturec)) return -1;
+  struct render_texture *texture=render->texturev+texid-1;
+  if (texture->fmt!=EGG_TEX_FMT_RGBA) return -1;
+  if ((w<1)||(h<1)||(x<0)||(y<0)||(x>texture->w-w)||(y>texture->h-h)) return -1;
+  int minstride=w<<2;
+  if (stride<1) stride=minstride;
+  if ((stride<minstride)||!src||(srcc<stride*(h-1)+minstride)) return -1;
+  render_flush(render);
+  if (render->soft) {
+    if (!texture->softv) return -1;
+    int dststride=texture->w<<2;
+    uint8_t *dstrow=texture->softv+y*dststride+(x<<2);
+    const uint8_t *srcrow=src;
+    int yi=h; for (;yi-->0;dstrow+=dststride,srcrow+=stride) memcpy(dstrow,srcrow,minstride);
+  } else {
+    render_bind_texture(render,texture->texid);
+    if (stride==minstride) {
+      glTexSubImage2D(GL_TEXTURE_2D,0,x+texture->edge_extra,y+texture->edge_extra,w,h,GL_RGBA,GL_UNSIGNED_BYTE,src);
+    } else {
+      // GLES2 has no GL_UNPACK_ROW_LENGTH, so go a row at a time.
+      const uint8_t *srcrow=src;
+      int yi=0; for (;yi<h;yi++,srcrow+=stride) {
+        glTexSubImage2D(GL_TEXTURE_2D,0,x+texture->edge_extra,y+texture->edge_extra+yi,w,1,GL_RGBA,GL_UNSIGNED_BYTE,srcrow);
+      }
+    }
+  }
+  texture->qual=0;
+  texture->rid=0;
+  return 0;
+}
+
 /* Texture origin (commentary we stash on the client's behalf).
  */
  
@@ -340,7 +409,8 @@ int render_texture_get_pixels(void *dst,int dsta,struct render *render,int texid
   if (!dst||(dsta<0)) dsta=0;
   if ((texid<1)||(texid>render->texturec)) return 0;
   struct render_texture *texture=render->texturev+texid-1;
-  if (render_texture_require_fb(texture)<0) return 0;
+  render_flush(render);
+  if (!render->soft&&(render_texture_require_fb(render,texture)<0)) return 0;
   int stride=render_minimum_stride(texture->w,texture->fmt);
   int len=render_texture_measure(texture->w,texture->h,stride,texture->fmt);
   if (len<1) return 0;
@@ -352,8 +422,12 @@ int render_texture_get_pixels(void *dst,int dsta,struct render *render,int texid
     case EGG_TEX_FMT_A1: break;
     default: free(dst); return 0;
   }
+  if (render->soft) {
+    if (render_soft_read(dst,texture)<0) return 0;
+    return len;
+  }
   glFlush();
-  glBindFramebuffer(GL_FRAMEBUFFER,texture->fbid);
+  render_bind_fb(render,texture->fbid,texture->edge_extra*2+texture->w,texture->edge_extra*2+texture->h);
   glReadPixels(texture->edge_extra,texture->edge_extra,texture->w,texture->h,glfmt,gltype,dst);
   return len;
 }
@@ -361,7 +435,7 @@ int render_texture_get_pixels(void *dst,int dsta,struct render *render,int texid
 /* Allocate framebuffer if needed.
  */
  
-int render_texture_require_fb(struct render_texture *texture) {
+int render_texture_require_fb(struct render *render,struct render_texture *texture) {
   if (texture->fbid) return 0;
   glGenFramebuffers(1,&texture->fbid);
   if (!texture->fbid) {
@@ -371,9 +445,119 @@ int render_texture_require_fb(struct render_texture *texture) {
   glBindFramebuffer(GL_FRAMEBUFFER,texture->fbid);
   glFramebufferTexture2D(GL_FRAMEBUFFER,GL_COLOR_ATTACHMENT0,GL_TEXTURE_2D,texture->texid,0);
   glBindFramebuffer(GL_FRAMEBUFFER,0);
+  render->cur_fbid=0;
   return 0;
 }
 
+/* GL state.
+ */
+ 
+void render_bind_fb(struct render *render,int fbid,int w,int h) {
+  if (fbid!=render->cur_fbid) {
+    glBindFramebuffer(GL_FRAMEBUFFER,fbid);
+    render->cur_fbid=fbid;
+    render->frame.statec++;
+  }
+  if ((w!=render->cur_vieww)||(h!=render->cur_viewh)) {
+    glViewport(0,0,w,h);
+    render->cur_vieww=w;
+    render->cur_viewh=h;
+    render->frame.statec++;
+  }
+}
+
+void render_use_program(struct render *render,int pgm) {
+  if (pgm==render->cur_pgm) return;
+  glUseProgram(pgm);
+  render->cur_pgm=pgm;
+  render->frame.statec++;
+}
+
+void render_bind_texture(struct render *render,int texid) {
+  if (texid==render->cur_texid) return;
+  glBindTexture(GL_TEXTURE_2D,texid);
+  render->cur_texid=texid;
+  render->frame.statec++;
+}
+
+void render_attribs(struct render *render,int c) {
+  while (render->cur_attrc<c) {
+    glEnableVertexAttribArray(render->cur_attrc);
+    render->cur_attrc++;
+    render->frame.statec++;
+  }
+  while (render->cur_attrc>c) {
+    render->cur_attrc--;
+    glDisableVertexAttribArray(render->cur_attrc);
+    render->frame.statec++;
+  }
+}
+
+/* Streaming vertex buffer.
+ */
+ 
+int render_vbo_put(struct render *render,const void *src,int len) {
+  if (len<1) return -1;
+  if (!render->vbo) {
+    glGenBuffers(1,&render->vbo);
+    if (!render->vbo) return -1;
+  }
+  if (!render->cur_vbo) {
+    glBindBuffer(GL_ARRAY_BUFFER,render->vbo);
+    render->cur_vbo=1;
+    render->frame.statec++;
+  }
+  if (len>render->vboa) {
+    int na=render->vboa?render->vboa:RENDER_VBO_SIZE;
+    while (na<len) {
+      if (na>INT_MAX>>1) return -1;
+      na<<=1;
+    }
+    glBufferData(GL_ARRAY_BUFFER,na,0,GL_STREAM_DRAW);
+    render->vboa=na;
+    render->vbop=0;
+    render->frame.statec++;
+  } else if (len>render->vboa-render->vbop) {
+    // Orphan: The driver gives us fresh storage, and keeps the old one alive for draws still in flight.
+    glBufferData(GL_ARRAY_BUFFER,render->vboa,0,GL_STREAM_DRAW);
+    render->vbop=0;
+    render->frame.statec++;
+  }
+  int offset=render->vbop;
+  glBufferSubData(GL_ARRAY_BUFFER,offset,len,src);
+  render->vbop+=(len+3)&~3;
+  render->frame.statec++;
+  return offset;
+}
+
+/* End of frame: Roll stats and forget bindings.
+ * Attribute arrays and our vertex buffer we know for sure, so turn them off.
+ */
+ 
+void render_end_frame(struct render *render) {
+  render_attribs(render,0);
+  if (render->cur_vbo) {
+    glBindBuffer(GL_ARRAY_BUFFER,0);
+    render->cur_vbo=0;
+  }
+  render->cur_fbid=-1;
+  render->cur_vieww=-1;
+  render->cur_viewh=-1;
+  render->cur_pgm=-1;
+  render->cur_texid=-1;
+  render->frame.framec=1;
+  render->last=render->frame;
+  render->total.framec++;
+  render->total.drawc+=render->frame.drawc;
+  render->total.statec+=render->frame.statec;
+  memset(&render->frame,0,sizeof(struct render_stats));
+}
+
+void render_get_stats(struct render_stats *frame,struct render_stats *total,const struct render *render) {
+  if (frame) *frame=render->last;
+  if (total) *total=render->total;
+}
+
 /* Transform coords.
  */
  
@@ -270,6 +270,13 @@ int render_init_programs(struct render *render) {
   render->u_tile_srcedge=glGetUniformLocation(render->pgm_tile,"srcedge");
   render->u_tile_texsize=glGetUniformLocation(render->pgm_tile,"texsize");
   
+  // Samplers never change: Everything draws from unit zero.
+  glActiveTexture(GL_TEXTURE0);
+  glUniform1i(render->u_tile_sampler,0);
+  glUseProgram(render->pgm_decal);
+  glUniform1i(render->u_decal_sampler,0);
+  render->cur_pgm=-1;
+  
   return 0;
 }
 
@@ -278,94 +285,168 @@ int render_init_programs(struct render *render) {
 
 void render_texture_clear(struct render *render,int texid) {
   if ((texid<1)||(texid>render->texturec)) return;
+  render_flush(render);
   struct render_texture *texture=render->texturev+texid-1;
-  if (render_texture_require_fb(texture)<0) return;
-  glBindFramebuffer(GL_FRAMEBUFFER,texture->fbid);
+  if (render->soft) {
+    render_soft_clear(texture);
+    return;
+  }
+  if (render_texture_require_fb(render,texture)<0) return;
+  render_bind_fb(render,texture->fbid,texture->edge_extra*2+texture->w,texture->edge_extra*2+texture->h);
   glClearColor(0.0f,0.0f,0.0f,0.0f);
   glClear(GL_COLOR_BUFFER_BIT);
+  render->frame.statec++;
+  render->frame.drawc++;
 }
 
 /* Set globals.
+ * Deferred draws were queued with the old values, so they must go out first.
  */
 
 void render_tint(struct render *render,uint32_t rgba) {
+  if (rgba==render->tint) return;
+  render_flush(render);
   render->tint=rgba;
 }
 
 void render_alpha(struct render *render,uint8_t a) {
+  if (a==render->alpha) return;
+  render_flush(render);
   render->alpha=a;
 }
 
-/* Flat rect.
+/* Upload uniforms for one program, only the ones that changed.
  */
-
-void render_draw_rect(struct render *render,int dsttexid,const struct egg_draw_rect *v,int c) {
-  if ((dsttexid<1)||(dsttexid>render->texturec)) return;
-  struct render_texture *dsttex=render->texturev+dsttexid-1;
-  if (render_texture_require_fb(dsttex)<0) return;
-  glBindFramebuffer(GL_FRAMEBUFFER,dsttex->fbid);
-  glUseProgram(render->pgm_raw);
-  glViewport(0,0,dsttex->edge_extra*2+dsttex->w,dsttex->edge_extra*2+dsttex->h);
-  glUniform2f(render->u_raw_screensize,dsttex->w,dsttex->h);
-  glUniform4f(render->u_raw_tint,(render->tint>>24)/255.0f,((render->tint>>16)&0xff)/255.0f,((render->tint>>8)&0xff)/255.0f,(render->tint&0xff)/255.0f);
-  glUniform1f(render->u_raw_alpha,render->alpha/255.0f);
-  glUniform1f(render->u_raw_dstedge,dsttex->edge_extra);
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  for (;c-->0;v++) {
-    struct render_vertex_raw vtxv[]={
-      {v->x     ,v->y     ,v->r,v->g,v->b,v->a},
-      {v->x,     v->y+v->h,v->r,v->g,v->b,v->a},
-      {v->x+v->w,v->y     ,v->r,v->g,v->b,v->a},
-      {v->x+v->w,v->y+v->h,v->r,v->g,v->b,v->a},
-    };
-    glVertexAttribPointer(0,2,GL_SHORT,0,sizeof(struct render_vertex_raw),&vtxv[0].x);
-    glVertexAttribPointer(1,4,GL_UNSIGNED_BYTE,1,sizeof(struct render_vertex_raw),&vtxv[0].r);
-    glDrawArrays(GL_TRIANGLE_STRIP,0,4);
+ 
+static void render_uniforms_dst(
+  struct render *render,struct render_uniforms *u,
+  GLuint u_screensize,GLuint u_dstedge,GLuint u_tint,GLuint u_alpha,
+  int w,int h,int edge,uint32_t tint,uint8_t alpha
+) {
+  if (!u->valid||(w!=u->dstw)||(h!=u->dsth)) {
+    glUniform2f(u_screensize,w,h);
+    u->dstw=w;
+    u->dsth=h;
+    render->frame.statec++;
+  }
+  if (!u->valid||(edge!=u->dstedge)) {
+    glUniform1f(u_dstedge,edge);
+    u->dstedge=edge;
+    render->frame.statec++;
+  }
+  if (!u->valid||(tint!=u->tint)) {
+    glUniform4f(u_tint,(tint>>24)/255.0f,((tint>>16)&0xff)/255.0f,((tint>>8)&0xff)/255.0f,(tint&0xff)/255.0f);
+    u->tint=tint;
+    render->frame.statec++;
   }
-  glDisableVertexAttribArray(0);
-  glDisableVertexAttribArray(1);
+  if (!u->valid||(alpha!=u->alpha)) {
+    glUniform1f(u_alpha,alpha/255.0f);
+    u->alpha=alpha;
+    render->frame.statec++;
+  }
+  u->valid=1;
+}
+
+static void render_uniforms_src(
+  struct render *render,struct render_uniforms *u,
+  GLuint u_srcedge,GLuint u_texsize,
+  const struct render_texture *texture
+) {
+  if (u->srcvalid&&(texture->w==u->srcw)&&(texture->h==u->srch)&&(texture->edge_extra==u->srcedge)) return;
+  glUniform1f(u_srcedge,texture->edge_extra);
+  glUniform2f(u_texsize,texture->w+texture->edge_extra*2.0,texture->h+texture->edge_extra*2.0);
+  u->srcw=texture->w;
+  u->srch=texture->h;
+  u->srcedge=texture->edge_extra;
+  u->srcvalid=1;
+  render->frame.statec+=2;
+}
+
+static void render_uniform_texlimit(struct render *render,GLfloat x0,GLfloat y0,GLfloat x1,GLfloat y1) {
+  GLfloat *v=render->texlimit;
+  if ((v[0]==x0)&&(v[1]==y0)&&(v[2]==x1)&&(v[3]==y1)) return;
+  glUniform4f(render->u_decal_texlimit,x0,y0,x1,y1);
+  v[0]=x0;
+  v[1]=y0;
+  v[2]=x1;
+  v[3]=y1;
+  render->frame.statec++;
+}
+
+/* Prepare to draw into a texture.
+ * Binds its framebuffer and sets the viewport.
+ */
+ 
+static int render_bind_dst(struct render *render,struct render_texture *texture) {
+  if (render_texture_require_fb(render,texture)<0) return -1;
+  render_bind_fb(render,texture->fbid,texture->edge_extra*2+texture->w,texture->edge_extra*2+texture->h);
+  return 0;
 }
 
-/* Line strip and triangle strip.
+/* Raw vertices: Lines, trigs, and rects.
+ * These all use the same program and have no per-draw uniforms, so we defer them.
+ * Vertices accumulate at the front of (rvtxv) for as long as they share an output texture and primitive mode.
+ * Anything else that touches GL must render_flush() first, and so must changes to tint or alpha.
  */
  
 static int render_rvtxv_require(struct render *render,int rvtxc) {
   if (rvtxc<=render->rvtxa) return 0;
   if (rvtxc>INT_MAX/sizeof(struct render_vertex_raw)) return -1;
-  void *nv=realloc(render->rvtxv,sizeof(struct render_vertex_raw)*rvtxc);
+  int na=render->rvtxa?render->rvtxa:256;
+  while (na<rvtxc) {
+    if (na>INT_MAX>>1) { na=rvtxc; break; }
+    na<<=1;
+  }
+  if (na>INT_MAX/sizeof(struct render_vertex_raw)) na=rvtxc;
+  void *nv=realloc(render->rvtxv,sizeof(struct render_vertex_raw)*na);
   if (!nv) return -1;
   render->rvtxv=nv;
-  render->rvtxa=rvtxc;
+  render->rvtxa=na;
   return 0;
 }
- 
-static void render_draw_raw(struct render *render,int texid,int mode,const struct render_vertex_raw *v,int c) {
-  if (c<1) return;
-  if ((texid<1)||(texid>render->texturec)) return;
-  struct render_texture *texture=render->texturev+texid-1;
-  if (render_texture_require_fb(texture)<0) return;
-  glBindFramebuffer(GL_FRAMEBUFFER,texture->fbid);
-  glUseProgram(render->pgm_raw);
-  glViewport(0,0,texture->edge_extra*2+texture->w,texture->edge_extra*2+texture->h);
-  glUniform2f(render->u_raw_screensize,texture->w,texture->h);
-  glUniform4f(render->u_raw_tint,(render->tint>>24)/255.0f,((render->tint>>16)&0xff)/255.0f,((render->tint>>8)&0xff)/255.0f,(render->tint&0xff)/255.0f);
-  glUniform1f(render->u_raw_alpha,render->alpha/255.0f);
-  glUniform1f(render->u_raw_dstedge,texture->edge_extra);
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(0,2,GL_SHORT,0,sizeof(struct render_vertex_raw),&v[0].x);
-  glVertexAttribPointer(1,4,GL_UNSIGNED_BYTE,1,sizeof(struct render_vertex_raw),&v[0].r);
-  glDrawArrays(mode,0,c);
-  glDisableVertexAttribArray(0);
-  glDisableVertexAttribArray(1);
+
+static struct render_vertex_raw *render_raw_begin(struct render *render,int texid,int mode,int c) {
+  if ((texid<1)||(texid>render->texturec)) return 0;
+  if (render->rvtxc&&((texid!=render->rvtxtexid)||(mode!=render->rvtxmode))) render_flush(render);
+  if (c>INT_MAX-render->rvtxc) return 0;
+  if (render_rvtxv_require(render,render->rvtxc+c)<0) return 0;
+  struct render_vertex_raw *dst=render->rvtxv+render->rvtxc;
+  render->rvtxc+=c;
+  render->rvtxtexid=texid;
+  render->rvtxmode=mode;
+  return dst;
+}
+
+void render_flush(struct render *render) {
+  if (!render->rvtxc) return;
+  int c=render->rvtxc;
+  render->rvtxc=0;
+  if ((render->rvtxtexid<1)||(render->rvtxtexid>render->texturec)) return;
+  struct render_texture *texture=render->texturev+render->rvtxtexid-1;
+  if (render_bind_dst(render,texture)<0) return;
+  render_use_program(render,render->pgm_raw);
+  render_uniforms_dst(
+    render,&render->uraw,render->u_raw_screensize,render->u_raw_dstedge,render->u_raw_tint,render->u_raw_alpha,
+    texture->w,texture->h,texture->edge_extra,render->tint,render->alpha
+  );
+  int offset=render_vbo_put(render,render->rvtxv,sizeof(struct render_vertex_raw)*c);
+  if (offset<0) return;
+  render_attribs(render,2);
+  glVertexAttribPointer(0,2,GL_SHORT,0,sizeof(struct render_vertex_raw),RENDER_VBO_PTR(offset+offsetof(struct render_vertex_raw,x)));
+  glVertexAttribPointer(1,4,GL_UNSIGNED_BYTE,1,sizeof(struct render_vertex_raw),RENDER_VBO_PTR(offset+offsetof(struct render_vertex_raw,r)));
+  glDrawArrays(render->rvtxmode,0,c);
+  render->frame.drawc++;
 }
 
 void render_draw_line(struct render *render,int texid,const struct egg_draw_line *v,int c) {
   if (c<1) return;
+  if (render->soft) {
+    if ((texid>=1)&&(texid<=render->texturec)) render_soft_draw_line(render,render->texturev+texid-1,v,c);
+    return;
+  }
   if (c>INT_MAX>>1) return;
-  if (render_rvtxv_require(render,c<<1)<0) return;
-  struct render_vertex_raw *dst=render->rvtxv;
+  struct render_vertex_raw *dst=render_raw_begin(render,texid,GL_LINES,c<<1);
+  if (!dst) return;
   int i=c; for (;i-->0;v++) {
     dst[0].r=dst[1].r=v->r;
     dst[0].g=dst[1].g=v->g;
@@ -378,14 +459,17 @@ void render_draw_line(struct render *render,int texid,const struct egg_draw_line
     dst->y=v->by;
     dst++;
   }
-  render_draw_raw(render,texid,GL_LINES,render->rvtxv,c<<1);
 }
  
 void render_draw_trig(struct render *render,int texid,const struct egg_draw_trig *v,int c) {
   if (c<1) return;
+  if (render->soft) {
+    if ((texid>=1)&&(texid<=render->texturec)) render_soft_draw_trig(render,render->texturev+texid-1,v,c);
+    return;
+  }
   if (c>INT_MAX/3) return;
-  if (render_rvtxv_require(render,c*3)<0) return;
-  struct render_vertex_raw *dst=render->rvtxv;
+  struct render_vertex_raw *dst=render_raw_begin(render,texid,GL_TRIANGLES,c*3);
+  if (!dst) return;
   int i=c; for (;i-->0;v++) {
     dst[0].r=dst[1].r=dst[2].r=v->r;
     dst[0].g=dst[1].g=dst[2].g=v->g;
@@ -401,7 +485,54 @@ void render_draw_trig(struct render *render,int texid,const struct egg_draw_trig
     dst->y=v->cy;
     dst++;
   }
-  render_draw_raw(render,texid,GL_TRIANGLES,render->rvtxv,c*3);
+}
+
+/* Flat rect.
+ * Two triangles each. They join the same batch as trigs.
+ */
+
+void render_draw_rect(struct render *render,int texid,const struct egg_draw_rect *v,int c) {
+  if (c<1) return;
+  if (render->soft) {
+    if ((texid>=1)&&(texid<=render->texturec)) render_soft_draw_rect(render,render->texturev+texid-1,v,c);
+    return;
+  }
+  if (c>INT_MAX/6) return;
+  struct render_vertex_raw *dst=render_raw_begin(render,texid,GL_TRIANGLES,c*6);
+  if (!dst) return;
+  int i=c; for (;i-->0;v++,dst+=6) {
+    dst[0]=(struct render_vertex_raw){v->x     ,v->y     ,v->r,v->g,v->b,v->a};
+    dst[1]=(struct render_vertex_raw){v->x     ,v->y+v->h,v->r,v->g,v->b,v->a};
+    dst[2]=(struct render_vertex_raw){v->x+v->w,v->y     ,v->r,v->g,v->b,v->a};
+    dst[3]=dst[2];
+    dst[4]=dst[1];
+    dst[5]=(struct render_vertex_raw){v->x+v->w,v->y+v->h,v->r,v->g,v->b,v->a};
+  }
+}
+
+/* Decal vertices: Four per decal, drawn as separate strips.
+ * render_draw_decal_vertices() uploads the first (c*4) of (dvtxv) and points the attributes at them.
+ */
+ 
+static int render_dvtxv_require(struct render *render,int c) {
+  if (c>INT_MAX/4/sizeof(struct render_vertex_decal)) return -1;
+  int vtxc=c<<2;
+  if (vtxc<=render->dvtxa) return 0;
+  int na=(vtxc+255)&~255;
+  void *nv=realloc(render->dvtxv,sizeof(struct render_vertex_decal)*na);
+  if (!nv) return -1;
+  render->dvtxv=nv;
+  render->dvtxa=na;
+  return 0;
+}
+
+static int render_draw_decal_vertices(struct render *render,int c) {
+  int offset=render_vbo_put(render,render->dvtxv,sizeof(struct render_vertex_decal)*(c<<2));
+  if (offset<0) return -1;
+  render_attribs(render,2);
+  glVertexAttribPointer(0,2,GL_SHORT,0,sizeof(struct render_vertex_decal),RENDER_VBO_PTR(offset+offsetof(struct render_vertex_decal,x)));
+  glVertexAttribPointer(1,2,GL_FLOAT,0,sizeof(struct render_vertex_decal),RENDER_VBO_PTR(offset+offsetof(struct render_vertex_decal,tx)));
+  return 0;
 }
 
 /* Decal.
@@ -414,32 +545,37 @@ void render_draw_decal(struct render *render,int dsttexid,int srctexid,const str
   struct render_texture *dsttex=render->texturev+dsttexid-1;
   struct render_texture *srctex=render->texturev+srctexid-1;
   if ((srctex->w<1)||(srctex->h<1)) return;
-  if (render_texture_require_fb(dsttex)<0) return;
-  glBindFramebuffer(GL_FRAMEBUFFER,dsttex->fbid);
-  glViewport(0,0,dsttex->edge_extra*2+dsttex->w,dsttex->edge_extra*2+dsttex->h);
-  glUseProgram(render->pgm_decal);
-  glUniform2f(render->u_decal_screensize,dsttex->w,dsttex->h);
-  glBindTexture(GL_TEXTURE_2D,srctex->texid);
-  glUniform4f(render->u_decal_tint,(render->tint>>24)/255.0f,((render->tint>>16)&0xff)/255.0f,((render->tint>>8)&0xff)/255.0f,(render->tint&0xff)/255.0f);
-  glUniform1f(render->u_decal_alpha,render->alpha/255.0f);
-  glUniform1f(render->u_decal_dstedge,dsttex->edge_extra);
-  glUniform1f(render->u_decal_srcedge,srctex->edge_extra);
-  glUniform2f(render->u_decal_texsize,srctex->w+srctex->edge_extra*2.0,srctex->h+srctex->edge_extra*2.0);
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
+  if (render->soft) {
+    render_soft_draw_decal(render,dsttex,srctex,v,c);
+    return;
+  }
+  render_flush(render);
+  if (render_bind_dst(render,dsttex)<0) return;
+  render_use_program(render,render->pgm_decal);
+  render_bind_texture(render,srctex->texid);
+  render_uniforms_dst(
+    render,&render->udecal,render->u_decal_screensize,render->u_decal_dstedge,render->u_decal_tint,render->u_decal_alpha,
+    dsttex->w,dsttex->h,dsttex->edge_extra,render->tint,render->alpha
+  );
+  render_uniforms_src(render,&render->udecal,render->u_decal_srcedge,render->u_decal_texsize,srctex);
   
-  for (;c-->0;v++) {
+  /* Assemble all the vertices first, and upload them in one shot.
+   * Each decal is still its own draw call, since they each have their own texlimit.
+   */
+  if (c<1) return;
+  if (render_dvtxv_require(render,c)<0) return;
+  struct render_vertex_decal *vtxv=render->dvtxv;
+  const struct egg_draw_decal *v0=v;
+  int n=c; for (;n-->0;v++,vtxv+=4) {
     int dstw=v->w,dsth=v->h;
     if (v->xform&EGG_XFORM_SWAP) {
       dstw=v->h;
       dsth=v->w;
     }
-    struct render_vertex_decal vtxv[]={
-      {v->dstx     ,v->dsty     ,0.0f,0.0f},
-      {v->dstx     ,v->dsty+dsth,0.0f,1.0f},
-      {v->dstx+dstw,v->dsty     ,1.0f,0.0f},
-      {v->dstx+dstw,v->dsty+dsth,1.0f,1.0f},
-    };
+    vtxv[0]=(struct render_vertex_decal){v->dstx     ,v->dsty     ,0.0f,0.0f};
+    vtxv[1]=(struct render_vertex_decal){v->dstx     ,v->dsty+dsth,0.0f,1.0f};
+    vtxv[2]=(struct render_vertex_decal){v->dstx+dstw,v->dsty     ,1.0f,0.0f};
+    vtxv[3]=(struct render_vertex_decal){v->dstx+dstw,v->dsty+dsth,1.0f,1.0f};
     if (v->xform&EGG_XFORM_SWAP) {
       struct render_vertex_decal *vtx=vtxv;
       int i=4; for (;i-->0;vtx++) {
@@ -465,20 +601,23 @@ void render_draw_decal(struct render *render,int dsttexid,int srctexid,const str
       vtx->tx=tx0+tx1*vtx->tx;
       vtx->ty=ty0+ty1*vtx->ty;
     }
-    glUniform4f(render->u_decal_texlimit,tx0,ty0,tx0+tx1,ty0+ty1);
-    glVertexAttribPointer(0,2,GL_SHORT,0,sizeof(struct render_vertex_decal),&vtxv[0].x);
-    glVertexAttribPointer(1,2,GL_FLOAT,0,sizeof(struct render_vertex_decal),&vtxv[0].tx);
-    glDrawArrays(GL_TRIANGLE_STRIP,0,4);
   }
-  
-  glDisableVertexAttribArray(0);
-  glDisableVertexAttribArray(1);
+  if (render_draw_decal_vertices(render,c)<0) return;
+  int i=0; for (v=v0;i<c;i++,v++) {
+    GLfloat tx0=(GLfloat)v->srcx/(GLfloat)srctex->w;
+    GLfloat tx1=(GLfloat)v->w/(GLfloat)srctex->w;
+    GLfloat ty0=(GLfloat)v->srcy/(GLfloat)srctex->h;
+    GLfloat ty1=(GLfloat)v->h/(GLfloat)srctex->h;
+    render_uniform_texlimit(render,tx0,ty0,tx0+tx1,ty0+ty1);
+    glDrawArrays(GL_TRIANGLE_STRIP,i<<2,4);
+    render->frame.drawc++;
+  }
 }
 
 /* Decal with free scale and rotation.
  */
  
-static void render_draw_mode7_1(struct render *render,struct render_texture *srctex,const struct egg_draw_mode7 *v) {
+static void render_draw_mode7_1(struct render_vertex_decal *vtxv,struct render_texture *srctex,const struct egg_draw_mode7 *v) {
   // Transform the output vertices right here, CPU-side.
   double cost=cos(-v->rotate);
   double sint=sin(-v->rotate);
@@ -488,12 +627,10 @@ static void render_draw_mode7_1(struct render *render,struct render_texture *src
   int nwy=lround(-sint*halfw+cost*halfh);
   int swx=lround( cost*halfw-sint*halfh);
   int swy=lround(-sint*halfw-cost*halfh);
-  struct render_vertex_decal vtxv[]={
-    {v->dstx-nwx,v->dsty-nwy,0.0f,0.0f},
-    {v->dstx-swx,v->dsty-swy,0.0f,1.0f},
-    {v->dstx+swx,v->dsty+swy,1.0f,0.0f},
-    {v->dstx+nwx,v->dsty+nwy,1.0f,1.0f},
-  };
+  vtxv[0]=(struct render_vertex_decal){v->dstx-nwx,v->dsty-nwy,0.0f,0.0f};
+  vtxv[1]=(struct render_vertex_decal){v->dstx-swx,v->dsty-swy,0.0f,1.0f};
+  vtxv[2]=(struct render_vertex_decal){v->dstx+swx,v->dsty+swy,1.0f,0.0f};
+  vtxv[3]=(struct render_vertex_decal){v->dstx+nwx,v->dsty+nwy,1.0f,1.0f};
   GLfloat tx0=((GLfloat)v->srcx)/(GLfloat)srctex->w;
   GLfloat tx1=((GLfloat)v->w)/(GLfloat)srctex->w;
   GLfloat ty0=((GLfloat)v->srcy)/(GLfloat)srctex->h;
@@ -503,10 +640,6 @@ static void render_draw_mode7_1(struct render *render,struct render_texture *src
     vtx->tx=tx0+tx1*vtx->tx;
     vtx->ty=ty0+ty1*vtx->ty;
   }
-  glUniform4f(render->u_decal_texlimit,vtxv[0].tx,vtxv[0].ty,vtxv[3].tx,vtxv[3].ty);
-  glVertexAttribPointer(0,2,GL_SHORT,0,sizeof(struct render_vertex_decal),&vtxv[0].x);
-  glVertexAttribPointer(1,2,GL_FLOAT,0,sizeof(struct render_vertex_decal),&vtxv[0].tx);
-  glDrawArrays(GL_TRIANGLE_STRIP,0,4);
 }
 
 void render_draw_mode7(struct render *render,int dsttexid,int srctexid,const struct egg_draw_mode7 *v,int c,int interpolate) {
@@ -516,29 +649,38 @@ void render_draw_mode7(struct render *render,int dsttexid,int srctexid,const str
   struct render_texture *dsttex=render->texturev+dsttexid-1;
   struct render_texture *srctex=render->texturev+srctexid-1;
   if ((srctex->w<1)||(srctex->h<1)) return;
-  if (render_texture_require_fb(dsttex)<0) return;
-  glBindFramebuffer(GL_FRAMEBUFFER,dsttex->fbid);
-  glViewport(0,0,dsttex->edge_extra*2+dsttex->w,dsttex->edge_extra*2+dsttex->h);
-  glUseProgram(render->pgm_decal);
-  glUniform2f(render->u_decal_screensize,dsttex->w,dsttex->h);
-  glUniform1f(render->u_decal_dstedge,dsttex->edge_extra);
-  glUniform1f(render->u_decal_srcedge,srctex->edge_extra);
-  glUniform2f(render->u_decal_texsize,srctex->w+srctex->edge_extra*2.0,srctex->h+srctex->edge_extra*2.0);
-  glBindTexture(GL_TEXTURE_2D,srctex->texid);
+  if (render->soft) {
+    render_soft_draw_mode7(render,dsttex,srctex,v,c);
+    return;
+  }
+  render_flush(render);
+  if (render_bind_dst(render,dsttex)<0) return;
+  render_use_program(render,render->pgm_decal);
+  render_bind_texture(render,srctex->texid);
+  render_uniforms_dst(
+    render,&render->udecal,render->u_decal_screensize,render->u_decal_dstedge,render->u_decal_tint,render->u_decal_alpha,
+    dsttex->w,dsttex->h,dsttex->edge_extra,render->tint,render->alpha
+  );
+  render_uniforms_src(render,&render->udecal,render->u_decal_srcedge,render->u_decal_texsize,srctex);
   if (interpolate) {
     glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    render->frame.statec+=2;
+  }
+  if (c<1) return;
+  if (render_dvtxv_require(render,c)<0) return;
+  struct render_vertex_decal *vtxv=render->dvtxv;
+  int i=c; for (;i-->0;v++,vtxv+=4) render_draw_mode7_1(vtxv,srctex,v);
+  if (render_draw_decal_vertices(render,c)<0) return;
+  for (vtxv=render->dvtxv,i=0;i<c;i++,vtxv+=4) {
+    render_uniform_texlimit(render,vtxv[0].tx,vtxv[0].ty,vtxv[3].tx,vtxv[3].ty);
+    glDrawArrays(GL_TRIANGLE_STRIP,i<<2,4);
+    render->frame.drawc++;
   }
-  glUniform4f(render->u_decal_tint,(render->tint>>24)/255.0f,((render->tint>>16)&0xff)/255.0f,((render->tint>>8)&0xff)/255.0f,(render->tint&0xff)/255.0f);
-  glUniform1f(render->u_decal_alpha,render->alpha/255.0f);
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  for (;c-->0;v++) render_draw_mode7_1(render,srctex,v);
-  glDisableVertexAttribArray(0);
-  glDisableVertexAttribArray(1);
   if (interpolate) {
     glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
+    render->frame.statec+=2;
   }
 }
 
@@ -551,36 +693,39 @@ void render_draw_tile(struct render *render,int dsttexid,int srctexid,const stru
   if ((srctexid<1)||(srctexid>render->texturec)) return;
   struct render_texture *dsttex=render->texturev+dsttexid-1;
   struct render_texture *srctex=render->texturev+srctexid-1;
-  if (render_texture_require_fb(dsttex)<0) return;
-  glBindFramebuffer(GL_FRAMEBUFFER,dsttex->fbid);
-  glViewport(0,0,dsttex->edge_extra*2+dsttex->w,dsttex->edge_extra*2+dsttex->h);
-  glUseProgram(render->pgm_tile);
-  glUniform2f(render->u_tile_screensize,dsttex->w,dsttex->h);
-  glActiveTexture(GL_TEXTURE0);
-  glUniform1i(render->u_tile_sampler,0);
-  glBindTexture(GL_TEXTURE_2D,srctex->texid);
-  glUniform4f(render->u_tile_tint,(render->tint>>24)/255.0f,((render->tint>>16)&0xff)/255.0f,((render->tint>>8)&0xff)/255.0f,(render->tint&0xff)/255.0f);
-  glUniform1f(render->u_tile_alpha,render->alpha/255.0f);
-  glUniform1f(render->u_tile_pointsize,srctex->w>>4);
-  glUniform1f(render->u_tile_dstedge,dsttex->edge_extra);
-  glUniform1f(render->u_tile_srcedge,srctex->edge_extra);
-  glUniform2f(render->u_tile_texsize,srctex->w+srctex->edge_extra*2.0,srctex->h+srctex->edge_extra*2.0);
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  glEnableVertexAttribArray(2);
-  glVertexAttribPointer(0,2,GL_SHORT,0,sizeof(struct egg_draw_tile),&v[0].dstx);
-  glVertexAttribPointer(1,1,GL_UNSIGNED_BYTE,0,sizeof(struct egg_draw_tile),&v[0].tileid);
-  glVertexAttribPointer(2,1,GL_UNSIGNED_BYTE,0,sizeof(struct egg_draw_tile),&v[0].xform);
+  if (render->soft) {
+    render_soft_draw_tile(render,dsttex,srctex,v,c);
+    return;
+  }
+  render_flush(render);
+  if (render_bind_dst(render,dsttex)<0) return;
+  render_use_program(render,render->pgm_tile);
+  render_bind_texture(render,srctex->texid);
+  render_uniforms_dst(
+    render,&render->utile,render->u_tile_screensize,render->u_tile_dstedge,render->u_tile_tint,render->u_tile_alpha,
+    dsttex->w,dsttex->h,dsttex->edge_extra,render->tint,render->alpha
+  );
+  if (!render->utile.srcvalid||(srctex->w!=render->utile.srcw)) {
+    glUniform1f(render->u_tile_pointsize,srctex->w>>4);
+    render->frame.statec++;
+  }
+  render_uniforms_src(render,&render->utile,render->u_tile_srcedge,render->u_tile_texsize,srctex);
+  if ((c<1)||(c>INT_MAX/sizeof(struct egg_draw_tile))) return;
+  int offset=render_vbo_put(render,v,sizeof(struct egg_draw_tile)*c);
+  if (offset<0) return;
+  render_attribs(render,3);
+  glVertexAttribPointer(0,2,GL_SHORT,0,sizeof(struct egg_draw_tile),RENDER_VBO_PTR(offset+offsetof(struct egg_draw_tile,dstx)));
+  glVertexAttribPointer(1,1,GL_UNSIGNED_BYTE,0,sizeof(struct egg_draw_tile),RENDER_VBO_PTR(offset+offsetof(struct egg_draw_tile,tileid)));
+  glVertexAttribPointer(2,1,GL_UNSIGNED_BYTE,0,sizeof(struct egg_draw_tile),RENDER_VBO_PTR(offset+offsetof(struct egg_draw_tile,xform)));
   glDrawArrays(GL_POINTS,0,c);
-  glDisableVertexAttribArray(0);
-  glDisableVertexAttribArray(1);
-  glDisableVertexAttribArray(2);
+  render->frame.drawc++;
 }
 
 /* Draw to main.
  */
  
 void render_draw_to_main(struct render *render,int mainw,int mainh,int texid) {
+  render_flush(render);
   if ((texid<1)||(texid>render->texturec)) return;
   struct render_texture *texture=render->texturev+texid-1;
   if ((texture->w<1)||(texture->h<1)) return;
@@ -608,36 +753,43 @@ void render_draw_to_main(struct render *render,int mainw,int mainh,int texid) {
   render->outw=w;
   render->outh=h;
   
+  if (render->soft) {
+    render_soft_draw_to_main(render,mainw,mainh,texture,dstx,dsty,w,h);
+    render_end_frame(render);
+    return;
+  }
+  
   struct render_vertex_decal vtxv[]={
     {dstx  ,dsty  ,0.0f,1.0f},
     {dstx  ,dsty+h,0.0f,0.0f},
     {dstx+w,dsty  ,1.0f,1.0f},
     {dstx+w,dsty+h,1.0f,0.0f},
   };
-  glBindFramebuffer(GL_FRAMEBUFFER,0);
-  glViewport(0,0,mainw,mainh);
+  render_bind_fb(render,0,mainw,mainh);
   if ((w<mainw)||(h<mainh)) {
     glClearColor(0.0f,0.0f,0.0f,1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
+    render->frame.statec++;
+    render->frame.drawc++;
   }
-  glUseProgram(render->pgm_decal);
-  glUniform2f(render->u_decal_screensize,mainw,mainh);
-  glUniform1i(render->u_decal_sampler,0);
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D,texture->texid);
+  render_use_program(render,render->pgm_decal);
+  render_bind_texture(render,texture->texid);
   glDisable(GL_BLEND);
-  glUniform4f(render->u_decal_tint,0.0f,0.0f,0.0f,0.0f);
-  glUniform1f(render->u_decal_alpha,1.0f);
-  glUniform4f(render->u_decal_texlimit,0.0f,0.0f,1.0f,1.0f);
-  glUniform1f(render->u_decal_dstedge,0.0f);
-  glUniform1f(render->u_decal_srcedge,texture->edge_extra);
-  glUniform2f(render->u_decal_texsize,texture->w+texture->edge_extra*2.0,texture->h+texture->edge_extra*2.0);
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(0,2,GL_SHORT,0,sizeof(struct render_vertex_decal),&vtxv[0].x);
-  glVertexAttribPointer(1,2,GL_FLOAT,0,sizeof(struct render_vertex_decal),&vtxv[0].tx);
-  glDrawArrays(GL_TRIANGLE_STRIP,0,4);
-  glDisableVertexAttribArray(0);
-  glDisableVertexAttribArray(1);
+  render_uniforms_dst(
+    render,&render->udecal,render->u_decal_screensize,render->u_decal_dstedge,render->u_decal_tint,render->u_decal_alpha,
+    mainw,mainh,0,0,0xff
+  );
+  render_uniforms_src(render,&render->udecal,render->u_decal_srcedge,render->u_decal_texsize,texture);
+  render_uniform_texlimit(render,0.0f,0.0f,1.0f,1.0f);
+  int offset=render_vbo_put(render,vtxv,sizeof(vtxv));
+  if (offset>=0) {
+    render_attribs(render,2);
+    glVertexAttribPointer(0,2,GL_SHORT,0,sizeof(struct render_vertex_decal),RENDER_VBO_PTR(offset+offsetof(struct render_vertex_decal,x)));
+    glVertexAttribPointer(1,2,GL_FLOAT,0,sizeof(struct render_vertex_decal),RENDER_VBO_PTR(offset+offsetof(struct render_vertex_decal,tx)));
+    glDrawArrays(GL_TRIANGLE_STRIP,0,4);
+  }
   glEnable(GL_BLEND);
+  render->frame.statec+=2;
+  render->frame.drawc++;
+  render_end_frame(render);
 }
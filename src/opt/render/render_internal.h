@@ -7,6 +7,7 @@
 #include <limits.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include "egg/egg.h"
 #include "opt/image/image.h"
 
@@ -20,6 +21,12 @@
   #include "GLES2/gl2.h"
 #endif
 
+// Initial size of the streaming vertex buffer, bytes. Grows to fit the largest single upload.
+#define RENDER_VBO_SIZE (256<<10)
+
+// Offset into the bound vertex buffer, as glVertexAttribPointer wants it.
+#define RENDER_VBO_PTR(offset) ((const void*)(uintptr_t)(offset))
+
 #ifndef EGG_GLSL_VERSION
   #define EGG_GLSL_VERSION 100
 #endif
@@ -40,6 +47,18 @@ struct render_texture {
   int w,h,fmt;
   int qual,rid; // Commentary we can report later, for saving state.
   int edge_extra; // Actual texture is so much larger on each side, to dodge point-culling problems in MacOS. Not included in (w,h)
+  uint8_t *softv; // Software mode only: RGBA, (w*4) stride, top row first. (texid) is a nonzero placeholder.
+};
+
+/* Uniforms as we last set them, for one program.
+ * Source fields are not used by the raw program.
+ */
+struct render_uniforms {
+  int valid,srcvalid;
+  int dstw,dsth,dstedge;
+  int srcw,srch,srcedge;
+  uint32_t tint;
+  uint8_t alpha;
 };
 
 struct render {
@@ -84,12 +103,76 @@ struct render {
   // Frame of last output framebuffer, in window coords.
   int outx,outy,outw,outh;
   
-  // Temporary buffer for raw vertices.
+  /* Raw vertices. The first (rvtxc) are a deferred draw, see render_flush().
+   */
   struct render_vertex_raw *rvtxv;
-  int rvtxa;
+  int rvtxc,rvtxa;
+  int rvtxmode; // GL_LINES or GL_TRIANGLES
+  int rvtxtexid; // Output.
+  
+  // Scratch for decal and mode7, which assemble all their vertices before one upload.
+  struct render_vertex_decal *dvtxv;
+  int dvtxa;
+  
+  /* Streaming vertex buffer. Every draw uploads its vertices at (vbop), and when it fills we orphan the whole thing and start over.
+   * Sizes in bytes.
+   */
+  GLuint vbo;
+  int vbop,vboa;
+  int cur_vbo; // Nonzero if (vbo) is bound to GL_ARRAY_BUFFER.
+  
+  /* GL state as we last set it, so we can skip redundant calls.
+   * Bindings are -1 for unknown. We forget them at the end of each frame, since the host may use GL between frames.
+   * Uniforms belong to our programs, so nobody else touches them.
+   */
+  int cur_fbid,cur_vieww,cur_viewh;
+  int cur_pgm;
+  int cur_texid;
+  int cur_attrc; // Vertex attribute arrays 0..n-1 are enabled.
+  struct render_uniforms uraw,udecal,utile;
+  GLfloat texlimit[4]; // Decal program only.
+  
+  struct render_stats frame,last,total;
+  
+  /* Software mode: No GL at all, and textures live in (softv).
+   * Output of render_draw_to_main goes to (mainv).
+   */
+  int soft;
+  uint8_t *softrow; // Scratch, (softrowa) pixels.
+  int softrowa;
+  void *mainv;
+  int mainw,mainh;
 };
 
 int render_init_programs(struct render *render);
-int render_texture_require_fb(struct render_texture *texture);
+int render_texture_require_fb(struct render *render,struct render_texture *texture);
+
+/* GL state changes, in render_context.c.
+ * These do nothing if the state is already as requested, and they count the ones that aren't.
+ */
+void render_bind_fb(struct render *render,int fbid,int w,int h);
+void render_use_program(struct render *render,int pgm);
+void render_bind_texture(struct render *render,int texid);
+void render_attribs(struct render *render,int c);
+void render_end_frame(struct render *render);
+
+/* Upload vertices to the streaming buffer and leave it bound.
+ * Returns the offset for RENDER_VBO_PTR(), or <0 on errors.
+ */
+int render_vbo_put(struct render *render,const void *src,int len);
+
+/* Software implementations, in render_soft.c.
+ * Callers validate texids and check (render->soft).
+ */
+int render_soft_store(struct render_texture *texture,int w,int h,int fmt,const void *src);
+int render_soft_read(void *dst,const struct render_texture *texture);
+void render_soft_clear(struct render_texture *texture);
+void render_soft_draw_line(struct render *render,struct render_texture *dst,const struct egg_draw_line *v,int c);
+void render_soft_draw_rect(struct render *render,struct render_texture *dst,const struct egg_draw_rect *v,int c);
+void render_soft_draw_trig(struct render *render,struct render_texture *dst,const struct egg_draw_trig *v,int c);
+void render_soft_draw_decal(struct render *render,struct render_texture *dst,struct render_texture *src,const struct egg_draw_decal *v,int c);
+void render_soft_draw_tile(struct render *render,struct render_texture *dst,struct render_texture *src,const struct egg_draw_tile *v,int c);
+void render_soft_draw_mode7(struct render *render,struct render_texture *dst,struct render_texture *src,const struct egg_draw_mode7 *v,int c);
+void render_soft_draw_to_main(struct render *render,int mainw,int mainh,struct render_texture *texture,int dstx,int dsty,int w,int h);
 
 #endif
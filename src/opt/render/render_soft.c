@@ -0,0 +1,480 @@
+/* render_soft.c
+ * CPU implementation of the whole render API, for hosts without a GL context.
+ * Textures are RGBA bytes, row zero on top, and no edge padding.
+ * Blending is the same as our GL setup: SRC_ALPHA,ONE_MINUS_SRC_ALPHA on all four channels.
+ * Sampling is always nearest-neighbor, even for interpolated mode7.
+ * Spans blend 4 pixels at a time with SSE2 when the compiler targets it. Build with -DRENDER_USE_SIMD=0 to force scalar.
+ */
+
+#include "render_internal.h"
+#include <math.h>
+
+#ifndef RENDER_USE_SIMD
+  #if defined(__SSE2__)
+    #define RENDER_USE_SIMD 1
+  #else
+    #define RENDER_USE_SIMD 0
+  #endif
+#endif
+#if RENDER_USE_SIMD
+  #include <emmintrin.h>
+#endif
+
+/* Exact round(x/255) for x in 0..65025.
+ */
+#define DIV255(x) ((((x)+128)+(((x)+128)>>8))>>8)
+
+/* Blend (c) pixels of (src) onto (dst).
+ */
+
+static void render_soft_blend(uint8_t *dst,const uint8_t *src,int c) {
+  #if RENDER_USE_SIMD
+    const __m128i zero=_mm_setzero_si128();
+    const __m128i k255=_mm_set1_epi16(255);
+    const __m128i k128=_mm_set1_epi16(128);
+    const __m128i amask=_mm_set1_epi32(0xff000000);
+    for (;c>=4;c-=4,dst+=16,src+=16) {
+      __m128i s=_mm_loadu_si128((const __m128i*)src);
+      __m128i a=_mm_and_si128(s,amask);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(a,amask))==0xffff) {
+        _mm_storeu_si128((__m128i*)dst,s);
+        continue;
+      }
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(a,zero))==0xffff) continue;
+      __m128i d=_mm_loadu_si128((const __m128i*)dst);
+      #define HALF(unpack) ({ \
+        __m128i s16=unpack(s,zero),d16=unpack(d,zero); \
+        __m128i a16=_mm_shufflehi_epi16(_mm_shufflelo_epi16(s16,0xff),0xff); \
+        __m128i x=_mm_add_epi16(_mm_mullo_epi16(s16,a16),_mm_mullo_epi16(d16,_mm_sub_epi16(k255,a16))); \
+        x=_mm_add_epi16(x,k128); \
+        _mm_srli_epi16(_mm_add_epi16(x,_mm_srli_epi16(x,8)),8); \
+      })
+      __m128i lo=HALF(_mm_unpacklo_epi8);
+      __m128i hi=HALF(_mm_unpackhi_epi8);
+      #undef HALF
+      _mm_storeu_si128((__m128i*)dst,_mm_packus_epi16(lo,hi));
+    }
+  #endif
+  for (;c-->0;dst+=4,src+=4) {
+    int a=src[3];
+    if (!a) continue;
+    if (a==0xff) { memcpy(dst,src,4); continue; }
+    int ia=0xff-a;
+    dst[0]=DIV255(src[0]*a+dst[0]*ia);
+    dst[1]=DIV255(src[1]*a+dst[1]*ia);
+    dst[2]=DIV255(src[2]*a+dst[2]*ia);
+    dst[3]=DIV255(src[3]*a+dst[3]*ia);
+  }
+}
+
+/* Apply global tint and alpha to (c) pixels in place.
+ * Caller should skip it when render_soft_shading() is false.
+ */
+
+static int render_soft_shading(const struct render *render) {
+  return (render->tint&0xff)||(render->alpha!=0xff);
+}
+
+static void render_soft_shade(uint8_t *v,int c,const struct render *render) {
+  int tr=render->tint>>24,tg=(render->tint>>16)&0xff,tb=(render->tint>>8)&0xff,ta=render->tint&0xff;
+  int ita=0xff-ta,alpha=render->alpha;
+  for (;c-->0;v+=4) {
+    if (ta) {
+      v[0]=DIV255(v[0]*ita+tr*ta);
+      v[1]=DIV255(v[1]*ita+tg*ta);
+      v[2]=DIV255(v[2]*ita+tb*ta);
+    }
+    v[3]=DIV255(v[3]*alpha);
+  }
+}
+
+/* Scratch row, for shading and gathering before a blend.
+ */
+
+static uint8_t *render_soft_row(struct render *render,int c) {
+  if (c>render->softrowa) {
+    if (c>INT_MAX>>2) return 0;
+    void *nv=realloc(render->softrow,c<<2);
+    if (!nv) return 0;
+    render->softrow=nv;
+    render->softrowa=c;
+  }
+  return render->softrow;
+}
+
+/* Blend a row of source pixels, with the global tint and alpha.
+ * (src) may be the scratch row itself.
+ */
+
+static void render_soft_put_row(struct render *render,uint8_t *dst,const uint8_t *src,int c) {
+  if (render_soft_shading(render)) {
+    uint8_t *tmp=render_soft_row(render,c);
+    if (!tmp) return;
+    if (tmp!=src) memcpy(tmp,src,c<<2);
+    render_soft_shade(tmp,c,render);
+    src=tmp;
+  }
+  render_soft_blend(dst,src,c);
+}
+
+/* Fill a span with one flat color, which has already been shaded.
+ */
+
+static void render_soft_fill(struct render *render,uint8_t *dst,const uint8_t *rgba,int c) {
+  if (rgba[3]==0xff) {
+    uint32_t pixel;
+    memcpy(&pixel,rgba,4);
+    uint32_t *p=(uint32_t*)dst;
+    for (;c-->0;p++) *p=pixel;
+  } else if (rgba[3]) {
+    uint8_t *tmp=render_soft_row(render,c);
+    if (!tmp) return;
+    uint32_t pixel,*p=(uint32_t*)tmp;
+    memcpy(&pixel,rgba,4);
+    int i=c; for (;i-->0;p++) *p=pixel;
+    render_soft_blend(dst,tmp,c);
+  }
+}
+
+static void render_soft_color(uint8_t *dst,const struct render *render,uint8_t r,uint8_t g,uint8_t b,uint8_t a) {
+  dst[0]=r; dst[1]=g; dst[2]=b; dst[3]=a;
+  if (render_soft_shading(render)) render_soft_shade(dst,1,render);
+}
+
+/* Texture storage.
+ */
+
+int render_soft_store(struct render_texture *texture,int w,int h,int fmt,const void *src) {
+  if ((w<1)||(h<1)||(w>0x7fff)||(h>0x7fff)) return -1;
+  uint8_t *nv=calloc(w*h,4);
+  if (!nv) return -1;
+  if (src) {
+    const uint8_t *SRC=src;
+    if (fmt==EGG_TEX_FMT_RGBA) {
+      memcpy(nv,SRC,(w*h)<<2);
+    } else if (fmt==EGG_TEX_FMT_A8) {
+      uint8_t *dst=nv+3;
+      int i=w*h; for (;i-->0;dst+=4,SRC++) *dst=*SRC;
+    } else {
+      free(nv);
+      return -1;
+    }
+  }
+  if (texture->softv) free(texture->softv);
+  texture->softv=nv;
+  return 0;
+}
+
+int render_soft_read(void *dst,const struct render_texture *texture) {
+  if (!texture->softv) return -1;
+  int pixelc=texture->w*texture->h;
+  if (texture->fmt==EGG_TEX_FMT_RGBA) {
+    memcpy(dst,texture->softv,pixelc<<2);
+  } else if (texture->fmt==EGG_TEX_FMT_A8) {
+    uint8_t *DST=dst;
+    const uint8_t *src=texture->softv+3;
+    for (;pixelc-->0;DST++,src+=4) *DST=*src;
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
+void render_soft_clear(struct render_texture *texture) {
+  if (texture->softv) memset(texture->softv,0,(texture->w*texture->h)<<2);
+}
+
+/* Rects.
+ */
+
+void render_soft_draw_rect(struct render *render,struct render_texture *dst,const struct egg_draw_rect *v,int c) {
+  if (!dst->softv) return;
+  for (;c-->0;v++) {
+    int x=v->x,y=v->y,w=v->w,h=v->h;
+    if (x<0) { w+=x; x=0; }
+    if (y<0) { h+=y; y=0; }
+    if (x>dst->w-w) w=dst->w-x;
+    if (y>dst->h-h) h=dst->h-y;
+    if ((w<1)||(h<1)) continue;
+    uint8_t rgba[4];
+    render_soft_color(rgba,render,v->r,v->g,v->b,v->a);
+    uint8_t *row=dst->softv+((y*dst->w+x)<<2);
+    for (;h-->0;row+=dst->w<<2) render_soft_fill(render,row,rgba,w);
+  }
+}
+
+/* Lines: Bresenham, including the first point but not the last.
+ */
+
+void render_soft_draw_line(struct render *render,struct render_texture *dst,const struct egg_draw_line *v,int c) {
+  if (!dst->softv) return;
+  for (;c-->0;v++) {
+    uint8_t rgba[4];
+    render_soft_color(rgba,render,v->r,v->g,v->b,v->a);
+    int x=v->ax,y=v->ay;
+    int dx=v->bx-x,dy=v->by-y;
+    int sx=(dx<0)?-1:1,sy=(dy<0)?-1:1;
+    if (dx<0) dx=-dx;
+    if (dy<0) dy=-dy;
+    int err=dx-dy;
+    while ((x!=v->bx)||(y!=v->by)) {
+      if ((x>=0)&&(y>=0)&&(x<dst->w)&&(y<dst->h)) {
+        render_soft_blend(dst->softv+((y*dst->w+x)<<2),rgba,1);
+      }
+      int e2=err<<1;
+      if (e2>-dy) { err-=dy; x+=sx; }
+      if (e2<dx) { err+=dx; y+=sy; }
+    }
+  }
+}
+
+/* Triangles: Test pixel centers against each edge, in doubled coordinates so everything stays integer.
+ * Edges exactly on a pixel center go to the triangle on their left or top, so neighbors don't overlap.
+ */
+
+static int render_soft_edge_bias(int ax,int ay,int bx,int by) {
+  if ((ay==by)&&(bx<ax)) return 0; // top
+  if (by>ay) return 0; // left
+  return 1;
+}
+
+void render_soft_draw_trig(struct render *render,struct render_texture *dst,const struct egg_draw_trig *v,int c) {
+  if (!dst->softv) return;
+  for (;c-->0;v++) {
+    int ax=v->ax,ay=v->ay,bx=v->bx,by=v->by,cx=v->cx,cy=v->cy;
+    int area=(bx-ax)*(cy-ay)-(by-ay)*(cx-ax);
+    if (!area) continue;
+    if (area>0) { int tx=bx,ty=by; bx=cx; by=cy; cx=tx; cy=ty; }
+    int x0=ax,x1=ax,y0=ay,y1=ay;
+    if (bx<x0) x0=bx; else if (bx>x1) x1=bx;
+    if (cx<x0) x0=cx; else if (cx>x1) x1=cx;
+    if (by<y0) y0=by; else if (by>y1) y1=by;
+    if (cy<y0) y0=cy; else if (cy>y1) y1=cy;
+    if (x0<0) x0=0;
+    if (y0<0) y0=0;
+    if (x1>dst->w) x1=dst->w;
+    if (y1>dst->h) y1=dst->h;
+    if ((x0>=x1)||(y0>=y1)) continue;
+    int biasab=render_soft_edge_bias(ax,ay,bx,by);
+    int biasbc=render_soft_edge_bias(bx,by,cx,cy);
+    int biasca=render_soft_edge_bias(cx,cy,ax,ay);
+    uint8_t rgba[4];
+    render_soft_color(rgba,render,v->r,v->g,v->b,v->a);
+    int y=y0; for (;y<y1;y++) {
+      int py=y*2+1,runx=-1,runc=0;
+      int x=x0; for (;x<x1;x++) {
+        int px=x*2+1;
+        int eab=(bx-ax)*2*(py-ay*2)-(by-ay)*2*(px-ax*2);
+        int ebc=(cx-bx)*2*(py-by*2)-(cy-by)*2*(px-bx*2);
+        int eca=(ax-cx)*2*(py-cy*2)-(ay-cy)*2*(px-cx*2);
+        if ((eab<biasab)&&(ebc<biasbc)&&(eca<biasca)) {
+          if (runx<0) runx=x;
+          runc++;
+        } else if (runx>=0) break;
+      }
+      if (runc) render_soft_fill(render,dst->softv+((y*dst->w+runx)<<2),rgba,runc);
+    }
+  }
+}
+
+/* Decals.
+ */
+
+void render_soft_draw_decal(struct render *render,struct render_texture *dst,struct render_texture *src,const struct egg_draw_decal *v,int c) {
+  if (!dst->softv||!src->softv) return;
+  for (;c-->0;v++) {
+    int dstw=v->w,dsth=v->h;
+    if (v->xform&EGG_XFORM_SWAP) { dstw=v->h; dsth=v->w; }
+    int colz=0,colc=dstw,rowz=0,rowc=dsth;
+    if (v->dstx<0) { colz=-v->dstx; colc+=v->dstx; }
+    if (v->dsty<0) { rowz=-v->dsty; rowc+=v->dsty; }
+    if (v->dstx+dstw>dst->w) colc-=v->dstx+dstw-dst->w;
+    if (v->dsty+dsth>dst->h) rowc-=v->dsty+dsth-dst->h;
+    if ((colc<1)||(rowc<1)) continue;
+    uint8_t *tmp=render_soft_row(render,colc);
+    if (!tmp) return;
+    uint8_t *dstrow=dst->softv+(((v->dsty+rowz)*dst->w+v->dstx+colz)<<2);
+    int j=rowz; for (;j<rowz+rowc;j++,dstrow+=dst->w<<2) {
+      uint8_t *tp=tmp;
+      int i=colz; for (;i<colz+colc;i++,tp+=4) {
+        int sx,sy;
+        if (v->xform&EGG_XFORM_SWAP) { sx=j; sy=i; } else { sx=i; sy=j; }
+        if (v->xform&EGG_XFORM_XREV) sx=v->w-1-sx;
+        if (v->xform&EGG_XFORM_YREV) sy=v->h-1-sy;
+        sx+=v->srcx;
+        sy+=v->srcy;
+        if (sx<0) sx=0; else if (sx>=src->w) sx=src->w-1;
+        if (sy<0) sy=0; else if (sy>=src->h) sy=src->h-1;
+        memcpy(tp,src->softv+((sy*src->w+sx)<<2),4);
+      }
+      render_soft_put_row(render,dstrow,tmp,colc);
+    }
+  }
+}
+
+/* Tiles.
+ * Square tiles (src->w/16), centered on (dstx,dsty).
+ */
+
+void render_soft_draw_tile(struct render *render,struct render_texture *dst,struct render_texture *src,const struct egg_draw_tile *v,int c) {
+  if (!dst->softv||!src->softv) return;
+  int ts=src->w>>4;
+  if ((ts<1)||(ts*16>src->h)) return;
+  uint8_t *tmp=render_soft_row(render,ts);
+  if (!tmp) return;
+  for (;c-->0;v++) {
+    int x0=v->dstx-(ts>>1),y0=v->dsty-(ts>>1);
+    int colz=0,colc=ts,rowz=0,rowc=ts;
+    if (x0<0) { colz=-x0; colc+=x0; }
+    if (y0<0) { rowz=-y0; rowc+=y0; }
+    if (x0+ts>dst->w) colc-=x0+ts-dst->w;
+    if (y0+ts>dst->h) rowc-=y0+ts-dst->h;
+    if ((colc<1)||(rowc<1)) continue;
+    int tilex=(v->tileid&15)*ts,tiley=(v->tileid>>4)*ts;
+    int xform=(v->xform<8)?v->xform:0;
+    uint8_t *dstrow=dst->softv+(((y0+rowz)*dst->w+x0+colz)<<2);
+    int j=rowz; for (;j<rowz+rowc;j++,dstrow+=dst->w<<2) {
+      if (!xform) { // Common case: Straight copy of a source row.
+        render_soft_put_row(render,dstrow,src->softv+(((tiley+j)*src->w+tilex+colz)<<2),colc);
+        continue;
+      }
+      uint8_t *tp=tmp;
+      int i=colz; for (;i<colz+colc;i++,tp+=4) {
+        int sx,sy;
+        if (xform&EGG_XFORM_SWAP) { sx=j; sy=i; } else { sx=i; sy=j; }
+        if (xform&EGG_XFORM_XREV) sx=ts-1-sx;
+        if (xform&EGG_XFORM_YREV) sy=ts-1-sy;
+        memcpy(tp,src->softv+(((tiley+sy)*src->w+tilex+sx)<<2),4);
+      }
+      render_soft_put_row(render,dstrow,tmp,colc);
+    }
+  }
+}
+
+/* Mode7.
+ * The quad is a parallelogram, so one affine map covers it. Walk its bounds and map each pixel center back to the source.
+ */
+
+void render_soft_draw_mode7(struct render *render,struct render_texture *dst,struct render_texture *src,const struct egg_draw_mode7 *v,int c) {
+  if (!dst->softv||!src->softv) return;
+  for (;c-->0;v++) {
+    double cost=cos(-v->rotate);
+    double sint=sin(-v->rotate);
+    double halfw=v->w*v->xscale*0.5;
+    double halfh=v->h*v->yscale*0.5;
+    int nwx=lround( cost*halfw+sint*halfh);
+    int nwy=lround(-sint*halfw+cost*halfh);
+    int swx=lround( cost*halfw-sint*halfh);
+    int swy=lround(-sint*halfw-cost*halfh);
+    // Origin at tex(0,0), U toward tex(1,0), V toward tex(0,1).
+    double ox=v->dstx-nwx,oy=v->dsty-nwy;
+    double ux=swx+nwx,uy=swy+nwy;
+    double vx=nwx-swx,vy=nwy-swy;
+    double det=ux*vy-uy*vx;
+    if ((det>-0.0001)&&(det<0.0001)) continue;
+    int x0=v->dstx-((nwx<0)?-nwx:nwx),x1=v->dstx+((nwx<0)?-nwx:nwx);
+    int y0=v->dsty-((nwy<0)?-nwy:nwy),y1=v->dsty+((nwy<0)?-nwy:nwy);
+    int ax=(swx<0)?-swx:swx,ay=(swy<0)?-swy:swy;
+    if (v->dstx-ax<x0) x0=v->dstx-ax;
+    if (v->dstx+ax>x1) x1=v->dstx+ax;
+    if (v->dsty-ay<y0) y0=v->dsty-ay;
+    if (v->dsty+ay>y1) y1=v->dsty+ay;
+    if (x0<0) x0=0;
+    if (y0<0) y0=0;
+    if (x1>dst->w) x1=dst->w;
+    if (y1>dst->h) y1=dst->h;
+    if ((x0>=x1)||(y0>=y1)) continue;
+    uint8_t *tmp=render_soft_row(render,x1-x0);
+    if (!tmp) return;
+    uint8_t *dstrow=dst->softv+((y0*dst->w+x0)<<2);
+    int y=y0; for (;y<y1;y++,dstrow+=dst->w<<2) {
+      uint8_t *tp=tmp;
+      int x=x0; for (;x<x1;x++,tp+=4) {
+        double px=x+0.5-ox,py=y+0.5-oy;
+        double s=(px*vy-py*vx)/det;
+        double t=(ux*py-uy*px)/det;
+        if ((s<0.0)||(t<0.0)||(s>=1.0)||(t>=1.0)) {
+          tp[3]=0;
+          continue;
+        }
+        int sx=v->srcx+(int)(s*v->w);
+        int sy=v->srcy+(int)(t*v->h);
+        if ((sx<0)||(sy<0)||(sx>=src->w)||(sy>=src->h)) {
+          tp[3]=0;
+          continue;
+        }
+        memcpy(tp,src->softv+((sy*src->w+sx)<<2),4);
+      }
+      render_soft_put_row(render,dstrow,tmp,x1-x0);
+    }
+  }
+}
+
+/* Main output.
+ * Same geometry as the GL version, and no blending.
+ */
+
+void render_soft_draw_to_main(struct render *render,int mainw,int mainh,struct render_texture *texture,int dstx,int dsty,int w,int h) {
+  if (!texture->softv||(mainw<1)||(mainh<1)) return;
+  if ((mainw!=render->mainw)||(mainh!=render->mainh)) {
+    if (mainw>INT_MAX/4/mainh) return;
+    void *nv=realloc(render->mainv,(mainw*mainh)<<2);
+    if (!nv) return;
+    render->mainv=nv;
+    render->mainw=mainw;
+    render->mainh=mainh;
+  }
+  if ((w<mainw)||(h<mainh)) {
+    uint32_t black,*p=(uint32_t*)render->mainv;
+    memcpy(&black,"\0\0\0\xff",4);
+    int i=mainw*mainh; for (;i-->0;p++) *p=black;
+  }
+  int colz=0,colc=w,rowz=0,rowc=h;
+  if (dstx<0) { colz=-dstx; colc+=dstx; }
+  if (dsty<0) { rowz=-dsty; rowc+=dsty; }
+  if (dstx+w>mainw) colc-=dstx+w-mainw;
+  if (dsty+h>mainh) rowc-=dsty+h-mainh;
+  if ((colc<1)||(rowc<1)) return;
+  // Source column for each output column, computed once. Consecutive output rows from the same source row are a straight copy.
+  int *colv=(int*)render_soft_row(render,colc);
+  if (!colv) return;
+  int i=0; for (;i<colc;i++) colv[i]=((colz+i)*texture->w)/w;
+  uint32_t *dstrow=(uint32_t*)render->mainv+(dsty+rowz)*mainw+dstx+colz;
+  const uint32_t *srcv=(const uint32_t*)texture->softv;
+  int prevsrcy=-1;
+  int j=rowz; for (;j<rowz+rowc;j++,dstrow+=mainw) {
+    int srcy=(j*texture->h)/h;
+    if (srcy==prevsrcy) {
+      memcpy(dstrow,dstrow-mainw,colc<<2);
+      continue;
+    }
+    prevsrcy=srcy;
+    const uint32_t *srcrow=srcv+srcy*texture->w;
+    if (w==texture->w) {
+      memcpy(dstrow,srcrow+colz,colc<<2);
+    } else {
+      for (i=0;i<colc;i++) dstrow[i]=srcrow[colv[i]];
+    }
+  }
+}
+
+/* New software renderer.
+ */
+
+struct render *render_new_soft() {
+  struct render *render=calloc(1,sizeof(struct render));
+  if (!render) return 0;
+  render->soft=1;
+  render->alpha=0xff;
+  return render;
+}
+
+/* Main output, public.
+ */
+
+const void *render_get_main(int *w,int *h,const struct render *render) {
+  if (!render->mainv) return 0;
+  if (w) *w=render->mainw;
+  if (h) *h=render->mainh;
+  return render->mainv;
+}
@@ -85,6 +85,169 @@ struct rom_res *rom_reader_next(struct rom_reader *reader) {
   #undef FAIL
 }
 
+/* Index.
+ */
+ 
+#define ROM_INDEX_TID(p) (((const int*)(index->v+(p)*index->stride))[0])
+#define ROM_INDEX_RID(p) (((const int*)(index->v+(p)*index->stride))[1])
+ 
+int rom_index_init(struct rom_index *index,const void *v,int c,int stride) {
+  if (!index||(c<0)||(c&&(!v||(stride<(int)sizeof(int)*2)))) return -1;
+  unsigned char *dst=(unsigned char*)index->typev;
+  int i=sizeof(index->typev);
+  while (i-->0) *(dst++)=0;
+  index->v=v;
+  index->c=c;
+  index->stride=stride;
+  int p=0;
+  while (p<c) {
+    int tid=ROM_INDEX_TID(p);
+    if ((tid<0)||(tid>0xff)||index->typev[tid].c) return -1;
+    struct rom_index_type *type=index->typev+tid;
+    type->p=p;
+    type->ridlo=ROM_INDEX_RID(p);
+    int pvrid=type->ridlo;
+    for (p++;(p<c)&&(ROM_INDEX_TID(p)==tid);p++) {
+      int rid=ROM_INDEX_RID(p);
+      if (rid<=pvrid) return -1;
+      pvrid=rid;
+    }
+    type->c=p-type->p;
+    type->dense=(pvrid-type->ridlo==type->c-1);
+  }
+  return 0;
+}
+
+int rom_index_search(const struct rom_index *index,int tid,int rid) {
+  if ((tid<0)||(tid>0xff)) return -1;
+  const struct rom_index_type *type=index->typev+tid;
+  if (!type->c) {
+    // Absent type: Insertion point is after the nearest lower tid that's present.
+    while (--tid>=0) {
+      type=index->typev+tid;
+      if (type->c) return -(type->p+type->c)-1;
+    }
+    return -1;
+  }
+  int d=rid-type->ridlo;
+  if (d<0) return -type->p-1;
+  if (type->dense) {
+    if (d<type->c) return type->p+d;
+    return -(type->p+type->c)-1;
+  }
+  int lo=type->p,hi=type->p+type->c;
+  while (lo<hi) {
+    int ck=(lo+hi)>>1;
+    int q=ROM_INDEX_RID(ck);
+         if (rid<q) hi=ck;
+    else if (rid>q) lo=ck+1;
+    else return ck;
+  }
+  return -lo-1;
+}
+
+#undef ROM_INDEX_TID
+#undef ROM_INDEX_RID
+
+/* TOC.
+ */
+ 
+static int rom_toc_u16(const unsigned char *v) {
+  return (v[0]<<8)|v[1];
+}
+
+static int rom_toc_u32(const unsigned char *v) {
+  unsigned int n=(v[0]<<24)|(v[1]<<16)|(v[2]<<8)|v[3];
+  if (n>0x7fffffff) return -1;
+  return n;
+}
+ 
+int rom_toc_init(struct rom_toc *toc,const void *src,int srcc) {
+  if (!toc||!src||(srcc<14)) return -1;
+  const unsigned char *SRC=src;
+  const unsigned char *footer=SRC+srcc-8;
+  if ((footer[4]!=0)||(footer[5]!='T')||(footer[6]!='O')||(footer[7]!='C')) return -1;
+  int tocp=rom_toc_u32(footer);
+  if ((tocp<5)||(tocp>srcc-10)||SRC[tocp-1]) return -1; // Must follow the terminator.
+  int typec=rom_toc_u16(SRC+tocp);
+  int typep=tocp+2;
+  if (typep>srcc-8-typec*8) return -1;
+  int recordp=typep+typec*8;
+  int recordc=(srcc-8-recordp)/10;
+  if (recordp+recordc*10!=srcc-8) return -1;
+  // Types must be sorted and their records must be in range. Checking just the last is not enough, they could overlap.
+  int i=0,pvtid=0,nextrecord=0;
+  const unsigned char *type=SRC+typep;
+  for (;i<typec;i++,type+=8) {
+    if (type[0]<=pvtid) return -1;
+    pvtid=type[0];
+    if (rom_toc_u32(type+4)!=nextrecord) return -1;
+    nextrecord+=rom_toc_u16(type+2);
+  }
+  if (nextrecord!=recordc) return -1;
+  for (i=256;i-->0;) toc->typep[i]=0;
+  for (i=0,type=SRC+typep;i<typec;i++,type+=8) toc->typep[type[0]]=i+1;
+  toc->src=SRC;
+  toc->srcc=srcc;
+  toc->tocp=tocp;
+  toc->typev=SRC+typep;
+  toc->typec=typec;
+  toc->recordv=SRC+recordp;
+  toc->recordc=recordc;
+  return 0;
+}
+
+static const unsigned char *rom_toc_find_type(int *resc,const struct rom_toc *toc,int tid) {
+  if ((tid<0)||(tid>0xff)||!toc->typep[tid]) return 0;
+  const unsigned char *type=toc->typev+(toc->typep[tid]-1)*8;
+  *resc=rom_toc_u16(type+2);
+  return toc->recordv+rom_toc_u32(type+4)*10;
+}
+
+static int rom_toc_populate(struct rom_res *dst,const struct rom_toc *toc,int tid,const unsigned char *record) {
+  int p=rom_toc_u32(record+2);
+  int c=rom_toc_u32(record+6);
+  if ((p<4)||(c<1)||(p>toc->tocp-c)) return 0;
+  dst->tid=tid;
+  dst->rid=rom_toc_u16(record);
+  dst->v=toc->src+p;
+  dst->c=c;
+  return 1;
+}
+
+int rom_toc_get(struct rom_res *dst,const struct rom_toc *toc,int tid,int rid) {
+  int resc=0;
+  const unsigned char *recordv=rom_toc_find_type(&resc,toc,tid);
+  if (!recordv||!resc) return 0;
+  // Contiguous rids, which is the usual case, we can index directly.
+  int ridlo=rom_toc_u16(recordv);
+  int d=rid-ridlo;
+  if ((d<0)||(d>0xffff)) return 0;
+  if (rom_toc_u16(recordv+(resc-1)*10)-ridlo==resc-1) {
+    if (d>=resc) return 0;
+    const unsigned char *record=recordv+d*10;
+    if (rom_toc_u16(record)!=rid) return 0; // Records were out of order. Malformed, but don't return the wrong one.
+    return rom_toc_populate(dst,toc,tid,record);
+  }
+  int lo=0,hi=resc;
+  while (lo<hi) {
+    int ck=(lo+hi)>>1;
+    const unsigned char *record=recordv+ck*10;
+    int ckrid=rom_toc_u16(record);
+         if (rid<ckrid) hi=ck;
+    else if (rid>ckrid) lo=ck+1;
+    else return rom_toc_populate(dst,toc,tid,record);
+  }
+  return 0;
+}
+
+int rom_toc_get_by_index(struct rom_res *dst,const struct rom_toc *toc,int tid,int p) {
+  int resc=0;
+  const unsigned char *recordv=rom_toc_find_type(&resc,toc,tid);
+  if (!recordv||(p<0)||(p>=resc)) return 0;
+  return rom_toc_populate(dst,toc,tid,recordv+p*10);
+}
+
 /* Read strings resource.
  */
  
@@ -37,6 +37,66 @@ int rom_reader_init(struct rom_reader *reader,const void *src,int srcc);
  */
 struct rom_res *rom_reader_next(struct rom_reader *reader);
 
+/* Index over a list of resources sorted by (tid,rid), for O(1) lookup.
+ * The list can be anything whose elements begin with (int tid,rid), eg struct rom_res.
+ * Per tid, we record the range in the list. If rids in that range are contiguous, which they usually are,
+ * position is just arithmetic. Otherwise we binary-search that type's range.
+ * Index doesn't own the list. If you modify the list, rom_index_init() again.
+ *****************************************************************************/
+
+struct rom_index {
+  const unsigned char *v;
+  int c,stride;
+  struct rom_index_type {
+    int p,c; // Range in (v). (c) zero if absent.
+    int ridlo; // rid at (p).
+    int dense; // Nonzero if rids are exactly (ridlo..ridlo+c-1).
+  } typev[256];
+};
+
+/* Walks the list once. Elements must be sorted by (tid,rid), and tids must be in 0..255.
+ * Fails if not sorted. Never fails for struct rom_res from rom_reader.
+ */
+int rom_index_init(struct rom_index *index,const void *v,int c,int stride);
+
+/* Position in the list, or -p-1 where it would go, like a typical binary search.
+ */
+int rom_index_search(const struct rom_index *index,int tid,int rid);
+
+/* Optional TOC.
+ * eggdev appends this after the ROM's terminator, where generic readers never look.
+ * It lets us find any resource without reading the ones before it, eg in a memory-mapped file.
+ *   u16 typec
+ *   typec * 8: u8 tid, u8 zero, u16 resc, u32 first record index. Sorted by tid.
+ *   records * 10: u16 rid, u32 offset from ROM start, u32 length. Sorted by rid within each type.
+ *   u32 TOC offset from ROM start. Must immediately follow the terminator.
+ *   "\0TOC"
+ * All integers are big-endian.
+ * rom_toc_init() is O(typec). It validates the layout but not individual records; the getters do that.
+ * Lookup is O(1) for types with contiguous rids, otherwise a binary search within the type.
+ *****************************************************************************/
+
+struct rom_toc {
+  const unsigned char *src; // The entire ROM.
+  int srcc;
+  int tocp; // Start of TOC in (src), also the limit for resource payloads.
+  const unsigned char *typev;
+  int typec;
+  const unsigned char *recordv;
+  int recordc;
+  unsigned char typep[256]; // Index in (typev) plus one, by tid, or zero if absent.
+};
+
+/* <0 if there's no valid TOC. Like rom_reader, (src) must stay put while you use it.
+ */
+int rom_toc_init(struct rom_toc *toc,const void *src,int srcc);
+
+/* Find one resource, by ID or by position within its type.
+ * Return >0 and populate (dst) if found, 0 if not found or invalid.
+ */
+int rom_toc_get(struct rom_res *dst,const struct rom_toc *toc,int tid,int rid);
+int rom_toc_get_by_index(struct rom_res *dst,const struct rom_toc *toc,int tid,int p);
+
 /* Support for standard resource types.
  ******************************************************************************/
 
@@ -24,6 +24,61 @@ void synth_emit_full_volume(struct synth *synth);
  */
 void synth_neuter(struct synth *synth);
 
+/* Print EGS sounds and drums on (threadc) background threads, instead of during update.
+ * Call once, right after construction. Sounds that aren't ready yet play silence until they are.
+ * Without this, each sound prints during update the first time it's played.
+ */
+int synth_start_printers(struct synth *synth,int threadc);
+
+/* Queue every installed EGS sound, and every EGS drum in installed songs, for printing now, instead of waiting for its first play.
+ * Call after installing everything. Then starting songs and playing sounds won't allocate print jobs on the audio thread.
+ * Drums print once here and are shared by every play of their song.
+ * Noop if background printers are not running.
+ */
+void synth_preprint_sounds(struct synth *synth);
+
+/* What to do when a new voice wants to start and SYNTH_VOICE_LIMIT are already running.
+ * Pick one of REJECT, OLDEST, QUIETEST, optionally with SONG_FIRST.
+ * Released voices are preferred over held ones, in both OLDEST and QUIETEST.
+ * SONG_FIRST: Sound effects steal song voices before other sound effects, and song notes may only steal song voices.
+ * Stolen voices don't cut off dead; they ramp to silence over a few milliseconds, alongside their replacement.
+ * Default is QUIETEST|SONG_FIRST.
+ */
+#define SYNTH_STEAL_REJECT     0x00 /* Drop the new voice. */
+#define SYNTH_STEAL_OLDEST     0x01
+#define SYNTH_STEAL_QUIETEST   0x02
+#define SYNTH_STEAL_SONG_FIRST 0x10
+void synth_set_steal_policy(struct synth *synth,int policy);
+
+/* Running totals since construction, of voices cut to make room, and new voices dropped for lack of room.
+ * Either may be null.
+ */
+void synth_get_voice_stats(const struct synth *synth,int *stolen,int *rejected);
+
+/* Audio-thread profiler.
+ * Off by default. Once enabled, every synth_updatef or synth_updatei call is timed against the duration of its buffer.
+ * "load" is render time over buffer time; at 1.0 or above the driver is likely to underrun.
+ * Histograms have SYNTH_PROFILE_BUCKETS entries:
+ *   loadv: Tenths of the buffer's duration. The last bucket is everything 1.0 and above.
+ *   voicev: Live voices at the start of each update, in tenths of the voice limit. The last bucket is "full".
+ *   printerv: Printers running at the start of each update, exact, and the last bucket is that many or more.
+ * synth_get_profile returns null if not enabled. It's written by the audio thread; stop or lock the driver before reading.
+ */
+#define SYNTH_PROFILE_BUCKETS 11
+struct synth_profile {
+  int updatec;
+  int64_t framec;
+  double render; // s, total
+  double render_max; // s, worst single update
+  double load_max;
+  int underrunc; // Updates with load>=1.0.
+  int loadv[SYNTH_PROFILE_BUCKETS];
+  int voicev[SYNTH_PROFILE_BUCKETS];
+  int printerv[SYNTH_PROFILE_BUCKETS];
+};
+int synth_enable_profile(struct synth *synth);
+const struct synth_profile *synth_get_profile(const struct synth *synth);
+
 /* Add some artificial delay to the song, wherever it currently is.
  * We might use this at startup because some hosts have a nasty habit of dropping the first quarter-second or so of output.
  */
@@ -48,8 +103,31 @@ void synth_event(struct synth *synth,uint8_t chid,uint8_t opcode,uint8_t a,uint8
 void synth_play_song_handoff(struct synth *synth,void *src,int srcc,int repeat);
 void synth_play_song_borrow(struct synth *synth,const void *src,int srcc,int repeat);
 
+/* Thread-safe alternatives to play_sound, play_song, event, and set_playhead.
+ * One producer thread may call these without holding the audio lock.
+ * Commands take effect at the start of the next update, in the order you queue them.
+ * Fails if the queue is full. In that case, lock, synth_flush_commands(), then call the direct version.
+ */
+int synth_queue_sound(struct synth *synth,int rid);
+int synth_queue_song(struct synth *synth,int rid,int force,int repeat);
+int synth_queue_event(struct synth *synth,uint8_t chid,uint8_t opcode,uint8_t a,uint8_t b,int durms);
+int synth_queue_playhead(struct synth *synth,double s);
+
+/* Apply all queued commands now.
+ * Update does this for you; call it directly only if you're holding the audio lock.
+ */
+void synth_flush_commands(struct synth *synth);
+
+/* Current song and playhead reflect only commands already applied.
+ * After queueing a song or playhead change, they lag by up to one update.
+ */
 int synth_get_song(const struct synth *synth);
 double synth_get_playhead(struct synth *synth);
 void synth_set_playhead(struct synth *synth,double s);
 
+/* Most voices that have been running at once since construction.
+ * For diagnostics; eggdev reports it.
+ */
+int synth_get_voice_high_water(const struct synth *synth);
+
 #endif
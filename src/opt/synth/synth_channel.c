@@ -9,6 +9,7 @@ void synth_channel_cleanup(struct synth_channel *channel) {
     int i=128;
     for (;i-->0;drum++) {
       if (drum->pcm) synth_pcm_del(drum->pcm);
+      if (drum->job) synth_print_job_del(drum->job);
     }
     free(channel->drumv);
   }
@@ -37,6 +38,10 @@ static int synth_channel_decode_DRUM(struct synth_channel *channel,struct synth
       drum->trimhi=trimhi/255.0f;
       drum->src=src+srcp;
       drum->srcc=len;
+      // With background printers, start them all now, usually already started by synth_preprint_sounds. Otherwise wait for first play.
+      if (synth->workers&&(len>=4)&&!memcmp(drum->src,"\0EGS",4)) {
+        synth_init_drum_pcm(&drum->pcm,&drum->job,synth,drum->src,drum->srcc);
+      }
     }
     srcp+=len;
   }
@@ -52,8 +57,8 @@ static struct synth_voice *synth_channel_play_note_DRUM(struct synth_channel *ch
     }
     return 0;
   }
-  if (!drum->pcm) {
-    if (!(drum->pcm=synth_init_pcm(synth,drum->src,drum->srcc))) {
+  if (!drum->pcm&&!drum->job) {
+    if (synth_init_pcm(&drum->pcm,&drum->job,synth,drum->src,drum->srcc)<0) {
       if (!drum->warned) {
         drum->warned=1;
         fprintf(stderr,"WARNING: Channel %d, drum 0x%02x, failed to decode %d bytes.\n",channel->chid,noteid,drum->srcc);
@@ -63,7 +68,10 @@ static struct synth_voice *synth_channel_play_note_DRUM(struct synth_channel *ch
   }
   float trim=drum->trimlo*(1.0f-velocity)+drum->trimhi*velocity;
   trim*=channel->trim;
-  return synth_voice_pcm_new(synth,drum->pcm,trim);
+  int err=synth_resolve_pcm(&drum->pcm,&drum->job);
+  if (err>0) return synth_voice_pcm_new(synth,drum->pcm,trim);
+  if (!err) return synth_voice_pcm_new_job(synth,drum->job,trim);
+  return 0;
 }
 
 /* WAVE.
@@ -14,10 +14,12 @@ struct synth_channel {
   uint8_t chid;
   uint8_t mode;
   float trim;
+  float pan; // -1..1. Only changes via Control Change 0x0a; songs reset it to center.
   
   struct synth_drum {
     float trimlo,trimhi;
     struct synth_pcm *pcm; // STRONG
+    struct synth_print_job *job; // STRONG. Pending (pcm), if printing in the background.
     const void *src; // WEAK
     int srcc;
     int warned;
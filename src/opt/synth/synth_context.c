@@ -5,13 +5,22 @@
  
 static void synth_res_cleanup(struct synth_res *res) {
   if (res->pcm) synth_pcm_del(res->pcm);
+  if (res->job) synth_print_job_del(res->job);
+  if (res->seekv) free(res->seekv);
+}
+
+static void synth_drumprint_cleanup(struct synth_drumprint *drumprint) {
+  if (drumprint->pcm) synth_pcm_del(drumprint->pcm);
+  if (drumprint->job) synth_print_job_del(drumprint->job);
 }
  
 void synth_del(struct synth *synth) {
   if (!synth) return;
+  synth_workers_del(synth->workers);
   if (synth->qbuf) free(synth->qbuf);
   if (synth->sine) free(synth->sine);
   while (synth->voicec-->0) synth_voice_del(synth->voicev[synth->voicec]);
+  if (synth->voicepool) free(synth->voicepool);
   if (synth->printerv) {
     while (synth->printerc-->0) synth_printer_del(synth->printerv[synth->printerc]);
     free(synth->printerv);
@@ -20,8 +29,14 @@ void synth_del(struct synth *synth) {
     while (synth->resc-->0) synth_res_cleanup(synth->resv+synth->resc);
     free(synth->resv);
   }
+  if (synth->drumprintv) {
+    while (synth->drumprintc-->0) synth_drumprint_cleanup(synth->drumprintv+synth->drumprintc);
+    free(synth->drumprintv);
+  }
   while (synth->channelc-->0) synth_channel_cleanup(synth->channelv+synth->channelc);
   if (synth->songown) free(synth->songown);
+  if (synth->seekown) free(synth->seekown);
+  if (synth->profile) free(synth->profile);
   free(synth);
 }
 
@@ -58,6 +73,27 @@ struct synth *synth_new(int rate,int chanc) {
   synth->framesperms=(double)rate/1000.0;
   synth_generate_rates(synth);
   synth->global_trim=0.333f;
+  synth->noise=0x12345678;
+  synth->steal_policy=SYNTH_STEAL_QUIETEST|SYNTH_STEAL_SONG_FIRST;
+  
+  /* Allocate everything the update path needs, so it never has to.
+   * Voice slots go on the free stack backward, so they come out in address order.
+   */
+  if (!(synth->voicepool=malloc(SYNTH_VOICE_SIZE_LIMIT*SYNTH_VOICE_LIMIT))) {
+    synth_del(synth);
+    return 0;
+  }
+  int i=SYNTH_VOICE_LIMIT;
+  while (i-->0) synth->voicefreev[synth->voicefreec++]=(char*)synth->voicepool+i*SYNTH_VOICE_SIZE_LIMIT;
+  synth->qbufa=1024*chanc; // Arbitrary, but must be a multiple of (chanc).
+  if (!(synth->qbuf=malloc(sizeof(float)*synth->qbufa))) {
+    synth_del(synth);
+    return 0;
+  }
+  if (synth_require_sine(synth)<0) {
+    synth_del(synth);
+    return 0;
+  }
   
   return synth;
 }
@@ -73,6 +109,24 @@ void synth_neuter(struct synth *synth) {
   synth->neuter=1;
 }
 
+void synth_set_steal_policy(struct synth *synth,int policy) {
+  synth->steal_policy=policy;
+}
+
+void synth_get_voice_stats(const struct synth *synth,int *stolen,int *rejected) {
+  if (stolen) *stolen=synth->stolenc;
+  if (rejected) *rejected=synth->rejectedc;
+}
+
+/* Start background printers.
+ */
+ 
+int synth_start_printers(struct synth *synth,int threadc) {
+  if (synth->workers) return -1;
+  if (!(synth->workers=synth_workers_new(threadc))) return -1;
+  return 0;
+}
+
 /* End current song.
  */
  
@@ -98,6 +152,12 @@ static void synth_end_song(struct synth *synth) {
     free(synth->songown);
     synth->songown=0;
   }
+  if (synth->seekown) {
+    free(synth->seekown);
+    synth->seekown=0;
+  }
+  synth->seekv=0;
+  synth->seekc=0;
   synth->songvoice=0;
 }
 
@@ -222,23 +282,178 @@ static void synth_update_printers(struct synth *synth,int c) {
   }
 }
 
+/* Drop a finished voice.
+ */
+ 
+static void synth_reap_voice(struct synth *synth,int p) {
+  struct synth_voice *voice=synth->voicev[p];
+  synth->voicev[p]=synth->voicev[--(synth->voicec)];
+  synth_voice_del(voice);
+  if (voice==synth->songvoice) {
+    synth_end_song(synth);
+  }
+}
+
+/* Render the next few frames of a voice we're about to steal, ramping down to silence.
+ * It mixes into the output over the next SYNTH_STEAL_FADE_FRAMES, after the voice itself is gone.
+ */
+ 
+static void synth_steal_fade(struct synth *synth,struct synth_voice *victim) {
+  float tmp[SYNTH_STEAL_FADE_FRAMES]={0};
+  victim->update(tmp,SYNTH_STEAL_FADE_FRAMES,victim);
+  int remc=synth->stealc-synth->stealp; // Unplayed tail of an earlier steal; shift it to the front.
+  if (remc&&synth->stealp) {
+    memmove(synth->steall,synth->steall+synth->stealp,sizeof(float)*remc);
+    memmove(synth->stealr,synth->stealr+synth->stealp,sizeof(float)*remc);
+  }
+  memset(synth->steall+remc,0,sizeof(float)*(SYNTH_STEAL_FADE_FRAMES-remc));
+  memset(synth->stealr+remc,0,sizeof(float)*(SYNTH_STEAL_FADE_FRAMES-remc));
+  synth->stealp=0;
+  synth->stealc=SYNTH_STEAL_FADE_FRAMES;
+  float l=1.0f,r=1.0f;
+  if (synth->chanc>1) {
+    if (victim->pan>0.0f) l=1.0f-victim->pan;
+    else if (victim->pan<0.0f) r=1.0f+victim->pan;
+  }
+  float level=1.0f,dlevel=-1.0f/SYNTH_STEAL_FADE_FRAMES;
+  int i=0; for (;i<SYNTH_STEAL_FADE_FRAMES;i++,level+=dlevel) {
+    float sample=tmp[i]*level;
+    synth->steall[i]+=sample*l;
+    synth->stealr[i]+=sample*r;
+  }
+}
+
+/* Add pending stolen-voice tails to the output, mono or interleaved stereo.
+ */
+ 
+static void synth_mix_steal_tails(float *v,int c,int stereo,struct synth *synth) {
+  int cpc=synth->stealc-synth->stealp;
+  if (cpc<=0) return;
+  if (cpc>c) cpc=c;
+  const float *l=synth->steall+synth->stealp;
+  if (stereo) {
+    const float *r=synth->stealr+synth->stealp;
+    int i=cpc; for (;i-->0;v+=2,l++,r++) { v[0]+=*l; v[1]+=*r; }
+  } else {
+    int i=cpc; for (;i-->0;v++,l++) (*v)+=*l;
+  }
+  if ((synth->stealp+=cpc)>=synth->stealc) synth->stealp=synth->stealc=0;
+}
+
+/* Kill a voice to free its pool slot, if policy allows.
+ * synth_voice_new calls this when the pool is empty, ie only once the new voice is otherwise ready to go.
+ * If an update is in progress, the new voice belongs to the song. Same cheap hack as synth_event.
+ * Returns <0 if nothing was stolen, and caller should drop the new voice.
+ */
+ 
+int synth_steal_voice(struct synth *synth) {
+  int song=synth->preprintc?1:0;
+  int policy=synth->steal_policy&0x0f;
+  if (policy==SYNTH_STEAL_REJECT) {
+    synth->rejectedc++;
+    return -1;
+  }
+  int songfirst=synth->steal_policy&SYNTH_STEAL_SONG_FIRST;
+  int bestp=-1,bestclass=0,bestreleased=0;
+  float bestlevel=0.0f;
+  unsigned int bestserial=0;
+  int i=synth->voicec;
+  while (i-->0) {
+    struct synth_voice *voice=synth->voicev[i];
+    if (voice==synth->songvoice) continue; // Never steal a PCM song; it would end the song.
+    int class=0;
+    if (songfirst) {
+      if (!voice->song) {
+        if (song) continue;
+        class=1;
+      }
+    }
+    int released=0;
+    float level=voice->get_level(voice,&released);
+    released=released?1:0;
+    if (bestp>=0) {
+      if (class>bestclass) continue;
+      if (class==bestclass) {
+        if (released<bestreleased) continue;
+        if (released==bestreleased) {
+          if (policy==SYNTH_STEAL_QUIETEST) {
+            if (level>bestlevel) continue;
+            if ((level==bestlevel)&&(voice->serial-bestserial<0x80000000)) continue;
+          } else {
+            if (voice->serial-bestserial<0x80000000) continue; // Newer, with wraparound.
+          }
+        }
+      }
+    }
+    bestp=i;
+    bestclass=class;
+    bestreleased=released;
+    bestlevel=level;
+    bestserial=voice->serial;
+  }
+  if (bestp<0) {
+    synth->rejectedc++;
+    return -1;
+  }
+  struct synth_voice *victim=synth->voicev[bestp];
+  synth->voicev[bestp]=synth->voicev[--(synth->voicec)];
+  synth_steal_fade(synth,victim);
+  synth_voice_del(victim);
+  synth->stolenc++;
+  return 0;
+}
+
 /* Update, float, single pass.
  * (v) must be zeroed first.
  */
  
 static void synth_update_signal(float *v,int c,struct synth *synth) {
+  if (synth->voicec>synth->voicec_hi) synth->voicec_hi=synth->voicec;
   int i=synth->voicec;
   while (i-->0) {
     struct synth_voice *voice=synth->voicev[i];
     voice->update(v,c,voice);
-    if (voice->finished) {
-      synth->voicec--;
-      memmove(synth->voicev+i,synth->voicev+i+1,sizeof(void*)*(synth->voicec-i));
-      synth_voice_del(voice);
-      if (voice==synth->songvoice) {
-        synth_end_song(synth);
+    if (voice->finished) synth_reap_voice(synth,i);
+  }
+  synth_mix_steal_tails(v,c,0,synth);
+}
+
+/* Update, float, single pass, stereo.
+ * Centered voices mix together in mono and get interleaved at the end of each block.
+ * Panned voices render alone and mix straight into the stereo output.
+ * We overwrite (v) blindly. (c) in frames.
+ */
+ 
+static void synth_update_signal_stereo(float *v,int c,struct synth *synth) {
+  float mono[SYNTH_BLOCK_FRAMES];
+  float tmp[SYNTH_BLOCK_FRAMES];
+  if (synth->voicec>synth->voicec_hi) synth->voicec_hi=synth->voicec;
+  while (c>0) {
+    int updc=(c<SYNTH_BLOCK_FRAMES)?c:SYNTH_BLOCK_FRAMES;
+    memset(mono,0,sizeof(float)*updc);
+    int pannedc=0,i=synth->voicec;
+    while (i-->0) {
+      struct synth_voice *voice=synth->voicev[i];
+      if (voice->pan!=0.0f) { pannedc++; continue; }
+      voice->update(mono,updc,voice);
+      if (voice->finished) synth_reap_voice(synth,i);
+    }
+    synth_mix_interleave(v,mono,updc);
+    if (pannedc) {
+      for (i=synth->voicec;i-->0;) {
+        struct synth_voice *voice=synth->voicev[i];
+        if (voice->pan==0.0f) continue;
+        memset(tmp,0,sizeof(float)*updc);
+        voice->update(tmp,updc,voice);
+        float l=(voice->pan>0.0f)?(1.0f-voice->pan):1.0f;
+        float r=(voice->pan<0.0f)?(1.0f+voice->pan):1.0f;
+        synth_mix_add_pan(v,tmp,l,r,updc);
+        if (voice->finished) synth_reap_voice(synth,i);
       }
     }
+    synth_mix_steal_tails(v,updc,1,synth);
+    v+=updc<<1;
+    c-=updc;
   }
 }
 
@@ -259,6 +474,22 @@ static void synth_updatef_mono(float *v,int c,struct synth *synth) {
   synth->preprintc=0;
 }
 
+/* Update, float, unbound, interleaved stereo.
+ * (c) in frames.
+ */
+ 
+static void synth_updatef_stereo(float *v,int c,struct synth *synth) {
+  synth_update_printers(synth,c);
+  synth->preprintc=c;
+  while (c>0) {
+    int updc=synth_update_song(synth,c);
+    synth_update_signal_stereo(v,updc,synth);
+    v+=updc<<1;
+    c-=updc;
+  }
+  synth->preprintc=0;
+}
+
 /* Update, neutered.
  * We'll advance the song but will not generate a signal (duh: There's nowhere for you to receive it).
  */
@@ -278,8 +509,7 @@ static void synth_update_neuter(struct synth *synth,int framec) {
     struct synth_voice *voice=synth->voicev[i];
     if (voice==synth->songvoice) continue; // This one is ok.
     fprintf(stderr,"%s:%d:WARNING: Voice %p mysteriously appeared in neutered synth.\n",__FILE__,__LINE__,voice);
-    synth->voicec--;
-    memmove(synth->voicev+i,synth->voicev+i+1,sizeof(void*)*(synth->voicec-i));
+    synth->voicev[i]=synth->voicev[--(synth->voicec)];
     synth_voice_del(voice);
   }
 }
@@ -287,26 +517,41 @@ static void synth_update_neuter(struct synth *synth,int framec) {
 /* Update, float, unbound, multi-channel.
  */
 
-void synth_updatef(float *v,int c,struct synth *synth) {
+static void synth_updatef_inner(float *v,int c,struct synth *synth) {
+  synth_flush_commands(synth);
   if (synth->neuter) {
     synth_update_neuter(synth,c/synth->chanc);
     memset(v,0,sizeof(float)*c);
-  } else if (synth->chanc>1) {
+  } else if (synth->chanc==2) {
+    synth_updatef_stereo(v,c>>1,synth);
+  } else if (synth->chanc>2) {
+    // Render stereo at the front, then spread backward: Even channels get left, odd get right.
     int framec=c/synth->chanc;
-    synth_updatef_mono(v,framec,synth);
-    const float *src=v+framec;
-    float *dst=v+c;
+    synth_updatef_stereo(v,framec,synth);
+    const float *src=v+(framec<<1);
+    float *dst=v+framec*synth->chanc;
     int i=framec;
     while (i-->0) {
-      src--;
+      src-=2;
       int ii=synth->chanc;
-      while (ii-->0) *(--dst)=*src;
+      while (ii-->0) *(--dst)=src[ii&1];
     }
   } else {
     synth_updatef_mono(v,c,synth);
   }
 }
 
+void synth_updatef(float *v,int c,struct synth *synth) {
+  if (synth->profile) {
+    double starttime=synth_profile_now();
+    int voicec=synth->voicec,printerc=synth->printerc;
+    synth_updatef_inner(v,c,synth);
+    synth_profile_end(synth,starttime,c/synth->chanc,voicec,printerc);
+  } else {
+    synth_updatef_inner(v,c,synth);
+  }
+}
+
 /* Float to int.
  */
  
@@ -322,46 +567,43 @@ static void synth_quantize(int16_t *dst,const float *src,int c) {
  */
  
 void synth_updatei(int16_t *v,int c,struct synth *synth) {
+  double starttime=synth->profile?synth_profile_now():0.0;
+  int voicec=synth->voicec,printerc=synth->printerc,framec=c/synth->chanc;
+  synth_flush_commands(synth);
   if (synth->neuter) {
-    synth_update_neuter(synth,c/synth->chanc);
+    synth_update_neuter(synth,framec);
     memset(v,0,c<<1);
-    return;
-  }
-
-  /* Acquire qbuf if we don't have it yet.
-   * Arbitrary size limit here, we can change to whatever but it must be a multiple of (chanc).
-   */
-  if (!synth->qbufa) {
-    int framec=1024;
-    int samplec=framec*synth->chanc;
-    if (!(synth->qbuf=malloc(sizeof(float)*samplec))) {
-      memset(v,0,c<<1);
-      return;
-    }
-    synth->qbufa=samplec;
-  }
+  } else {
   
-  /* Update into (qbuf), then quantize into (v).
-   */
-  while (c>0) {
-    int updc=synth->qbufa;
-    if (updc>c) updc=c;
-    synth_updatef(synth->qbuf,updc,synth);
-    synth_quantize(v,synth->qbuf,updc);
-    v+=updc;
-    c-=updc;
+    /* Update into (qbuf), then quantize into (v).
+     */
+    while (c>0) {
+      int updc=synth->qbufa;
+      if (updc>c) updc=c;
+      synth_updatef_inner(synth->qbuf,updc,synth);
+      synth_quantize(v,synth->qbuf,updc);
+      v+=updc;
+      c-=updc;
+    }
   }
+  if (synth->profile) synth_profile_end(synth,starttime,framec,voicec,printerc);
 }
 
 /* Resource list primitives.
  */
  
-static int synth_resv_search(const struct synth *synth,int tid,int rid) {
+static int synth_resv_search(struct synth *synth,int tid,int rid) {
   if (synth->resc) { // "Absent and belonging at the back" comes up often during init and would otherwise be worst-case for the search.
     const struct synth_res *q=synth->resv+synth->resc-1;
     if (tid>q->tid) return -synth->resc-1;
     if ((tid==q->tid)&&(rid>q->rid)) return -synth->resc-1;
   }
+  if (!synth->resindex_valid) {
+    if (rom_index_init(&synth->resindex,synth->resv,synth->resc,sizeof(struct synth_res))>=0) synth->resindex_valid=1;
+    else synth->resindex_valid=-1; // Don't retry until the list changes.
+  }
+  if (synth->resindex_valid>0) return rom_index_search(&synth->resindex,tid,rid);
+  // Index refused the list. It's still sorted, so a plain binary search gives the same answer, just slower.
   int lo=0,hi=synth->resc;
   while (lo<hi) {
     int ck=(lo+hi)>>1;
@@ -388,6 +630,7 @@ static struct synth_res *synth_resv_insert(struct synth *synth,int p,int tid,int
   struct synth_res *res=synth->resv+p;
   memmove(res+1,res,sizeof(struct synth_res)*(synth->resc-p));
   synth->resc++;
+  synth->resindex_valid=0;
   memset(res,0,sizeof(struct synth_res));
   res->tid=tid;
   res->rid=rid;
@@ -396,6 +639,77 @@ static struct synth_res *synth_resv_insert(struct synth *synth,int p,int tid,int
   return res;
 }
 
+/* Locate the events in an EGS song, or <0 if it's not EGS or malformed.
+ */
+ 
+static int synth_song_events_start(const void *src,int srcc) {
+  if (!src||(srcc<4)||memcmp(src,"\0EGS",4)) return -1;
+  const uint8_t *SRC=src;
+  int srcp=4;
+  while (srcp<srcc) {
+    if (SRC[srcp]==0xff) return srcp+1;
+    if (srcp>srcc-6) return -1;
+    int bodylen=(SRC[srcp+3]<<16)|(SRC[srcp+4]<<8)|SRC[srcp+5];
+    srcp+=6;
+    if (srcp>srcc-bodylen) return -1;
+    srcp+=bodylen;
+  }
+  return -1;
+}
+
+/* Build a seek index for some song events.
+ * Checkpoints go at the start of an event group, right after the delay leading into it.
+ * Frames are reckoned exactly as synth_update_song does, rounding each run of delays as a unit.
+ * We stop quietly at EOF or anything malformed; synth_update_song will deal with that when it gets there.
+ * Returns the checkpoint count, and (*dstpp) is STRONG if nonzero.
+ */
+ 
+static int synth_seek_index(struct synth_seek **dstpp,const uint8_t *src,int srcc,double framesperms) {
+  *dstpp=0;
+  struct synth_seek *v=0;
+  int c=0,a=0;
+  int interval=lround(framesperms*SYNTH_SEEK_INTERVAL_MS);
+  int srcp=0,playhead=0,next=0;
+  while (srcp<srcc) {
+  
+    if (playhead>=next) {
+      if (c>=a) {
+        int na=a+32;
+        if (na>INT_MAX/sizeof(struct synth_seek)) break;
+        void *nv=realloc(v,sizeof(struct synth_seek)*na);
+        if (!nv) break;
+        v=nv;
+        a=na;
+      }
+      v[c++]=(struct synth_seek){playhead,srcp};
+      next=playhead+interval;
+    }
+    
+    while ((srcp<srcc)&&(src[srcp]&0x80)) {
+      switch (src[srcp]&0xf0) {
+        case 0x80: case 0x90: case 0xa0: srcp+=3; break;
+        default: srcc=0;
+      }
+    }
+    if (srcp>srcc) break;
+    
+    int delay=0;
+    while ((srcp<srcc)&&!(src[srcp]&0x80)) {
+      int d=src[srcp++];
+      if (!d) { srcc=0; break; }
+      if (d&0x40) d=((d&0x3f)+1)*64;
+      delay+=d;
+    }
+    playhead+=lround(delay*framesperms);
+  }
+  if (!c&&v) {
+    free(v);
+    v=0;
+  }
+  *dstpp=v;
+  return c;
+}
+
 /* Install sound or song, public.
  */
 
@@ -412,7 +726,11 @@ int synth_install_song(struct synth *synth,int rid,const void *src,int srcc) {
   int p=synth_resv_search(synth,EGG_TID_song,rid);
   if (p>=0) return -1;
   p=-p-1;
-  if (!synth_resv_insert(synth,p,EGG_TID_song,rid,src,srcc)) return -1;
+  struct synth_res *res=synth_resv_insert(synth,p,EGG_TID_song,rid,src,srcc);
+  if (!res) return -1;
+  // Seek index is optional. If it fails, synth_set_playhead will build one when needed.
+  int eventsp=synth_song_events_start(src,srcc);
+  if (eventsp>=0) res->seekc=synth_seek_index(&res->seekv,(const uint8_t*)src+eventsp,srcc-eventsp,synth->framesperms);
   return 0;
 }
 
@@ -435,44 +753,179 @@ static struct synth_printer *synth_begin_print(struct synth *synth,const void *s
   return printer;
 }
 
-/* Decode PCM synchronously, or install a printer to do it.
+/* Decode PCM synchronously, or arrange for it to be printed.
  */
  
-struct synth_pcm *synth_init_pcm(struct synth *synth,const void *src,int srcc) {
+int synth_init_pcm(struct synth_pcm **pcm,struct synth_print_job **job,struct synth *synth,const void *src,int srcc) {
+  *pcm=0;
+  *job=0;
   
   if (
     ((srcc>=4)&&!memcmp(src,"RIFF",4))||
   0) {
-    return synth_pcm_decode(src,srcc,synth->rate);
+    if (*pcm=synth_pcm_decode(src,srcc,synth->rate)) return 0;
+    return -1;
   }
   
   if (
     ((srcc>=4)&&!memcmp(src,"\0EGS",4))||
   0) {
+    if (synth->workers) {
+      if (*job=synth_print_job_new(src,srcc,synth->rate)) {
+        if (synth_workers_submit(synth->workers,*job)>=0) return 0;
+        synth_print_job_del(*job);
+        *job=0;
+      }
+    }
+    // No workers, or their queue is full. Print during update instead.
     struct synth_printer *printer=synth_begin_print(synth,src,srcc);
-    if (!printer) return synth_pcm_new(1);
-    if (synth_pcm_ref(printer->pcm)<0) return synth_pcm_new(1);
-    return printer->pcm;
+    if (printer&&(synth_pcm_ref(printer->pcm)>=0)) {
+      *pcm=printer->pcm;
+      return 0;
+    }
   }
   
-  return synth_pcm_new(1);
+  if (*pcm=synth_pcm_new(1)) return 0;
+  return -1;
+}
+
+/* Replace finished print job with its PCM.
+ */
+ 
+int synth_resolve_pcm(struct synth_pcm **pcm,struct synth_print_job **job) {
+  if (*pcm) return 1;
+  struct synth_pcm *ready=0;
+  int err=synth_print_job_get_pcm(&ready,*job);
+  if (!err) return 0;
+  if (err<0) { // Failed printing. Replace with silence, so we don't keep asking.
+    if (!(ready=synth_pcm_new(1))) return -1;
+  } else if (synth_pcm_ref(ready)<0) return -1;
+  *pcm=ready;
+  synth_print_job_del(*job);
+  *job=0;
+  return 1;
+}
+
+/* Preprinted drums, by source address.
+ */
+ 
+static int synth_drumprint_search(const struct synth *synth,const void *src) {
+  int lo=0,hi=synth->drumprintc;
+  while (lo<hi) {
+    int ck=(lo+hi)>>1;
+    const void *q=synth->drumprintv[ck].src;
+         if ((uintptr_t)src<(uintptr_t)q) hi=ck;
+    else if ((uintptr_t)src>(uintptr_t)q) lo=ck+1;
+    else return ck;
+  }
+  return -lo-1;
+}
+
+int synth_init_drum_pcm(struct synth_pcm **pcm,struct synth_print_job **job,struct synth *synth,const void *src,int srcc) {
+  int p=synth_drumprint_search(synth,src);
+  if (p>=0) {
+    struct synth_drumprint *drumprint=synth->drumprintv+p;
+    if (drumprint->srcc==srcc) {
+      *pcm=0;
+      *job=0;
+      if (synth_resolve_pcm(&drumprint->pcm,&drumprint->job)>0) {
+        if (synth_pcm_ref(drumprint->pcm)<0) return -1;
+        *pcm=drumprint->pcm;
+      } else {
+        if (synth_print_job_ref(drumprint->job)<0) return -1;
+        *job=drumprint->job;
+      }
+      return 0;
+    }
+  }
+  // Not from an installed song, eg synth_play_song_handoff. Print it fresh.
+  return synth_init_pcm(pcm,job,synth,src,srcc);
+}
+
+static void synth_preprint_drum(struct synth *synth,const void *src,int srcc) {
+  if ((srcc<4)||memcmp(src,"\0EGS",4)) return;
+  int p=synth_drumprint_search(synth,src);
+  if (p>=0) return;
+  p=-p-1;
+  if (synth->drumprintc>=synth->drumprinta) {
+    int na=synth->drumprinta+32;
+    if (na>INT_MAX/sizeof(struct synth_drumprint)) return;
+    void *nv=realloc(synth->drumprintv,sizeof(struct synth_drumprint)*na);
+    if (!nv) return;
+    synth->drumprintv=nv;
+    synth->drumprinta=na;
+  }
+  struct synth_drumprint drumprint={.src=src,.srcc=srcc};
+  if (synth_init_pcm(&drumprint.pcm,&drumprint.job,synth,src,srcc)<0) return;
+  memmove(synth->drumprintv+p+1,synth->drumprintv+p,sizeof(struct synth_drumprint)*(synth->drumprintc-p));
+  synth->drumprintv[p]=drumprint;
+  synth->drumprintc++;
+}
+
+/* Walk the channel headers of an EGS song, and preprint every EGS drum.
+ * Same format synth_play_song_internal and synth_channel_decode read; we quietly stop at anything malformed.
+ */
+ 
+static void synth_preprint_song_drums(struct synth *synth,const uint8_t *src,int srcc) {
+  if ((srcc<4)||memcmp(src,"\0EGS",4)) return;
+  int srcp=4;
+  while (srcp<srcc) {
+    if (src[srcp]==0xff) return;
+    if (srcp>srcc-6) return;
+    uint8_t mode=src[srcp+2];
+    int bodylen=(src[srcp+3]<<16)|(src[srcp+4]<<8)|src[srcp+5];
+    srcp+=6;
+    if (srcp>srcc-bodylen) return;
+    if (mode==SYNTH_CHANNEL_MODE_DRUM) {
+      const uint8_t *body=src+srcp;
+      int bodyp=0;
+      while (bodyp<=bodylen-5) {
+        uint8_t noteid=body[bodyp];
+        int len=(body[bodyp+3]<<8)|body[bodyp+4];
+        bodyp+=5;
+        if (bodyp>bodylen-len) break;
+        if (noteid<0x80) synth_preprint_drum(synth,body+bodyp,len);
+        bodyp+=len;
+      }
+    }
+    srcp+=bodylen;
+  }
+}
+
+/* Preprint sounds, public.
+ */
+ 
+void synth_preprint_sounds(struct synth *synth) {
+  if (!synth->workers) return;
+  struct synth_res *res=synth->resv;
+  int i=synth->resc;
+  for (;i-->0;res++) {
+    if (res->tid==EGG_TID_song) {
+      synth_preprint_song_drums(synth,res->src,res->srcc);
+      continue;
+    }
+    if (res->tid!=EGG_TID_sound) continue;
+    if (res->pcm||res->job) continue;
+    if ((res->srcc<4)||memcmp(res->src,"\0EGS",4)) continue;
+    synth_init_pcm(&res->pcm,&res->job,synth,res->src,res->srcc);
+  }
 }
 
 /* Play sound, public.
  */
  
 void synth_play_sound(struct synth *synth,int rid) {
-  if (synth->voicec>=SYNTH_VOICE_LIMIT) {
-    fprintf(stderr,"%s:%d: Reject sound:%d, too many voices running.\n",__FILE__,__LINE__,rid);
-    return;
-  }
   int p=synth_resv_search(synth,EGG_TID_sound,rid);
   if (p<0) return;
   struct synth_res *res=synth->resv+p;
-  if (!res->pcm) {
-    if (!(res->pcm=synth_init_pcm(synth,res->src,res->srcc))) return;
+  if (!res->pcm&&!res->job) {
+    if (synth_init_pcm(&res->pcm,&res->job,synth,res->src,res->srcc)<0) return;
   }
-  struct synth_voice *voice=synth_voice_pcm_new(synth,res->pcm,1.0f);
+  struct synth_voice *voice;
+  int err=synth_resolve_pcm(&res->pcm,&res->job);
+  if (err>0) voice=synth_voice_pcm_new(synth,res->pcm,1.0f);
+  else if (!err) voice=synth_voice_pcm_new_job(synth,res->job,1.0f);
+  else return;
   if (!voice) return;
   synth->voicev[synth->voicec++]=voice;
 }
@@ -565,6 +1018,10 @@ void synth_play_song(struct synth *synth,int rid,int force,int repeat) {
   }
   const struct synth_res *res=synth->resv+p;
   synth_play_song_internal(synth,res->src,res->srcc,rid,force,repeat);
+  if ((synth->songid==rid)&&!synth->seekown) {
+    synth->seekv=res->seekv;
+    synth->seekc=res->seekc;
+  }
 }
 
 void synth_play_song_handoff(struct synth *synth,void *src,int srcc,int repeat) {
@@ -585,16 +1042,21 @@ void synth_event(struct synth *synth,uint8_t chid,uint8_t opcode,uint8_t a,uint8
   if (chid>=SYNTH_CHANNEL_COUNT) return;
   switch (opcode) {
     case 0x98: {
-        if (synth->voicec>=SYNTH_VOICE_LIMIT) {
-          fprintf(stderr,"%s:%d: Reject event %02x %02x %02x, too many voices running.\n",__FILE__,__LINE__,chid,opcode,a);
-          return;
-        }
         struct synth_channel *channel=synth->channelv+chid;
         struct synth_voice *voice=synth_channel_play_note(channel,synth,a,b,durms);
         if (!voice) return;
         if (synth->preprintc) voice->song=1; // A cheap hack: If we're inside an update, the voice belongs to song.
+        voice->pan=channel->pan;
         synth->voicev[synth->voicec++]=voice;
       } break;
+    case 0xb0: switch (a) { // Control Change. Only Pan for now.
+        case 0x0a: { // Pan. 0x40 is center, and we treat 0x00 and 0x01 both as hard left, as MIDI recommends.
+            float pan=((int)b-0x40)/63.0f;
+            if (pan<-1.0f) pan=-1.0f;
+            else if (pan>1.0f) pan=1.0f; // (b) isn't necessarily 7-bit, egg_audio_event takes any int.
+            synth->channelv[chid].pan=pan;
+          } break;
+      } break;
     //TODO We should be able to manage 0x90 and 0x80 too, if there's a need for live input.
   }
 }
@@ -606,6 +1068,10 @@ int synth_get_song(const struct synth *synth) {
   return synth->songid;
 }
 
+int synth_get_voice_high_water(const struct synth *synth) {
+  return synth->voicec_hi;
+}
+
 double synth_get_playhead(struct synth *synth) {
   if (!synth->songc) return 0.0;
   if (synth->songvoice) synth->playhead=synth_voice_pcm_get_position(synth->songvoice);
@@ -635,17 +1101,37 @@ void synth_set_playhead(struct synth *synth,double s) {
     voice->release(voice);
   }
   
-  /* We're going to cheat a little:
-   * Pretend the synth is neutered, rewind to the start, then "play" it until we reach the desired playhead.
+  /* Find the last checkpoint at or before the target, and jump there.
+   * Borrowed songs don't have an index yet; build one now and keep it for the song's lifetime.
+   */
+  if (!synth->seekv) {
+    synth->seekc=synth_seek_index(&synth->seekown,synth->song,synth->songc,synth->framesperms);
+    synth->seekv=synth->seekown;
+  }
+  int songp=0,playhead=0;
+  int lo=0,hi=synth->seekc;
+  while (lo<hi) {
+    int ck=(lo+hi)>>1;
+    if (synth->seekv[ck].playhead<=frames) {
+      songp=synth->seekv[ck].songp;
+      playhead=synth->seekv[ck].playhead;
+      lo=ck+1;
+    } else {
+      hi=ck;
+    }
+  }
+  
+  /* Then we cheat a little for the remainder:
+   * Pretend the synth is neutered, and "play" from the checkpoint until we reach the desired playhead.
    * This way, we can place it exactly, down to the frame.
    * Notes started before the target frame will not play.
    */
   int pvneuter=synth->neuter;
   synth->neuter=1;
-  synth->songp=0;
+  synth->songp=songp;
   synth->songdelay=0;
-  synth->playhead=0;
-  int phhi=0; // For detecting loop (ie caller provided an OOB position)
+  synth->playhead=playhead;
+  int phhi=playhead; // For detecting loop (ie caller provided an OOB position)
   while (synth->playhead<frames) {
     int addc=synth_update_song(synth,frames-synth->playhead);
     if (synth->playhead<phhi) break;
@@ -204,3 +204,34 @@ void synth_env_advance(struct synth_env_runner *runner) {
     runner->dv=(point->v-runner->v)/runner->c;
   }
 }
+
+/* Update runner in bulk.
+ */
+ 
+void synth_env_update(float *v,int c,struct synth_env_runner *runner) {
+  while (c>0) {
+    if (runner->c>0) {
+      int updc=runner->c;
+      if (updc>c) updc=c;
+      runner->c-=updc;
+      c-=updc;
+      if (runner->dv==0.0f) {
+        float level=runner->v;
+        for (;updc-->0;v++) *v=level;
+      } else {
+        float level=runner->v;
+        float dv=runner->dv;
+        for (;updc-->0;v++) {
+          *v=level;
+          level+=dv;
+        }
+        runner->v=level;
+      }
+    } else {
+      *v=runner->v;
+      v++;
+      c--;
+      synth_env_advance(runner);
+    }
+  }
+}
@@ -55,6 +55,11 @@ void synth_env_init(struct synth_env_runner *runner,const struct synth_env_confi
 // Normally you provide the release time at init. But you can force it early at any time.
 void synth_env_release(struct synth_env_runner *runner);
 
+// True if we're past the sustain point, or there never was one.
+static inline int synth_env_is_released(const struct synth_env_runner *runner) {
+  return (runner->susp<0)||(runner->pointp>runner->susp);
+}
+
 #define synth_env_next(env) ({ \
   float _v=(env).v; \
   if ((env).c>0) { \
@@ -66,7 +71,12 @@ void synth_env_release(struct synth_env_runner *runner);
   _v; \
 })
 
-// Don't call directly. synth_env_next() does it for you.
+/* Fill (v) with the next (c) values, exactly as if we called synth_env_next() (c) times.
+ * Whole legs are emitted at once, so this is much cheaper than the per-sample macro.
+ */
+void synth_env_update(float *v,int c,struct synth_env_runner *runner);
+
+// Don't call directly. synth_env_next() and synth_env_update() do it for you.
 void synth_env_advance(struct synth_env_runner *runner);
 
 #endif
@@ -8,6 +8,22 @@
 #define SYNTH_RATE_MAX 200000
 #define SYNTH_CHANC_MIN 1
 #define SYNTH_CHANC_MAX 8
+#define SYNTH_QUEUE_SIZE 4096 /* Commands. Must be a power of two. */
+#define SYNTH_WORKER_LIMIT 8
+#define SYNTH_WORKER_QUEUE_SIZE 256 /* Print jobs awaiting a worker. Must be a power of two. */
+#define SYNTH_STEAL_FADE_FRAMES 128 /* Stolen voices ramp out over so long, instead of clicking off. */
+#define SYNTH_SEEK_INTERVAL_MS 1000 /* Approximate spacing of song checkpoints. */
+
+/* Background printing needs pthreads.
+ * Where we don't have them, EGS sounds print during update, as they always did.
+ */
+#ifndef SYNTH_USE_THREADS
+  #if USE_mswin
+    #define SYNTH_USE_THREADS 0
+  #else
+    #define SYNTH_USE_THREADS 1
+  #endif
+#endif
 
 #include <stdlib.h>
 #include <string.h>
@@ -15,12 +31,38 @@
 #include <stdio.h>
 #include <math.h>
 #include "egg/egg.h"
+#include "opt/rom/rom.h"
 #include "synth.h"
+#include "synth_mix.h"
 #include "synth_env.h"
 #include "synth_pcm.h"
 #include "synth_voice.h"
 #include "synth_channel.h"
 
+/* Command queued from another thread.
+ ********************************************************/
+ 
+#define SYNTH_COMMAND_SOUND    1
+#define SYNTH_COMMAND_SONG     2
+#define SYNTH_COMMAND_EVENT    3
+#define SYNTH_COMMAND_PLAYHEAD 4
+
+struct synth_command {
+  int type;
+  int rid,force,repeat; // SOUND,SONG
+  uint8_t chid,opcode,a,b; // EVENT
+  int durms; // EVENT
+  double s; // PLAYHEAD
+};
+
+/* Song checkpoint.
+ * Resuming play at (songp) with zero (songdelay) is the same as having played from the start up to (playhead).
+ */
+struct synth_seek {
+  int playhead; // frames
+  int songp;
+};
+
 /* Global context.
  ********************************************************/
  
@@ -33,14 +75,26 @@ struct synth {
   float *qbuf;
   int qbufa;
   struct synth_wave *sine;
+  uint32_t noise; // PRNG state for SUB voices. Per synth, so output is repeatable and threads don't share it.
   float rate_by_noteid[128];
   
-  struct synth_voice *voicev[SYNTH_VOICE_LIMIT];
+  struct synth_voice *voicev[SYNTH_VOICE_LIMIT]; // Unordered.
   int voicec;
+  void *voicepool; // SYNTH_VOICE_LIMIT slots of SYNTH_VOICE_SIZE_LIMIT bytes.
+  void *voicefreev[SYNTH_VOICE_LIMIT]; // Stack of unused slots in (voicepool).
+  int voicefreec;
+  int voicec_hi; // High-water mark of (voicec), sampled at each update.
+  unsigned int voiceserial; // Next voice's (serial).
+  int steal_policy;
+  int stolenc,rejectedc;
+  float steall[SYNTH_STEAL_FADE_FRAMES],stealr[SYNTH_STEAL_FADE_FRAMES]; // Faded tails of stolen voices. Mono output uses (steall) only.
+  int stealp,stealc; // Next frame to play from (steall,stealr), and end of the valid part.
   
   struct synth_printer **printerv;
   int printerc,printera;
   int preprintc; // Nonzero if an update is in progress. New printers must run so many frames on construction.
+  struct synth_workers *workers; // Null unless synth_start_printers() succeeded.
+  struct synth_profile *profile; // Null unless synth_enable_profile() succeeded.
   
   struct synth_res {
     int tid; // EGG_TID_sound or EGG_TID_song
@@ -48,8 +102,24 @@ struct synth {
     const void *src;
     int srcc;
     struct synth_pcm *pcm;
+    struct synth_print_job *job; // Pending (pcm). Never both.
+    struct synth_seek *seekv; // Songs only. See synth_set_playhead().
+    int seekc;
   } *resv;
   int resc,resa;
+  struct rom_index resindex; // Over (resv). Rebuilt lazily after inserts.
+  int resindex_valid; // 1 if (resindex) is current, 0 if stale, -1 if it failed and we binary-search (resv) instead.
+  
+  /* EGS drums from installed songs, printed ahead of time by synth_preprint_sounds.
+   * Channels starting a song ref these instead of creating print jobs on the audio thread.
+   */
+  struct synth_drumprint {
+    const void *src; // WEAK, points into some song in (resv).
+    int srcc;
+    struct synth_pcm *pcm;
+    struct synth_print_job *job; // Pending (pcm). Never both.
+  } *drumprintv; // Sorted by (src).
+  int drumprintc,drumprinta;
   
   struct synth_channel channelv[SYNTH_CHANNEL_COUNT];
   int channelc; // 0..16, but channelv may contain dummies
@@ -62,13 +132,69 @@ struct synth {
   int songdelay; // frames
   int playhead; // frames
   void *songown; // free on song change
+  const struct synth_seek *seekv; // WEAK, from (resv) or (seekown). Built lazily for borrowed songs.
+  int seekc;
+  struct synth_seek *seekown;
   struct synth_voice *songvoice; // WEAK; owned by (voicev). For PCM songs only.
+  
+  /* Single-producer, single-consumer ring of commands.
+   * (queue_head) is written only by the producer and (queue_tail) only by the consumer; both only via atomics.
+   * They count forever and wrap naturally; index (queuev) with SYNTH_QUEUE_SIZE-1.
+   */
+  struct synth_command queuev[SYNTH_QUEUE_SIZE];
+  unsigned int queue_head;
+  unsigned int queue_tail;
 };
 
-/* Decode PCM synchronously, or install a printer to do it.
- * Returns STRONG.
+/* Fast 2**x, for pitch envelopes.
+ * Within about 0.15 cents of powf(2.0f,x) across the full range of pitch envelopes (+-27 octaves).
+ */
+static inline float synth_exp2(float x) {
+  if (x<-126.0f) x=-126.0f;
+  else if (x>126.0f) x=126.0f;
+  int whole=(int)x;
+  if (x<(float)whole) whole--;
+  float f=x-(float)whole;
+  union { float f; uint32_t i; } bits={.i=(uint32_t)(whole+127)<<23};
+  return bits.f*(1.0f+f*(0.6931472f+f*(0.2402265f+f*(0.0555041f+f*(0.0096181f+f*0.0013334f)))));
+}
+
+/* Decode PCM synchronously, or arrange for it to be printed.
+ * On success, exactly one of (*pcm) or (*job) is populated, STRONG.
+ * WAV decodes synchronously. EGS goes to a background worker if we have them, otherwise an update-time printer.
  * We'll try to generate one sample of silence if decoding fails.
  */ 
-struct synth_pcm *synth_init_pcm(struct synth *synth,const void *src,int srcc);
+int synth_init_pcm(struct synth_pcm **pcm,struct synth_print_job **job,struct synth *synth,const void *src,int srcc);
+
+/* If (*job) has finished, replace it with (*pcm).
+ * Returns 0 if still pending, or >0 if (*pcm) is ready.
+ * A failed job resolves to one sample of silence.
+ */
+int synth_resolve_pcm(struct synth_pcm **pcm,struct synth_print_job **job);
+
+/* Like synth_init_pcm, for a drum whose (src) points into an installed song.
+ * If synth_preprint_sounds already started it, we only add references.
+ */
+int synth_init_drum_pcm(struct synth_pcm **pcm,struct synth_print_job **job,struct synth *synth,const void *src,int srcc);
+
+/* Free a pool slot by killing some voice, per (steal_policy). <0 if nothing could be stolen.
+ * Only synth_voice_new should need this.
+ */
+int synth_steal_voice(struct synth *synth);
+
+/* Background printers, in synth_worker.c.
+ * Submitting takes a new reference to (job); caller keeps its own.
+ * Submitting never waits for a print, so it's safe from the audio thread. It takes the workers' mutex only long enough to signal.
+ * It fails if SYNTH_WORKER_QUEUE_SIZE jobs are already waiting.
+ */
+void synth_workers_del(struct synth_workers *workers);
+struct synth_workers *synth_workers_new(int threadc);
+int synth_workers_submit(struct synth_workers *workers,struct synth_print_job *job);
+
+/* Profiler, in synth_profile.c.
+ * Public updates take synth_profile_now() on entry, then report to synth_profile_end(), only if (synth->profile).
+ */
+double synth_profile_now();
+void synth_profile_end(struct synth *synth,double starttime,int framec,int voicec,int printerc);
 
 #endif
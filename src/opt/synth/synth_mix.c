@@ -0,0 +1,137 @@
+#include "synth_internal.h"
+
+#if SYNTH_USE_SIMD>=2
+  #include <immintrin.h>
+  const char *synth_mix_impl="avx2";
+#elif SYNTH_USE_SIMD>=1
+  #include <emmintrin.h>
+  const char *synth_mix_impl="sse2";
+#else
+  const char *synth_mix_impl="scalar";
+#endif
+
+/* Add.
+ */
+ 
+void synth_mix_add(float *dst,const float *src,int c) {
+  #if SYNTH_USE_SIMD>=2
+    for (;c>=8;c-=8,dst+=8,src+=8) {
+      _mm256_storeu_ps(dst,_mm256_add_ps(_mm256_loadu_ps(dst),_mm256_loadu_ps(src)));
+    }
+  #elif SYNTH_USE_SIMD>=1
+    for (;c>=4;c-=4,dst+=4,src+=4) {
+      _mm_storeu_ps(dst,_mm_add_ps(_mm_loadu_ps(dst),_mm_loadu_ps(src)));
+    }
+  #endif
+  for (;c-->0;dst++,src++) (*dst)+=(*src);
+}
+
+/* Add with constant scale.
+ */
+ 
+void synth_mix_add_scaled(float *dst,const float *src,float k,int c) {
+  #if SYNTH_USE_SIMD>=2
+    __m256 kv=_mm256_set1_ps(k);
+    for (;c>=8;c-=8,dst+=8,src+=8) {
+      _mm256_storeu_ps(dst,_mm256_add_ps(_mm256_loadu_ps(dst),_mm256_mul_ps(_mm256_loadu_ps(src),kv)));
+    }
+  #elif SYNTH_USE_SIMD>=1
+    __m128 kv=_mm_set1_ps(k);
+    for (;c>=4;c-=4,dst+=4,src+=4) {
+      _mm_storeu_ps(dst,_mm_add_ps(_mm_loadu_ps(dst),_mm_mul_ps(_mm_loadu_ps(src),kv)));
+    }
+  #endif
+  for (;c-->0;dst++,src++) (*dst)+=(*src)*k;
+}
+
+/* Add product of two buffers.
+ */
+ 
+void synth_mix_add_product(float *dst,const float *a,const float *b,int c) {
+  #if SYNTH_USE_SIMD>=2
+    for (;c>=8;c-=8,dst+=8,a+=8,b+=8) {
+      _mm256_storeu_ps(dst,_mm256_add_ps(_mm256_loadu_ps(dst),_mm256_mul_ps(_mm256_loadu_ps(a),_mm256_loadu_ps(b))));
+    }
+  #elif SYNTH_USE_SIMD>=1
+    for (;c>=4;c-=4,dst+=4,a+=4,b+=4) {
+      _mm_storeu_ps(dst,_mm_add_ps(_mm_loadu_ps(dst),_mm_mul_ps(_mm_loadu_ps(a),_mm_loadu_ps(b))));
+    }
+  #endif
+  for (;c-->0;dst++,a++,b++) (*dst)+=(*a)*(*b);
+}
+
+/* Gain and clip in place.
+ */
+ 
+void synth_mix_gain_clip(float *v,float k,int c) {
+  #if SYNTH_USE_SIMD>=2
+    __m256 kv=_mm256_set1_ps(k);
+    __m256 lo=_mm256_set1_ps(-1.0f);
+    __m256 hi=_mm256_set1_ps(1.0f);
+    for (;c>=8;c-=8,v+=8) {
+      _mm256_storeu_ps(v,_mm256_min_ps(hi,_mm256_max_ps(lo,_mm256_mul_ps(_mm256_loadu_ps(v),kv))));
+    }
+  #elif SYNTH_USE_SIMD>=1
+    __m128 kv=_mm_set1_ps(k);
+    __m128 lo=_mm_set1_ps(-1.0f);
+    __m128 hi=_mm_set1_ps(1.0f);
+    for (;c>=4;c-=4,v+=4) {
+      _mm_storeu_ps(v,_mm_min_ps(hi,_mm_max_ps(lo,_mm_mul_ps(_mm_loadu_ps(v),kv))));
+    }
+  #endif
+  for (;c-->0;v++) {
+    float sample=(*v)*k;
+    if (sample<-1.0f) *v=-1.0f;
+    else if (sample>1.0f) *v=1.0f;
+    else *v=sample;
+  }
+}
+
+/* Mono to stereo.
+ */
+ 
+void synth_mix_interleave(float *dst,const float *src,int c) {
+  #if SYNTH_USE_SIMD>=2
+    for (;c>=8;c-=8,dst+=16,src+=8) {
+      __m256 m=_mm256_loadu_ps(src);
+      __m256 lo=_mm256_unpacklo_ps(m,m); // 0 0 1 1 | 4 4 5 5
+      __m256 hi=_mm256_unpackhi_ps(m,m); // 2 2 3 3 | 6 6 7 7
+      _mm256_storeu_ps(dst,_mm256_permute2f128_ps(lo,hi,0x20));
+      _mm256_storeu_ps(dst+8,_mm256_permute2f128_ps(lo,hi,0x31));
+    }
+  #elif SYNTH_USE_SIMD>=1
+    for (;c>=4;c-=4,dst+=8,src+=4) {
+      __m128 m=_mm_loadu_ps(src);
+      _mm_storeu_ps(dst,_mm_unpacklo_ps(m,m));
+      _mm_storeu_ps(dst+4,_mm_unpackhi_ps(m,m));
+    }
+  #endif
+  for (;c-->0;dst+=2,src++) dst[0]=dst[1]=*src;
+}
+
+/* Mono to stereo, panned, adding.
+ */
+ 
+void synth_mix_add_pan(float *dst,const float *src,float l,float r,int c) {
+  #if SYNTH_USE_SIMD>=2
+    __m256 kv=_mm256_setr_ps(l,r,l,r,l,r,l,r);
+    for (;c>=8;c-=8,dst+=16,src+=8) {
+      __m256 m=_mm256_loadu_ps(src);
+      __m256 lo=_mm256_unpacklo_ps(m,m);
+      __m256 hi=_mm256_unpackhi_ps(m,m);
+      _mm256_storeu_ps(dst,_mm256_add_ps(_mm256_loadu_ps(dst),_mm256_mul_ps(_mm256_permute2f128_ps(lo,hi,0x20),kv)));
+      _mm256_storeu_ps(dst+8,_mm256_add_ps(_mm256_loadu_ps(dst+8),_mm256_mul_ps(_mm256_permute2f128_ps(lo,hi,0x31),kv)));
+    }
+  #elif SYNTH_USE_SIMD>=1
+    __m128 kv=_mm_setr_ps(l,r,l,r);
+    for (;c>=4;c-=4,dst+=8,src+=4) {
+      __m128 m=_mm_loadu_ps(src);
+      _mm_storeu_ps(dst,_mm_add_ps(_mm_loadu_ps(dst),_mm_mul_ps(_mm_unpacklo_ps(m,m),kv)));
+      _mm_storeu_ps(dst+4,_mm_add_ps(_mm_loadu_ps(dst+4),_mm_mul_ps(_mm_unpackhi_ps(m,m),kv)));
+    }
+  #endif
+  for (;c-->0;dst+=2,src++) {
+    dst[0]+=(*src)*l;
+    dst[1]+=(*src)*r;
+  }
+}
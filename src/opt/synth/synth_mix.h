@@ -0,0 +1,47 @@
+/* synth_mix.h
+ * Block primitives for voices mixing into the main buffer.
+ * Voices render in blocks of no more than SYNTH_BLOCK_FRAMES, so their scratch buffers can live on the stack.
+ * We vectorize with AVX2 or SSE2 when the compiler targets them, otherwise plain scalar loops.
+ * Build with -DSYNTH_USE_SIMD=0 to force the scalar path.
+ */
+ 
+#ifndef SYNTH_MIX_H
+#define SYNTH_MIX_H
+
+#define SYNTH_BLOCK_FRAMES 256
+
+#ifndef SYNTH_USE_SIMD
+  #if defined(__AVX2__)
+    #define SYNTH_USE_SIMD 2
+  #elif defined(__SSE2__)
+    #define SYNTH_USE_SIMD 1
+  #else
+    #define SYNTH_USE_SIMD 0
+  #endif
+#endif
+
+// Name of the selected implementation, for logging: "scalar", "sse2", "avx2".
+extern const char *synth_mix_impl;
+
+// dst[i]+=src[i]
+void synth_mix_add(float *dst,const float *src,int c);
+
+// dst[i]+=src[i]*k
+void synth_mix_add_scaled(float *dst,const float *src,float k,int c);
+
+// dst[i]+=a[i]*b[i]
+void synth_mix_add_product(float *dst,const float *a,const float *b,int c);
+
+// v[i]=clamp(v[i]*k,-1,1)
+void synth_mix_gain_clip(float *v,float k,int c);
+
+/* Stereo. (dst) is interleaved, (c) in frames, and (src) mono.
+ */
+
+// dst[i*2]=dst[i*2+1]=src[i]
+void synth_mix_interleave(float *dst,const float *src,int c);
+
+// dst[i*2]+=src[i]*l, dst[i*2+1]+=src[i]*r
+void synth_mix_add_pan(float *dst,const float *src,float l,float r,int c);
+
+#endif
@@ -115,15 +115,16 @@ int synth_wave_decode(struct synth_wave *dst,struct synth *synth,const void *src
 
 void synth_pcm_del(struct synth_pcm *pcm) {
   if (!pcm) return;
-  if (pcm->refc-->1) return;
+  if (__atomic_sub_fetch(&pcm->refc,1,__ATOMIC_ACQ_REL)>0) return;
   free(pcm);
 }
 
 int synth_pcm_ref(struct synth_pcm *pcm) {
   if (!pcm) return -1;
-  if (pcm->refc<1) return -1;
-  if (pcm->refc==INT_MAX) return -1;
-  pcm->refc++;
+  int refc=__atomic_load_n(&pcm->refc,__ATOMIC_RELAXED);
+  if (refc<1) return -1;
+  if (refc==INT_MAX) return -1;
+  __atomic_add_fetch(&pcm->refc,1,__ATOMIC_RELAXED);
   return 0;
 }
 
@@ -304,3 +305,57 @@ int synth_printer_update(struct synth_printer *printer,int c) {
   }
   return (printer->p>=printer->pcm->c)?0:1;
 }
+
+/* Print job lifecycle.
+ */
+ 
+void synth_print_job_del(struct synth_print_job *job) {
+  if (!job) return;
+  if (__atomic_sub_fetch(&job->refc,1,__ATOMIC_ACQ_REL)>0) return;
+  synth_pcm_del(job->pcm);
+  free(job);
+}
+
+int synth_print_job_ref(struct synth_print_job *job) {
+  if (!job) return -1;
+  int refc=__atomic_load_n(&job->refc,__ATOMIC_RELAXED);
+  if (refc<1) return -1;
+  if (refc==INT_MAX) return -1;
+  __atomic_add_fetch(&job->refc,1,__ATOMIC_RELAXED);
+  return 0;
+}
+
+struct synth_print_job *synth_print_job_new(const void *src,int srcc,int rate) {
+  if (!src||(srcc<1)) return 0;
+  struct synth_print_job *job=malloc(sizeof(struct synth_print_job)+srcc);
+  if (!job) return 0;
+  job->refc=1;
+  job->status=0;
+  job->pcm=0;
+  job->rate=rate;
+  job->srcc=srcc;
+  memcpy(job->src,src,srcc);
+  return job;
+}
+
+/* Check print job.
+ */
+ 
+int synth_print_job_get_pcm(struct synth_pcm **dst,struct synth_print_job *job) {
+  if (!job) return -1;
+  int status=__atomic_load_n(&job->status,__ATOMIC_ACQUIRE);
+  if (status>0) *dst=job->pcm;
+  return status;
+}
+
+/* Run print job.
+ */
+ 
+void synth_print_job_run(struct synth_print_job *job) {
+  if (__atomic_load_n(&job->status,__ATOMIC_ACQUIRE)) return;
+  if (job->pcm=synth_pcm_decode(job->src,job->srcc,job->rate)) {
+    __atomic_store_n(&job->status,1,__ATOMIC_RELEASE);
+  } else {
+    __atomic_store_n(&job->status,-1,__ATOMIC_RELEASE);
+  }
+}
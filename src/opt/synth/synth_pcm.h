@@ -33,6 +33,8 @@ int synth_require_sine(struct synth *synth);
 int synth_wave_decode(struct synth_wave *dst,struct synth *synth,const void *src,int srcc);
 
 /* PCM dump.
+ * Refcount is atomic, since dumps may be produced on a background thread.
+ * Content must not change once shared.
  *********************************************************************/
 
 struct synth_pcm {
@@ -69,4 +71,31 @@ struct synth_printer *synth_printer_new(const void *src,int srcc,int rate);
  */
 int synth_printer_update(struct synth_printer *printer,int c);
 
+/* Background print job.
+ * Shared between the synth and a worker thread; refcount is atomic.
+ * Worker produces (pcm) and then sets (status), once. Don't read either directly, use synth_print_job_get_pcm().
+ * We copy the source, so it doesn't matter if the song it came from goes away mid-print.
+ ********************************************************************/
+ 
+struct synth_print_job {
+  int refc;
+  int status; // 0=pending, 1=ready, -1=failed
+  struct synth_pcm *pcm;
+  int rate;
+  int srcc;
+  uint8_t src[];
+};
+
+void synth_print_job_del(struct synth_print_job *job);
+int synth_print_job_ref(struct synth_print_job *job);
+struct synth_print_job *synth_print_job_new(const void *src,int srcc,int rate);
+
+/* <0 if failed, 0 if pending, or >0 if finished and (*dst) populated, WEAK.
+ */
+int synth_print_job_get_pcm(struct synth_pcm **dst,struct synth_print_job *job);
+
+/* Print synchronously and publish the result. Workers call this.
+ */
+void synth_print_job_run(struct synth_print_job *job);
+
 #endif
@@ -0,0 +1,66 @@
+#include "synth_internal.h"
+#include <time.h>
+#if USE_mswin
+  #include <sys/time.h>
+#endif
+
+/* Current time, for measuring intervals only.
+ */
+ 
+double synth_profile_now() {
+  #if USE_mswin
+    struct timeval tv={0};
+    gettimeofday(&tv,0);
+    return (double)tv.tv_sec+(double)tv.tv_usec/1000000.0;
+  #else
+    struct timespec tv={0};
+    clock_gettime(CLOCK_MONOTONIC,&tv);
+    return (double)tv.tv_sec+(double)tv.tv_nsec/1000000000.0;
+  #endif
+}
+
+/* Enable, public.
+ */
+ 
+int synth_enable_profile(struct synth *synth) {
+  if (!synth) return -1;
+  if (synth->profile) return 0;
+  if (!(synth->profile=calloc(1,sizeof(struct synth_profile)))) return -1;
+  return 0;
+}
+
+/* Get, public.
+ */
+
+const struct synth_profile *synth_get_profile(const struct synth *synth) {
+  if (!synth) return 0;
+  return synth->profile;
+}
+
+/* Record one update.
+ */
+ 
+void synth_profile_end(struct synth *synth,double starttime,int framec,int voicec,int printerc) {
+  struct synth_profile *profile=synth->profile;
+  if (!profile||(framec<1)) return;
+  double render=synth_profile_now()-starttime;
+  if (render<0.0) render=0.0;
+  double load=(render*synth->rate)/framec;
+  
+  profile->updatec++;
+  profile->framec+=framec;
+  profile->render+=render;
+  if (render>profile->render_max) profile->render_max=render;
+  if (load>profile->load_max) profile->load_max=load;
+  if (load>=1.0) profile->underrunc++;
+  
+  int p=(int)(load*(SYNTH_PROFILE_BUCKETS-1));
+  if (p>=SYNTH_PROFILE_BUCKETS) p=SYNTH_PROFILE_BUCKETS-1;
+  profile->loadv[p]++;
+  p=(voicec*(SYNTH_PROFILE_BUCKETS-1))/SYNTH_VOICE_LIMIT;
+  if (p>=SYNTH_PROFILE_BUCKETS) p=SYNTH_PROFILE_BUCKETS-1;
+  profile->voicev[p]++;
+  p=printerc;
+  if (p>=SYNTH_PROFILE_BUCKETS) p=SYNTH_PROFILE_BUCKETS-1;
+  profile->printerv[p]++;
+}
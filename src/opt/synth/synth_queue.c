@@ -0,0 +1,59 @@
+#include "synth_internal.h"
+
+/* Add a command to the queue.
+ * Producer side: We own (queue_head), and only read (queue_tail).
+ */
+ 
+static int synth_queue_push(struct synth *synth,const struct synth_command *command) {
+  if (!synth) return -1;
+  unsigned int head=synth->queue_head;
+  unsigned int tail=__atomic_load_n(&synth->queue_tail,__ATOMIC_ACQUIRE);
+  if (head-tail>=SYNTH_QUEUE_SIZE) return -1;
+  synth->queuev[head&(SYNTH_QUEUE_SIZE-1)]=*command;
+  __atomic_store_n(&synth->queue_head,head+1,__ATOMIC_RELEASE);
+  return 0;
+}
+
+/* Public producer entry points.
+ */
+ 
+int synth_queue_sound(struct synth *synth,int rid) {
+  struct synth_command command={.type=SYNTH_COMMAND_SOUND,.rid=rid};
+  return synth_queue_push(synth,&command);
+}
+
+int synth_queue_song(struct synth *synth,int rid,int force,int repeat) {
+  struct synth_command command={.type=SYNTH_COMMAND_SONG,.rid=rid,.force=force,.repeat=repeat};
+  return synth_queue_push(synth,&command);
+}
+
+int synth_queue_event(struct synth *synth,uint8_t chid,uint8_t opcode,uint8_t a,uint8_t b,int durms) {
+  struct synth_command command={.type=SYNTH_COMMAND_EVENT,.chid=chid,.opcode=opcode,.a=a,.b=b,.durms=durms};
+  return synth_queue_push(synth,&command);
+}
+
+int synth_queue_playhead(struct synth *synth,double s) {
+  struct synth_command command={.type=SYNTH_COMMAND_PLAYHEAD,.s=s};
+  return synth_queue_push(synth,&command);
+}
+
+/* Drain the queue.
+ * Consumer side: We own (queue_tail), and only read (queue_head).
+ */
+ 
+void synth_flush_commands(struct synth *synth) {
+  if (!synth) return;
+  unsigned int head=__atomic_load_n(&synth->queue_head,__ATOMIC_ACQUIRE);
+  unsigned int tail=synth->queue_tail;
+  if (head==tail) return;
+  for (;tail!=head;tail++) {
+    const struct synth_command *command=synth->queuev+(tail&(SYNTH_QUEUE_SIZE-1));
+    switch (command->type) {
+      case SYNTH_COMMAND_SOUND: synth_play_sound(synth,command->rid); break;
+      case SYNTH_COMMAND_SONG: synth_play_song(synth,command->rid,command->force,command->repeat); break;
+      case SYNTH_COMMAND_EVENT: synth_event(synth,command->chid,command->opcode,command->a,command->b,command->durms); break;
+      case SYNTH_COMMAND_PLAYHEAD: synth_set_playhead(synth,command->s); break;
+    }
+  }
+  __atomic_store_n(&synth->queue_tail,tail,__ATOMIC_RELEASE);
+}
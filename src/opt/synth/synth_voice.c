@@ -6,7 +6,8 @@
 void synth_voice_del(struct synth_voice *voice) {
   if (!voice) return;
   voice->del(voice);
-  free(voice);
+  struct synth *synth=voice->synth;
+  synth->voicefreev[synth->voicefreec++]=voice;
 }
 
 /* Dummy hooks.
@@ -23,17 +24,25 @@ static void _voice_release_dummy(struct synth_voice *voice) {
   voice->finished=1;
 }
 
+static float _voice_get_level_dummy(const struct synth_voice *voice,int *released) {
+  *released=1;
+  return 0.0f;
+}
+
 /* New.
  */
 
 struct synth_voice *synth_voice_new(struct synth *synth,int objlen) {
-  if (!synth||(objlen<(int)sizeof(struct synth_voice))) return 0;
-  struct synth_voice *voice=calloc(1,objlen);
-  if (!voice) return 0;
+  if (!synth||(objlen<(int)sizeof(struct synth_voice))||(objlen>SYNTH_VOICE_SIZE_LIMIT)) return 0;
+  if ((synth->voicefreec<1)&&(synth_steal_voice(synth)<0)) return 0;
+  struct synth_voice *voice=synth->voicefreev[--(synth->voicefreec)];
+  memset(voice,0,objlen);
   voice->synth=synth;
+  voice->serial=synth->voiceserial++;
   voice->magic=' ';
   voice->del=_voice_del_dummy;
   voice->update=_voice_update_dummy;
   voice->release=_voice_release_dummy;
+  voice->get_level=_voice_get_level_dummy;
   return voice;
 }
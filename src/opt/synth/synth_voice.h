@@ -5,6 +5,11 @@
 #ifndef SYNTH_VOICE_H
 #define SYNTH_VOICE_H
 
+/* Voices live in a pool owned by the synth, SYNTH_VOICE_LIMIT slots of this size each.
+ * No voice type may be larger. (FM is the biggest, about 550 bytes).
+ */
+#define SYNTH_VOICE_SIZE_LIMIT 640
+
 /* Generic voice.
  *****************************************************************************/
 
@@ -13,16 +18,28 @@ struct synth_voice {
   int finished; // Update must set nonzero when no more signal will be generated.
   int song; // Nonzero if we belong to the song -- will be released on a song change.
   char magic; // [ pwfs]
+  unsigned int serial; // Order of creation, for voice stealing.
+  float pan; // -1..1 = left..right. Captured from the channel at Note On. Ignored if mono.
   
   /* All hooks are required.
    * They'll be populated with dummies at allocation.
-   * Update is always mono, and you must add to (v), don't overwrite it.
+   * Update is always mono, and you must add to (v), don't overwrite it. Context takes care of panning.
    */
   void (*del)(struct synth_voice *voice);
   void (*update)(float *v,int c,struct synth_voice *voice);
   void (*release)(struct synth_voice *voice);
+  
+  /* Current output level, roughly, and whether we're winding down. For voice stealing.
+   * Dummy reports silent and released, so the default is "steal me first".
+   */
+  float (*get_level)(const struct synth_voice *voice,int *released);
 };
 
+/* Voices don't malloc or free; they come from and return to (synth)'s pool, in constant time.
+ * If the pool is exhausted, new steals a voice per the synth's policy, and fails if the policy says no.
+ * So call it only when everything else about the new voice is ready; a stolen voice can't be given back.
+ * The victim is removed from (synth->voicev), so new voices must not be created while iterating it.
+ */
 void synth_voice_del(struct synth_voice *voice);
 
 struct synth_voice *synth_voice_new(struct synth *synth,int objlen);
@@ -36,6 +53,15 @@ struct synth_voice *synth_voice_pcm_new(
   float trim
 );
 
+/* PCM voice for a sound still printing in the background.
+ * Plays silence until the job finishes, then picks up the PCM at the same position, as if it had been there all along.
+ */
+struct synth_voice *synth_voice_pcm_new_job(
+  struct synth *synth,
+  struct synth_print_job *job,
+  float trim
+);
+
 struct synth_voice *synth_voice_wave_new(
   struct synth *synth,
   struct synth_wave *wave,
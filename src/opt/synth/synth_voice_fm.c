@@ -5,9 +5,11 @@
  
 struct synth_voice_fm {
   struct synth_voice hdr;
-  float carrate;
-  float carp;
-  float modp;
+  const float *sine; // WEAK; synth->sine, which outlives all voices.
+  uint32_t carp;
+  uint32_t modp;
+  uint32_t moddp; // Constant, if there's no pitch env.
+  float carrate; // Normalized rate, scaled to the phase accumulator (ie 1.0 == 1<<32).
   float modrate;
   struct synth_env_runner levelenv;
   struct synth_env_runner pitchenv;
@@ -16,6 +18,11 @@ struct synth_voice_fm {
 
 #define VOICE ((struct synth_voice_fm*)voice)
 
+/* Phase accumulators run 32-bit, with the table index in the top bits.
+ * Step may be negative or larger than a full period, so go through int64 to wrap it properly.
+ */
+#define FM_STEP(rate) ((uint32_t)(int64_t)(rate))
+
 /* Delete.
  */
  
@@ -26,43 +33,59 @@ static void _fm_del(struct synth_voice *voice) {
  */
  
 static void _fm_update_flat(float *v,int c,struct synth_voice *voice) {
-  for (;c-->0;v++) {
-    float level=synth_env_next(VOICE->levelenv);
-    float sample=level*sinf(VOICE->carp);
-    (*v)+=sample;
-    
-    float rate=VOICE->carrate;
-    
-    float mod=sinf(VOICE->modp);
-    VOICE->modp+=rate*VOICE->modrate;
-    while (VOICE->modp>=M_PI) VOICE->modp-=M_PI*2.0f;
-    
-    float range=synth_env_next(VOICE->rangeenv);
-    VOICE->carp+=rate+rate*mod*range;
-    while (VOICE->carp>=M_PI) VOICE->carp-=M_PI*2.0f;
+  float level[SYNTH_BLOCK_FRAMES];
+  float range[SYNTH_BLOCK_FRAMES];
+  const float *sine=VOICE->sine;
+  float rate=VOICE->carrate;
+  uint32_t moddp=VOICE->moddp;
+  while (c>0) {
+    int updc=(c>SYNTH_BLOCK_FRAMES)?SYNTH_BLOCK_FRAMES:c;
+    synth_env_update(level,updc,&VOICE->levelenv);
+    synth_env_update(range,updc,&VOICE->rangeenv);
+    uint32_t carp=VOICE->carp,modp=VOICE->modp;
+    int i=0; for (;i<updc;i++) {
+      float mod=sine[modp>>SYNTH_WAVE_SHIFT];
+      modp+=moddp;
+      float sample=sine[carp>>SYNTH_WAVE_SHIFT];
+      carp+=FM_STEP(rate+rate*mod*range[i]);
+      range[i]=sample;
+    }
+    VOICE->carp=carp;
+    VOICE->modp=modp;
+    synth_mix_add_product(v,level,range,updc);
+    v+=updc;
+    c-=updc;
   }
   if (VOICE->levelenv.finished) voice->finished=1;
 }
 
 static void _fm_update_pitchenv(float *v,int c,struct synth_voice *voice) {
-  for (;c-->0;v++) {
-    float level=synth_env_next(VOICE->levelenv);
-    float sample=level*sinf(VOICE->carp);
-    (*v)+=sample;
-    
-    float rate=synth_env_next(VOICE->pitchenv);
-    rate=VOICE->carrate*powf(2.0f,rate/1200.0f);
-    
-    float mod=sinf(VOICE->modp);
-    VOICE->modp+=rate*VOICE->modrate;
-    while (VOICE->modp>=M_PI) VOICE->modp-=M_PI*2.0f;
-    
-    VOICE->carp+=rate+rate*mod*synth_env_next(VOICE->rangeenv);
-    while (VOICE->carp>=M_PI) VOICE->carp-=M_PI*2.0f;
-  }
-  if (VOICE->levelenv.finished) {
-    voice->finished=1;
+  float level[SYNTH_BLOCK_FRAMES];
+  float range[SYNTH_BLOCK_FRAMES];
+  float pitch[SYNTH_BLOCK_FRAMES];
+  const float *sine=VOICE->sine;
+  while (c>0) {
+    int updc=(c>SYNTH_BLOCK_FRAMES)?SYNTH_BLOCK_FRAMES:c;
+    synth_env_update(level,updc,&VOICE->levelenv);
+    synth_env_update(pitch,updc,&VOICE->pitchenv);
+    synth_env_update(range,updc,&VOICE->rangeenv);
+    int i=0; for (;i<updc;i++) pitch[i]=VOICE->carrate*synth_exp2(pitch[i]/1200.0f);
+    uint32_t carp=VOICE->carp,modp=VOICE->modp;
+    for (i=0;i<updc;i++) {
+      float rate=pitch[i];
+      float mod=sine[modp>>SYNTH_WAVE_SHIFT];
+      modp+=FM_STEP(rate*VOICE->modrate);
+      float sample=sine[carp>>SYNTH_WAVE_SHIFT];
+      carp+=FM_STEP(rate+rate*mod*range[i]);
+      range[i]=sample;
+    }
+    VOICE->carp=carp;
+    VOICE->modp=modp;
+    synth_mix_add_product(v,level,range,updc);
+    v+=updc;
+    c-=updc;
   }
+  if (VOICE->levelenv.finished) voice->finished=1;
 }
 
 /* Release.
@@ -74,6 +97,14 @@ static void _fm_release(struct synth_voice *voice) {
   synth_env_release(&VOICE->rangeenv);
 }
 
+/* Level.
+ */
+ 
+static float _fm_get_level(const struct synth_voice *voice,int *released) {
+  *released=synth_env_is_released(&VOICE->levelenv);
+  return VOICE->levelenv.v;
+}
+
 /* New.
  */
  
@@ -87,13 +118,16 @@ struct synth_voice *synth_voice_fm_new(
   const struct synth_env_config *pitchenv,
   const struct synth_env_config *rangeenv
 ) {
+  if (!synth->sine) return 0; // synth_new builds it. Don't allocate on the audio thread.
   struct synth_voice *voice=synth_voice_new(synth,sizeof(struct synth_voice_fm));
   if (!voice) return 0;
   voice->magic='f';
   voice->del=_fm_del;
   voice->release=_fm_release;
+  voice->get_level=_fm_get_level;
   synth_env_init(&VOICE->levelenv,levelenv,velocity,durframes);
   synth_env_init(&VOICE->rangeenv,rangeenv,velocity,durframes);
+  VOICE->sine=synth->sine->v;
   VOICE->modrate=modrate;
   if (pitchenv->pointc>0) {
     synth_env_init(&VOICE->pitchenv,pitchenv,velocity,durframes);
@@ -109,6 +143,7 @@ struct synth_voice *synth_voice_fm_new(
     VOICE->carrate=rate_norm*powf(2.0f,cents/1200.0f);
     voice->update=_fm_update_flat;
   }
-  VOICE->carrate*=M_PI*2.0f;
+  VOICE->carrate*=4294967296.0f;
+  VOICE->moddp=FM_STEP(VOICE->carrate*modrate);
   return voice;
 }
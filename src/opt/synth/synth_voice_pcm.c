@@ -5,7 +5,8 @@
  
 struct synth_voice_pcm {
   struct synth_voice hdr;
-  struct synth_pcm *pcm;
+  struct synth_pcm *pcm; // Null while (job) pending.
+  struct synth_print_job *job;
   int p;
   int loopp; // <0 for no loop
   float trim;
@@ -18,6 +19,7 @@ struct synth_voice_pcm {
  
 static void _pcm_del(struct synth_voice *voice) {
   synth_pcm_del(VOICE->pcm);
+  synth_print_job_del(VOICE->job);
 }
 
 /* Update.
@@ -34,9 +36,7 @@ static void _pcm_update_1(float *v,int c,struct synth_voice *voice) {
     }
     int updc=VOICE->pcm->c-VOICE->p;
     if (updc>c) updc=c;
-    int i=updc;
-    const float *src=VOICE->pcm->v+VOICE->p;
-    for (;i-->0;v++,src++) (*v)+=(*src);
+    synth_mix_add(v,VOICE->pcm->v+VOICE->p,updc);
     VOICE->p+=updc;
     v+=updc;
     c-=updc;
@@ -54,15 +54,33 @@ static void _pcm_update_trim(float *v,int c,struct synth_voice *voice) {
     }
     int updc=VOICE->pcm->c-VOICE->p;
     if (updc>c) updc=c;
-    int i=updc;
-    const float *src=VOICE->pcm->v+VOICE->p;
-    for (;i-->0;v++,src++) (*v)+=(*src)*VOICE->trim;
+    synth_mix_add_scaled(v,VOICE->pcm->v+VOICE->p,VOICE->trim,updc);
     VOICE->p+=updc;
     v+=updc;
     c-=updc;
   }
 }
 
+/* Waiting for background print.
+ * Keep time, so when it does come up, we're in the right place.
+ */
+ 
+static void _pcm_update_job(float *v,int c,struct synth_voice *voice) {
+  int err=synth_resolve_pcm(&VOICE->pcm,&VOICE->job);
+  if (err<0) {
+    voice->finished=1;
+    return;
+  }
+  if (!err) {
+    VOICE->p+=c;
+    return;
+  }
+  if (VOICE->loopp>=VOICE->pcm->c) VOICE->loopp=-1;
+  if (VOICE->trim>=1.0f) voice->update=_pcm_update_1;
+  else voice->update=_pcm_update_trim;
+  voice->update(v,c,voice);
+}
+
 /* Release.
  */
  
@@ -70,6 +88,15 @@ static void _pcm_release(struct synth_voice *voice) {
   // Do nothing. We'll finish naturally either way.
 }
 
+/* Level.
+ * We don't track it. Call it (trim), and released: One-shots can always be cut.
+ */
+ 
+static float _pcm_get_level(const struct synth_voice *voice,int *released) {
+  *released=1;
+  return VOICE->trim;
+}
+
 /* New.
  */
  
@@ -83,13 +110,14 @@ struct synth_voice *synth_voice_pcm_new(
   voice->magic='p';
   voice->del=_pcm_del;
   VOICE->loopp=-1;
+  VOICE->trim=trim;
   if (trim>=1.0f) {
     voice->update=_pcm_update_1;
   } else {
     voice->update=_pcm_update_trim;
-    VOICE->trim=trim;
   }
   voice->release=_pcm_release;
+  voice->get_level=_pcm_get_level;
   if (synth_pcm_ref(pcm)<0) {
     synth_voice_del(voice);
     return 0;
@@ -98,12 +126,34 @@ struct synth_voice *synth_voice_pcm_new(
   return voice;
 }
 
+struct synth_voice *synth_voice_pcm_new_job(
+  struct synth *synth,
+  struct synth_print_job *job,
+  float trim
+) {
+  struct synth_voice *voice=synth_voice_new(synth,sizeof(struct synth_voice_pcm));
+  if (!voice) return 0;
+  voice->magic='p';
+  voice->del=_pcm_del;
+  voice->update=_pcm_update_job;
+  voice->release=_pcm_release;
+  voice->get_level=_pcm_get_level;
+  VOICE->loopp=-1;
+  VOICE->trim=trim;
+  if (synth_print_job_ref(job)<0) {
+    synth_voice_del(voice);
+    return 0;
+  }
+  VOICE->job=job;
+  return voice;
+}
+
 /* Repeat position.
  */
 
 void synth_voice_pcm_set_repeat(struct synth_voice *voice,int frame) {
   if (!voice||(voice->magic!='p')) return;
-  if (frame>=VOICE->pcm->c) return;
+  if (VOICE->pcm&&(frame>=VOICE->pcm->c)) return;
   VOICE->loopp=frame;
 }
 
@@ -117,7 +167,7 @@ int synth_voice_pcm_get_position(const struct synth_voice *voice) {
  
 int synth_voice_pcm_set_position(struct synth_voice *voice,int p) {
   if (!voice||(voice->magic!='p')) return p;
-  if (p<0) p=0; else if (p>VOICE->pcm->c) p=VOICE->pcm->c;
+  if (p<0) p=0; else if (VOICE->pcm&&(p>VOICE->pcm->c)) p=VOICE->pcm->c;
   VOICE->p=p;
   voice->finished=0;
   return p;
@@ -129,6 +179,6 @@ int synth_voice_pcm_set_position(struct synth_voice *voice,int p) {
 void synth_voice_pcm_abort(struct synth_voice *voice) {
   if (!voice||(voice->magic!='p')) return;
   VOICE->loopp=-1;
-  VOICE->p=VOICE->pcm->c;
+  if (VOICE->pcm) VOICE->p=VOICE->pcm->c;
   voice->finished=1;
 }
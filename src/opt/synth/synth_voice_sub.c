@@ -42,26 +42,34 @@ static inline float synth_sub_apply_iir(float *mv,const float *cv,float dry) {
  */
  
 static void _sub_update(float *v,int c,struct synth_voice *voice) {
-  for (;c-->0;v++) {
+  float level[SYNTH_BLOCK_FRAMES];
+  float noise[SYNTH_BLOCK_FRAMES];
+  uint32_t seed=voice->synth->noise;
+  while (c>0) {
+    int updc=(c>SYNTH_BLOCK_FRAMES)?SYNTH_BLOCK_FRAMES:c;
+    int i=0; for (;i<updc;i++) {
   
-    // White noise.
-    float sample=((rand()&0xffff)-0x8000)/32768.0f;
+      // White noise.
+      seed^=seed<<13;
+      seed^=seed>>17;
+      seed^=seed<<5;
+      float sample=((int)(seed&0xffff)-0x8000)/32768.0f;
     
-    // IIR first pass.
-    sample=synth_sub_apply_iir(VOICE->mva,VOICE->cv,sample);
+      // IIR first pass.
+      sample=synth_sub_apply_iir(VOICE->mva,VOICE->cv,sample);
     
-    // IIR second pass.
-    sample=synth_sub_apply_iir(VOICE->mvb,VOICE->cv,sample);
+      // IIR second pass.
+      noise[i]=synth_sub_apply_iir(VOICE->mvb,VOICE->cv,sample);
+    }
     
-    // Gain and clip.
-    sample*=VOICE->gain;
-    if (sample<-1.0f) sample=-1.0f;
-    else if (sample>1.0f) sample=1.0f;
-    
-    // Envelope, and emit.
-    sample*=synth_env_next(VOICE->levelenv);
-    (*v)+=sample;
+    // Gain and clip, then envelope, and emit.
+    synth_mix_gain_clip(noise,VOICE->gain,updc);
+    synth_env_update(level,updc,&VOICE->levelenv);
+    synth_mix_add_product(v,level,noise,updc);
+    v+=updc;
+    c-=updc;
   }
+  voice->synth->noise=seed;
   if (VOICE->levelenv.finished) voice->finished=1;
 }
 
@@ -72,6 +80,14 @@ static void _sub_release(struct synth_voice *voice) {
   synth_env_release(&VOICE->levelenv);
 }
 
+/* Level.
+ */
+ 
+static float _sub_get_level(const struct synth_voice *voice,int *released) {
+  *released=synth_env_is_released(&VOICE->levelenv);
+  return VOICE->levelenv.v;
+}
+
 /* New.
  */
  
@@ -89,6 +105,7 @@ struct synth_voice *synth_voice_sub_new(
   voice->del=_sub_del;
   voice->update=_sub_update;
   voice->release=_sub_release;
+  voice->get_level=_sub_get_level;
   synth_env_init(&VOICE->levelenv,levelenv,velocity,durframes);
   
   if (mid_norm<0.0f) mid_norm=0.0f;
@@ -26,24 +26,40 @@ static void _wave_del(struct synth_voice *voice) {
  */
  
 static void _wave_update_flat(float *v,int c,struct synth_voice *voice) {
-  for (;c-->0;v++) {
-    float level=synth_env_next(VOICE->levelenv);
-    float sample=level*VOICE->wave->v[VOICE->p>>SYNTH_WAVE_SHIFT];
-    (*v)+=sample;
-    VOICE->p+=VOICE->dp;
+  float level[SYNTH_BLOCK_FRAMES];
+  float osc[SYNTH_BLOCK_FRAMES];
+  const float *wave=VOICE->wave->v;
+  while (c>0) {
+    int updc=(c>SYNTH_BLOCK_FRAMES)?SYNTH_BLOCK_FRAMES:c;
+    synth_env_update(level,updc,&VOICE->levelenv);
+    uint32_t p=VOICE->p,dp=VOICE->dp;
+    int i=0; for (;i<updc;i++,p+=dp) osc[i]=wave[p>>SYNTH_WAVE_SHIFT];
+    VOICE->p=p;
+    synth_mix_add_product(v,level,osc,updc);
+    v+=updc;
+    c-=updc;
   }
   if (VOICE->levelenv.finished) voice->finished=1;
 }
  
 static void _wave_update_pitchenv(float *v,int c,struct synth_voice *voice) {
-  for (;c-->0;v++) {
-    float level=synth_env_next(VOICE->levelenv);
-    float sample=level*VOICE->wave->v[VOICE->p>>SYNTH_WAVE_SHIFT];
-    (*v)+=sample;
-    float rate=synth_env_next(VOICE->pitchenv);
-    rate=VOICE->baserate*powf(2.0f,rate/1200.0f);
-    uint32_t dp=(uint32_t)(rate*4294967296.0f);
-    VOICE->p+=dp;
+  float level[SYNTH_BLOCK_FRAMES];
+  float osc[SYNTH_BLOCK_FRAMES];
+  const float *wave=VOICE->wave->v;
+  while (c>0) {
+    int updc=(c>SYNTH_BLOCK_FRAMES)?SYNTH_BLOCK_FRAMES:c;
+    synth_env_update(level,updc,&VOICE->levelenv);
+    synth_env_update(osc,updc,&VOICE->pitchenv);
+    uint32_t p=VOICE->p;
+    int i=0; for (;i<updc;i++) {
+      float rate=VOICE->baserate*synth_exp2(osc[i]/1200.0f);
+      osc[i]=wave[p>>SYNTH_WAVE_SHIFT];
+      p+=(uint32_t)(rate*4294967296.0f);
+    }
+    VOICE->p=p;
+    synth_mix_add_product(v,level,osc,updc);
+    v+=updc;
+    c-=updc;
   }
   if (VOICE->levelenv.finished) voice->finished=1;
 }
@@ -56,6 +72,14 @@ static void _wave_release(struct synth_voice *voice) {
   synth_env_release(&VOICE->pitchenv);
 }
 
+/* Level.
+ */
+ 
+static float _wave_get_level(const struct synth_voice *voice,int *released) {
+  *released=synth_env_is_released(&VOICE->levelenv);
+  return VOICE->levelenv.v;
+}
+
 /* New.
  */
  
@@ -73,6 +97,7 @@ struct synth_voice *synth_voice_wave_new(
   voice->magic='w';
   voice->del=_wave_del;
   voice->release=_wave_release;
+  voice->get_level=_wave_get_level;
   if (synth_wave_ref(wave)<0) {
     synth_voice_del(voice);
     return 0;
@@ -0,0 +1,139 @@
+#include "synth_internal.h"
+
+#if SYNTH_USE_THREADS
+
+#include <pthread.h>
+
+/* Jobs are submitted from the audio thread, eg drums at song start, so submission must not wait on the workers' work.
+ * (jobv) is a ring with one producer and many consumers.
+ * (job_head) is written only by the submitter, which is whoever owns the synth. That's always one thread at a time.
+ * (job_tail) is written only by workers, and only while holding (mutex).
+ * The submitter publishes (job_head), then takes (mutex) just to signal. Workers check for jobs under (mutex) and wait untimed,
+ * so the signal can't fall between a worker's check and its wait. Nobody holds (mutex) for more than a few instructions.
+ */
+
+struct synth_workers {
+  pthread_t threadv[SYNTH_WORKER_LIMIT];
+  int threadc;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  struct synth_print_job *jobv[SYNTH_WORKER_QUEUE_SIZE]; // STRONG while between (job_tail) and (job_head).
+  unsigned int job_head;
+  unsigned int job_tail;
+  int stop;
+};
+
+/* Take the next job, or wait for one. Call holding (mutex).
+ */
+ 
+static struct synth_print_job *synth_workers_take(struct synth_workers *workers) {
+  unsigned int head=__atomic_load_n(&workers->job_head,__ATOMIC_ACQUIRE);
+  unsigned int tail=workers->job_tail;
+  if (head==tail) {
+    pthread_cond_wait(&workers->cond,&workers->mutex);
+    return 0;
+  }
+  struct synth_print_job *job=workers->jobv[tail&(SYNTH_WORKER_QUEUE_SIZE-1)];
+  __atomic_store_n(&workers->job_tail,tail+1,__ATOMIC_RELEASE);
+  return job;
+}
+
+/* Worker thread.
+ */
+ 
+static void *synth_worker_main(void *arg) {
+  struct synth_workers *workers=arg;
+  while (1) {
+    pthread_mutex_lock(&workers->mutex);
+    struct synth_print_job *job=0;
+    while (!workers->stop&&!(job=synth_workers_take(workers))) ;
+    pthread_mutex_unlock(&workers->mutex);
+    if (!job) return 0;
+    
+    // If we hold the only reference, nobody wants it anymore.
+    if (__atomic_load_n(&job->refc,__ATOMIC_ACQUIRE)>1) {
+      synth_print_job_run(job);
+    }
+    synth_print_job_del(job);
+  }
+}
+
+/* Delete.
+ */
+ 
+void synth_workers_del(struct synth_workers *workers) {
+  if (!workers) return;
+  pthread_mutex_lock(&workers->mutex);
+  workers->stop=1;
+  pthread_cond_broadcast(&workers->cond);
+  pthread_mutex_unlock(&workers->mutex);
+  while (workers->threadc>0) {
+    workers->threadc--;
+    pthread_join(workers->threadv[workers->threadc],0);
+  }
+  for (;workers->job_tail!=workers->job_head;workers->job_tail++) {
+    synth_print_job_del(workers->jobv[workers->job_tail&(SYNTH_WORKER_QUEUE_SIZE-1)]);
+  }
+  pthread_cond_destroy(&workers->cond);
+  pthread_mutex_destroy(&workers->mutex);
+  free(workers);
+}
+
+/* New.
+ */
+ 
+struct synth_workers *synth_workers_new(int threadc) {
+  if ((threadc<1)||(threadc>SYNTH_WORKER_LIMIT)) return 0;
+  struct synth_workers *workers=calloc(1,sizeof(struct synth_workers));
+  if (!workers) return 0;
+  if (pthread_mutex_init(&workers->mutex,0)) {
+    free(workers);
+    return 0;
+  }
+  if (pthread_cond_init(&workers->cond,0)) {
+    pthread_mutex_destroy(&workers->mutex);
+    free(workers);
+    return 0;
+  }
+  while (workers->threadc<threadc) {
+    if (pthread_create(workers->threadv+workers->threadc,0,synth_worker_main,workers)) {
+      synth_workers_del(workers);
+      return 0;
+    }
+    workers->threadc++;
+  }
+  return workers;
+}
+
+/* Submit job.
+ * Never waits for a job to finish; the mutex is only ever held briefly. Fails if the ring is full, and caller should print some other way.
+ */
+ 
+int synth_workers_submit(struct synth_workers *workers,struct synth_print_job *job) {
+  if (!workers||!job) return -1;
+  unsigned int head=workers->job_head;
+  unsigned int tail=__atomic_load_n(&workers->job_tail,__ATOMIC_ACQUIRE);
+  if (head-tail>=SYNTH_WORKER_QUEUE_SIZE) return -1;
+  if (synth_print_job_ref(job)<0) return -1;
+  workers->jobv[head&(SYNTH_WORKER_QUEUE_SIZE-1)]=job;
+  __atomic_store_n(&workers->job_head,head+1,__ATOMIC_RELEASE);
+  pthread_mutex_lock(&workers->mutex);
+  pthread_cond_signal(&workers->cond);
+  pthread_mutex_unlock(&workers->mutex);
+  return 0;
+}
+
+#else
+
+void synth_workers_del(struct synth_workers *workers) {
+}
+
+struct synth_workers *synth_workers_new(int threadc) {
+  return 0;
+}
+
+int synth_workers_submit(struct synth_workers *workers,struct synth_print_job *job) {
+  return -1;
+}
+
+#endif
@@ -5,7 +5,16 @@ struct strings strings={0};
 /* Cleanup.
  */
  
+static void strings_drop_offsets() {
+  if (!strings.offsetsv) return;
+  int i=strings.resc;
+  while (i-->0) if (strings.offsetsv[i].v) free(strings.offsetsv[i].v);
+  free(strings.offsetsv);
+  strings.offsetsv=0;
+}
+ 
 void strings_cleanup() {
+  strings_drop_offsets();
   if (strings.resv) free(strings.resv);
   memset(&strings,0,sizeof(strings));
 }
@@ -18,14 +27,15 @@ void strings_cleanup() {
 static int strings_toc_append(int tid,int rid,const void *v,int c) {
   if (strings.resc>=strings.resa) {
     int na=strings.resa+64;
-    if (na>INT_MAX/sizeof(struct text_res)) return -1;
-    void *nv=realloc(strings.resv,sizeof(struct text_res)*na);
+    if (na>INT_MAX/sizeof(struct rom_res)) return -1;
+    void *nv=realloc(strings.resv,sizeof(struct rom_res)*na);
     if (!nv) return -1;
     strings.resv=nv;
     strings.resa=na;
   }
-  struct text_res *res=strings.resv+strings.resc++;
-  res->id=(tid<<16)|rid;
+  struct rom_res *res=strings.resv+strings.resc++;
+  res->tid=tid;
+  res->rid=rid;
   res->v=v;
   res->c=c;
   return 0;
@@ -36,6 +46,7 @@ static int strings_toc_append(int tid,int rid,const void *v,int c) {
  
 void strings_set_rom(const void *src,int srcc) {
   if (!src||(srcc<0)) srcc=0;
+  strings_drop_offsets();
   strings.rom=src;
   strings.romc=srcc;
   strings.resc=0;
@@ -48,6 +59,7 @@ void strings_set_rom(const void *src,int srcc) {
       }
     }
   }
+  rom_index_init(&strings.index,strings.resv,strings.resc,sizeof(struct rom_res));
 }
 
 /* Recheck global language.
@@ -55,10 +67,47 @@ void strings_set_rom(const void *src,int srcc) {
  
 void strings_check_language() {
   strings.lang=egg_get_language();
-  // Turns out, we're not caching anything based on current language, so nothing more to do.
+  // Offsets are cached per resource, and each language is its own resource, so nothing to drop.
+}
+
+/* Build the offsets index for one strings resource.
+ * Same walk as rom_read_strings, except we keep empties.
+ */
+ 
+static void strings_build_offsets(struct strings_offsets *offsets,const uint8_t *src,int srcc) {
+  offsets->c=-1;
+  if ((srcc<4)||(src[0]!=0x00)||(src[1]!='E')||(src[2]!='S')||(src[3]!=0xff)) return;
+  int a=(srcc-4)>>2; // Guess; we'll grow if needed. Empties are one byte, so worst case is (srcc-4).
+  if (a<8) a=8;
+  int *v=malloc(sizeof(int)*a);
+  if (!v) return;
+  int c=0,srcp=4;
+  while (srcp<srcc) {
+    int p=srcp;
+    int len=src[srcp++];
+    if (len&0x80) {
+      if (srcp>=srcc) break;
+      len=((len&0x7f)<<8)|src[srcp++];
+    }
+    if (srcp>srcc-len) break;
+    srcp+=len;
+    if (c>=a) {
+      int na=a<<1;
+      if (na>INT_MAX/sizeof(int)) { free(v); return; }
+      void *nv=realloc(v,sizeof(int)*na);
+      if (!nv) { free(v); return; }
+      v=nv;
+      a=na;
+    }
+    v[c++]=p;
+  }
+  offsets->v=v;
+  offsets->c=c;
 }
 
 /* Get string.
+ * First access to each resource indexes it, then every lookup is O(1).
+ * If indexing fails, we fall back to scanning.
  */
  
 struct strings_get_ctx {
@@ -84,20 +133,25 @@ int strings_get(void *dstpp,int rid,int index) {
     if (!strings.lang) strings.lang=egg_get_language();
     rid|=strings.lang<<6;
   }
-  uint32_t id=(EGG_TID_strings<<16)|rid;
-  int lo=0,hi=strings.resc;
-  while (lo<hi) {
-    int ck=(lo+hi)>>1;
-    uint32_t q=strings.resv[ck].id;
-         if (id<q) hi=ck;
-    else if (id>q) lo=ck;
-    else {
-      struct strings_get_ctx ctx={.dstpp=dstpp,.index=index};
-      rom_read_strings(strings.resv[ck].v,strings.resv[ck].c,strings_get_cb,&ctx);
-      return ctx.dstc;
+  int p=rom_index_search(&strings.index,EGG_TID_strings,rid);
+  if (p<0) return 0;
+  const struct rom_res *res=strings.resv+p;
+  if (!strings.offsetsv) strings.offsetsv=calloc(strings.resc,sizeof(struct strings_offsets));
+  if (strings.offsetsv) {
+    struct strings_offsets *offsets=strings.offsetsv+p;
+    if (!offsets->v&&!offsets->c) strings_build_offsets(offsets,res->v,res->c);
+    if (offsets->c>=0) {
+      if (index>=offsets->c) return 0;
+      const uint8_t *src=(const uint8_t*)res->v+offsets->v[index];
+      int len=*(src++);
+      if (len&0x80) len=((len&0x7f)<<8)|*(src++);
+      *(const void**)dstpp=src;
+      return len;
     }
   }
-  return 0;
+  struct strings_get_ctx ctx={.dstpp=dstpp,.index=index};
+  rom_read_strings(res->v,res->c,strings_get_cb,&ctx);
+  return ctx.dstc;
 }
 
 /* Represent signed decimal integer.
@@ -183,13 +237,11 @@ int strings_format(char *dst,int dsta,int rid,int index,const struct strings_ins
 int strings_lang_by_index(int p) {
   if (p<0) return -1;
   int pvlang=-1;
-  const struct text_res *res=strings.resv;
-  int i=strings.resc;
+  const struct rom_index_type *type=strings.index.typev+EGG_TID_strings;
+  const struct rom_res *res=strings.resv+type->p;
+  int i=type->c;
   for (;i-->0;res++) {
-    int tid=(res->id>>16)&0xffff;
-    if (tid!=EGG_TID_strings) continue;
-    int rid=res->id&0xffff;
-    int lang=rid>>6;
+    int lang=res->rid>>6;
     if (lang!=pvlang) {
       if (!p--) return lang;
       pvlang=lang;
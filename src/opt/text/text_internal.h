@@ -11,12 +11,14 @@ extern struct strings {
   int romc;
   int lang;
   // We only record "strings" and "image" resources:
-  struct text_res {
-    uint32_t id; // (tid<<16)|rid
-    const void *v;
-    int c;
-  } *resv;
+  struct rom_res *resv;
   int resc,resa;
+  struct rom_index index; // Over (resv).
+  // Parallel to (resv), allocated on first strings_get. Each strings resource indexes itself on first access.
+  struct strings_offsets {
+    int *v; // Offset of each string's length prefix, by string index. Empties included. Null if not built yet.
+    int c; // Count of strings, or -1 if indexing failed and we must scan instead.
+  } *offsetsv;
 } strings;
 
 struct font {
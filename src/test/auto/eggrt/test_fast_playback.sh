@@ -0,0 +1,77 @@
+#!/bin/bash
+# test_fast_playback.sh
+# Play the same recording through the demo twice with --fast-playback, and demand identical hashes.
+# Also check what --render-every means for the hashes: Skipped frames hash only input and store, rendered frames add the framebuffer.
+
+. src/test/common/egg_test.sh
+
+EXE=out/demo.true
+TMP=mid/test/fastpb-tmp
+
+# Recording: (u16be input state, u8 additional frames) repeated.
+# Idle, then SOUTH into a menu, DOWN, SOUTH again, idle a while, WEST to back out, and idle to the end.
+make_recording() {
+  printf '\x00\x00\x14\x00\x10\x01\x00\x00\x1e\x00\x08\x01\x00\x00\x05\x00\x10\x01\x00\x00\x3c\x00\x20\x01\x00\x00\x0a' >$TMP.rec
+}
+
+# $1=render-every, $2=output basename. Writes $2.hashes, and $2.log with the chained hash.
+play() {
+  $EXE --playback=$TMP.rec --fast-playback --input=none --render-every=$1 --playback-hashes=$2.hashes 2>&1 | \
+    sed -En 's/.*State hash ([0-9a-f]+).*/\1/p' >$2.log
+  if [ ! -s $2.log ] ; then
+    echo "EGG_TEST DETAIL $EXE didn't report a state hash"
+    return 1
+  fi
+  if [ ! -s $2.hashes ] ; then
+    echo "EGG_TEST DETAIL $EXE didn't write per-frame hashes"
+    return 1
+  fi
+}
+
+fast_playback_repeatable() {
+  play 1 $TMP-a || return 1
+  play 1 $TMP-b || return 1
+  if ! cmp -s $TMP-a.log $TMP-b.log ; then
+    echo "EGG_TEST DETAIL Chained hash differs: $(cat $TMP-a.log) vs $(cat $TMP-b.log)"
+    return 1
+  fi
+  if ! cmp -s $TMP-a.hashes $TMP-b.hashes ; then
+    echo "EGG_TEST DETAIL Per-frame hashes differ, first at: $(diff $TMP-a.hashes $TMP-b.hashes | head -n2 | tail -n1)"
+    return 1
+  fi
+  # And the recording must have actually done something, or this proves nothing.
+  if [ "$(cut -d' ' -f3 $TMP-a.hashes | sort -u | wc -l)" -lt 3 ] ; then
+    echo "EGG_TEST DETAIL Expected the picture to change during playback"
+    return 1
+  fi
+}
+
+fast_playback_render_every() {
+  play 1 $TMP-all || return 1
+  play 0 $TMP-none || return 1
+  play 4 $TMP-4a || return 1
+  play 4 $TMP-4b || return 1
+  if ! cmp -s $TMP-4a.hashes $TMP-4b.hashes ; then
+    echo "EGG_TEST DETAIL --render-every=4 is not repeatable"
+    return 1
+  fi
+  # Rendered frames (every 4th, from zero) match the all-rendered run, and the rest match the never-rendered run.
+  local expect=$TMP-4x.hashes
+  paste -d' ' $TMP-all.hashes $TMP-none.hashes | awk '{ if ($1%4) print $4,$5,$6; else print $1,$2,$3; }' >$expect
+  if ! cmp -s $expect $TMP-4a.hashes ; then
+    echo "EGG_TEST DETAIL --render-every=4 hashes don't line up with 1 and 0: $(diff $expect $TMP-4a.hashes | head -n2 | tail -n1)"
+    return 1
+  fi
+}
+
+if [ ! -x $EXE ] ; then
+  echo "EGG_TEST SKIP fast_playback_repeatable $0 $EXE not built"
+  echo "EGG_TEST SKIP fast_playback_render_every $0 $EXE not built"
+  exit 0
+fi
+
+mkdir -p mid/test
+make_recording
+EGG_ATEST fast_playback_repeatable
+EGG_ATEST fast_playback_render_every
+rm -f $TMP*
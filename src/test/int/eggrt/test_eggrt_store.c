@@ -0,0 +1,106 @@
+#include "test/egg_test.h"
+#include "eggrt/eggrt_store.c"
+#include <sys/stat.h>
+
+/* eggrt isn't part of itest, so we build eggrt_store.c right in, and supply the globals it touches.
+ * Files go under mid/test, which exists whenever tests do.
+ */
+
+struct eggrt eggrt={0};
+
+double eggrt_now_real() {
+  return 0.0;
+}
+
+static int eggrt_store_test_expect(const char *path,const char *expect) {
+  void *src=0;
+  int srcc=file_read(&src,path);
+  EGG_ASSERT(srcc>=0,"%s",path)
+  int expectc=0; while (expect[expectc]) expectc++;
+  EGG_ASSERT_STRINGS(src,srcc,expect,expectc)
+  free(src);
+  char tmppath[2048];
+  snprintf(tmppath,sizeof(tmppath),"%s.tmp",path);
+  EGG_ASSERT(file_read(&src,tmppath)<0,"Temp file left behind: %s",tmppath)
+  return 0;
+}
+
+static int eggrt_store_test_set(const char *v) {
+  struct eggrt_store_field *field=eggrt_store_get_field("k",1,1);
+  EGG_ASSERT(field)
+  EGG_ASSERT_CALL(eggrt_store_set_field(field,v,-1))
+  EGG_ASSERT(eggrt.store_dirty)
+  return 0;
+}
+
+/* Saves go through the writer thread, the newest of two quick saves lands, and quit flushes.
+ */
+
+EGG_ITEST(eggrt_store_background_save) {
+  eggrt.exename="itest";
+  eggrt.storepath="mid/test/eggrt_store_writer.save";
+  eggrt.store_interval_ms=0;
+  unlink(eggrt.storepath);
+
+  EGG_ASSERT_CALL(eggrt_store_test_set("one"))
+  EGG_ASSERT_CALL(eggrt_store_update())
+  EGG_ASSERT_NOT(eggrt.store_dirty)
+  #if EGGRT_STORE_USE_THREADS
+    EGG_ASSERT(eggrt_store_writer.running,"Writer thread should have started.")
+  #endif
+  EGG_ASSERT_CALL(eggrt_store_test_set("two"))
+  EGG_ASSERT_CALL(eggrt_store_update())
+  eggrt_store_flush();
+  EGG_ASSERT_CALL(eggrt_store_test_expect(eggrt.storepath,"{\"k\":\"two\"}\n"))
+
+  // Dirty at quit: Quit must save it and wait for the write before stopping the thread.
+  EGG_ASSERT_CALL(eggrt_store_test_set("three"))
+  eggrt_store_quit();
+  EGG_ASSERT_NOT(eggrt.store_dirty)
+  #if EGGRT_STORE_USE_THREADS
+    EGG_ASSERT_NOT(eggrt_store_writer.running)
+  #endif
+  EGG_ASSERT_INTS(eggrt.storec,0)
+  EGG_ASSERT_CALL(eggrt_store_test_expect(eggrt.storepath,"{\"k\":\"three\"}\n"))
+
+  unlink(eggrt.storepath);
+  eggrt.storepath=0;
+  return 0;
+}
+
+/* A path longer than any fixed buffer still saves through the temp file.
+ */
+
+EGG_ITEST(eggrt_store_long_path) {
+  char path[2048];
+  int pathc=snprintf(path,sizeof(path),"mid/test/eggrt_store_long");
+  mkdir(path,0777);
+  int dirc=0;
+  while (pathc<1100) {
+    path[pathc++]='/';
+    memset(path+pathc,'a'+dirc,200);
+    pathc+=200;
+    path[pathc]=0;
+    mkdir(path,0777);
+    dirc++;
+  }
+  memcpy(path+pathc,"/x.save",8);
+  EGG_ASSERT(pathc>1024)
+  eggrt.exename="itest";
+  eggrt.storepath=path;
+  eggrt.store_interval_ms=0;
+
+  EGG_ASSERT_CALL(eggrt_store_test_set("long"))
+  eggrt_store_quit();
+  EGG_ASSERT_CALL(eggrt_store_test_expect(path,"{\"k\":\"long\"}\n"))
+
+  unlink(path);
+  while (dirc-->0) {
+    path[pathc]=0;
+    rmdir(path);
+    pathc-=201;
+  }
+  rmdir("mid/test/eggrt_store_long");
+  eggrt.storepath=0;
+  return 0;
+}
@@ -0,0 +1,248 @@
+#include "test/egg_test.h"
+#define USE_REAL_STDLIB 1
+#include "opt/graf/texatlas.c"
+
+/* texatlas.c is a client library, so we supply the platform calls it makes, and the two graf calls.
+ * Image resources are imaginary: (rid) is (w<<16)|(h<<8)|serial, so each test can ask for whatever sizes it likes.
+ */
+
+static struct texatlas_test {
+  int texidnext;
+  int livec; // Textures created and not yet deleted.
+  int loadc; // egg_texture_load_image_sub calls.
+  int last_texid,last_x,last_y,last_w,last_h,last_rid;
+  int flushc;
+  int decalc;
+  int decal_texid,decal_srcx,decal_srcy,decal_w,decal_h;
+  int fail_rid; // egg_texture_load_image_sub fails for this one.
+} texatlas_test={0};
+
+#define TEXATLAS_TEST_RID(w,h,serial) (((w)<<16)|((h)<<8)|(serial))
+
+int egg_texture_new() {
+  texatlas_test.livec++;
+  return ++(texatlas_test.texidnext);
+}
+
+void egg_texture_del(int texid) {
+  texatlas_test.livec--;
+}
+
+int egg_texture_load_raw(int texid,int w,int h,int stride,const void *src,int srcc) {
+  if ((w!=TEXATLAS_PAGE_SIZE)||(h!=TEXATLAS_PAGE_SIZE)) return -1;
+  if (src||srcc) return -1; // Pages should allocate only, never upload.
+  return 0;
+}
+
+int egg_image_get_size(int *w,int *h,int rid) {
+  *w=rid>>16;
+  *h=(rid>>8)&0xff;
+  return 0;
+}
+
+int egg_texture_load_image_sub(int texid,int x,int y,int w,int h,int rid) {
+  if (rid==texatlas_test.fail_rid) return -1;
+  if ((rid>>16)>w) return -1;
+  if (((rid>>8)&0xff)>h) return -1;
+  if ((x<0)||(y<0)||(x>TEXATLAS_PAGE_SIZE-w)||(y>TEXATLAS_PAGE_SIZE-h)) return -1;
+  texatlas_test.loadc++;
+  texatlas_test.last_texid=texid;
+  texatlas_test.last_x=x;
+  texatlas_test.last_y=y;
+  texatlas_test.last_w=w;
+  texatlas_test.last_h=h;
+  texatlas_test.last_rid=rid;
+  return 0;
+}
+
+void graf_flush(struct graf *graf) {
+  texatlas_test.flushc++;
+}
+
+void graf_draw_decal(struct graf *graf,int srctexid,int16_t dstx,int16_t dsty,int16_t srcx,int16_t srcy,int16_t w,int16_t h,uint8_t xform) {
+  texatlas_test.decalc++;
+  texatlas_test.decal_texid=srctexid;
+  texatlas_test.decal_srcx=srcx;
+  texatlas_test.decal_srcy=srcy;
+  texatlas_test.decal_w=w;
+  texatlas_test.decal_h=h;
+}
+
+/* Images share a page and don't overlap, and hits don't reload.
+ */
+
+EGG_ITEST(texatlas_placement) {
+  memset(&texatlas_test,0,sizeof(texatlas_test));
+  struct texatlas ta={0};
+  const int sizev[]={16,16, 40,20, 8,30, 100,16, 16,16, 64,64};
+  const int imagec=sizeof(sizev)/(sizeof(int)*2);
+  int xv[6],yv[6],texid0=0;
+  int i=0; for (;i<imagec;i++) {
+    int rid=TEXATLAS_TEST_RID(sizev[i*2],sizev[i*2+1],i);
+    int w=0,h=0;
+    int texid=texatlas_get_image(xv+i,yv+i,&w,&h,&ta,rid);
+    EGG_ASSERT(texid>0,"image %d",i)
+    if (!i) texid0=texid;
+    EGG_ASSERT_INTS(texid,texid0,"All these small images should land on one page.")
+    EGG_ASSERT_INTS(w,sizev[i*2])
+    EGG_ASSERT_INTS(h,sizev[i*2+1])
+    EGG_ASSERT_INTS(texatlas_test.loadc,i+1)
+    EGG_ASSERT_INTS(texatlas_test.last_rid,rid)
+    EGG_ASSERT_INTS(texatlas_test.last_x,xv[i])
+    EGG_ASSERT_INTS(texatlas_test.last_y,yv[i])
+    EGG_ASSERT_INTS(texatlas_test.last_w,w+TEXATLAS_GUTTER,"Slot includes the gutter, so the load clears it.")
+    EGG_ASSERT_INTS(texatlas_test.last_h,h+TEXATLAS_GUTTER)
+  }
+  EGG_ASSERT_INTS(ta.pagec,1)
+  EGG_ASSERT_INTS(texatlas_test.livec,1)
+
+  // No two slots overlap.
+  for (i=0;i<imagec;i++) {
+    int j=i+1; for (;j<imagec;j++) {
+      int apart=(
+        (xv[i]+sizev[i*2]+TEXATLAS_GUTTER<=xv[j])||(xv[j]+sizev[j*2]+TEXATLAS_GUTTER<=xv[i])||
+        (yv[i]+sizev[i*2+1]+TEXATLAS_GUTTER<=yv[j])||(yv[j]+sizev[j*2+1]+TEXATLAS_GUTTER<=yv[i])
+      );
+      EGG_ASSERT(apart,"images %d and %d overlap",i,j)
+    }
+  }
+
+  // Asking again is a hit.
+  int x=0,y=0;
+  EGG_ASSERT_INTS(texatlas_get_image(&x,&y,0,0,&ta,TEXATLAS_TEST_RID(40,20,1)),texid0)
+  EGG_ASSERT_INTS(x,xv[1])
+  EGG_ASSERT_INTS(y,yv[1])
+  EGG_ASSERT_INTS(texatlas_test.loadc,imagec)
+
+  // Too big for the atlas at all.
+  EGG_ASSERT_INTS(texatlas_get_image(0,0,0,0,&ta,TEXATLAS_TEST_RID(TEXATLAS_IMAGE_SIZE_LIMIT+1,8,0)),0)
+
+  // graf_draw_image draws the image's sub-rect from its page.
+  graf_draw_image((struct graf*)&ta,&ta,TEXATLAS_TEST_RID(8,30,2),10,10,0);
+  EGG_ASSERT_INTS(texatlas_test.decalc,1)
+  EGG_ASSERT_INTS(texatlas_test.decal_texid,texid0)
+  EGG_ASSERT_INTS(texatlas_test.decal_srcx,xv[2])
+  EGG_ASSERT_INTS(texatlas_test.decal_srcy,yv[2])
+  EGG_ASSERT_INTS(texatlas_test.decal_w,8)
+  EGG_ASSERT_INTS(texatlas_test.decal_h,30)
+
+  texatlas_cleanup(&ta);
+  EGG_ASSERT_INTS(texatlas_test.livec,0)
+  return 0;
+}
+
+/* Fill every entry, then the least recently used one that fits gets evicted, and its slot reused in place.
+ */
+
+EGG_ITEST(texatlas_evict_lru) {
+  memset(&texatlas_test,0,sizeof(texatlas_test));
+  struct texatlas ta={0};
+  struct graf *graf=(struct graf*)&ta; // Never dereferenced; our graf_flush just counts.
+  ta.graf=graf;
+  int i=0; for (;i<TEXATLAS_IMAGE_LIMIT;i++) {
+    int w=(i&1)?32:16;
+    EGG_ASSERT(texatlas_get_image(0,0,0,0,&ta,TEXATLAS_TEST_RID(w,16,i)),"image %d",i)
+  }
+  EGG_ASSERT_INTS(ta.entryc,TEXATLAS_IMAGE_LIMIT)
+  EGG_ASSERT_INTS(ta.evictc,0)
+  EGG_ASSERT_INTS(texatlas_test.flushc,0)
+
+  // Touch images 1 and 3, so image 5 is the oldest wide one.
+  // A wide newcomer must go there, not in narrow image 0's slot, even though image 0 is older.
+  int x1=0,y1=0,texid;
+  EGG_ASSERT(texid=texatlas_get_image(&x1,&y1,0,0,&ta,TEXATLAS_TEST_RID(32,16,1)))
+  EGG_ASSERT(texatlas_get_image(0,0,0,0,&ta,TEXATLAS_TEST_RID(32,16,3)))
+  int loadc0=texatlas_test.loadc;
+  int x5=0,y5=0;
+  for (i=0;i<ta.entryc;i++) if (ta.entryv[i].imageid==TEXATLAS_TEST_RID(32,16,5)) { x5=ta.entryv[i].x; y5=ta.entryv[i].y; }
+  int x=0,y=0,w=0,h=0;
+  EGG_ASSERT_INTS(texatlas_get_image(&x,&y,&w,&h,&ta,TEXATLAS_TEST_RID(30,12,100)),texid)
+  EGG_ASSERT_INTS(x,x5)
+  EGG_ASSERT_INTS(y,y5)
+  EGG_ASSERT_INTS(w,30)
+  EGG_ASSERT_INTS(h,12)
+  EGG_ASSERT_INTS(ta.entryc,TEXATLAS_IMAGE_LIMIT)
+  EGG_ASSERT_INTS(ta.evictc,1)
+  EGG_ASSERT_INTS(texatlas_test.flushc,1,"Must flush graf before overwriting a slot that pending draws may reference.")
+  EGG_ASSERT_INTS(texatlas_test.loadc,loadc0+1)
+
+  // Loaded into the whole old slot, so the leftover from the larger image gets cleared.
+  EGG_ASSERT_INTS(texatlas_test.last_x,x5)
+  EGG_ASSERT_INTS(texatlas_test.last_y,y5)
+  EGG_ASSERT_INTS(texatlas_test.last_w,32+TEXATLAS_GUTTER)
+  EGG_ASSERT_INTS(texatlas_test.last_h,16+TEXATLAS_GUTTER)
+
+  // The evicted image is gone, and the touched ones are still there.
+  for (i=0;i<ta.entryc;i++) EGG_ASSERT(ta.entryv[i].imageid!=TEXATLAS_TEST_RID(32,16,5))
+  EGG_ASSERT_INTS(texatlas_get_image(&x,&y,0,0,&ta,TEXATLAS_TEST_RID(32,16,1)),texid)
+  EGG_ASSERT_INTS(x,x1)
+  EGG_ASSERT_INTS(y,y1)
+  EGG_ASSERT_INTS(texatlas_test.loadc,loadc0+1)
+
+  // Nothing has a slot this tall, so we fail without evicting.
+  EGG_ASSERT_INTS(texatlas_get_image(0,0,0,0,&ta,TEXATLAS_TEST_RID(16,40,200)),0)
+  EGG_ASSERT_INTS(ta.evictc,1)
+
+  texatlas_cleanup(&ta);
+  EGG_ASSERT_INTS(texatlas_test.livec,0)
+  return 0;
+}
+
+/* A load that fails frees its slot, whether it was new or evicted, and the next image that fits takes it without evicting.
+ */
+
+EGG_ITEST(texatlas_failed_load) {
+  memset(&texatlas_test,0,sizeof(texatlas_test));
+  struct texatlas ta={0};
+  ta.graf=(struct graf*)&ta;
+
+  // Failing into a new slot.
+  int bad0=TEXATLAS_TEST_RID(16,16,90);
+  texatlas_test.fail_rid=bad0;
+  EGG_ASSERT_INTS(texatlas_get_image(0,0,0,0,&ta,bad0),0)
+  EGG_ASSERT_INTS(ta.entryc,1)
+  EGG_ASSERT_INTS(ta.entryv[0].imageid,0)
+  int x=0,y=0;
+  EGG_ASSERT(texatlas_get_image(&x,&y,0,0,&ta,TEXATLAS_TEST_RID(16,16,0)))
+  EGG_ASSERT_INTS(ta.entryc,1,"Should have taken the freed slot.")
+  EGG_ASSERT_INTS(x,ta.entryv[0].x)
+  EGG_ASSERT_INTS(y,ta.entryv[0].y)
+
+  // Fill up, then fail into an evicted slot.
+  int i=1; for (;i<TEXATLAS_IMAGE_LIMIT;i++) {
+    EGG_ASSERT(texatlas_get_image(0,0,0,0,&ta,TEXATLAS_TEST_RID(16,16,i)),"image %d",i)
+  }
+  EGG_ASSERT_INTS(ta.evictc,0)
+  int bad1=TEXATLAS_TEST_RID(16,16,91);
+  texatlas_test.fail_rid=bad1;
+  EGG_ASSERT_INTS(texatlas_get_image(0,0,0,0,&ta,bad1),0)
+  EGG_ASSERT_INTS(ta.evictc,1)
+  int freep=-1;
+  for (i=0;i<ta.entryc;i++) {
+    EGG_ASSERT(ta.entryv[i].imageid!=bad1)
+    if (!ta.entryv[i].imageid) freep=i;
+  }
+  EGG_ASSERT(freep>=0,"Expected a free slot after the failed load.")
+  EGG_ASSERT_INTS(texatlas_get_image(0,0,0,0,&ta,0),0,"Image zero must not match the free slot.")
+
+  // Asking for the failed image again retries and fails again, still not evicting anything new.
+  EGG_ASSERT_INTS(texatlas_get_image(0,0,0,0,&ta,bad1),0)
+  EGG_ASSERT_INTS(ta.evictc,1)
+
+  // Next one takes the free slot, and everything else is still resident.
+  texatlas_test.fail_rid=0;
+  int loadc0=texatlas_test.loadc;
+  EGG_ASSERT(texatlas_get_image(&x,&y,0,0,&ta,TEXATLAS_TEST_RID(16,16,100)))
+  EGG_ASSERT_INTS(x,ta.entryv[freep].x)
+  EGG_ASSERT_INTS(y,ta.entryv[freep].y)
+  EGG_ASSERT_INTS(ta.evictc,1)
+  for (i=1;i<TEXATLAS_IMAGE_LIMIT;i++) {
+    EGG_ASSERT(texatlas_get_image(0,0,0,0,&ta,TEXATLAS_TEST_RID(16,16,i)),"image %d",i)
+  }
+  EGG_ASSERT_INTS(texatlas_test.loadc,loadc0+1,"Images 1..%d should all still be resident.",TEXATLAS_IMAGE_LIMIT-1)
+  EGG_ASSERT_INTS(ta.evictc,1)
+
+  texatlas_cleanup(&ta);
+  EGG_ASSERT_INTS(texatlas_test.livec,0)
+  return 0;
+}
@@ -0,0 +1,261 @@
+#include "test/egg_test.h"
+#include "opt/image/image.h"
+#include "opt/serial/serial.h"
+#include "opt/fs/fs.h"
+#include <zlib.h>
+#include <time.h>
+
+/* Compose a PNG by hand, so we control the filter on every row.
+ * (raw) is unfiltered pixels at minimum stride. Row (y) uses filter (y+filter0)%5.
+ * Our encoder picks filters by heuristic and we want to be sure every unfilter gets exercised, at every row including the first.
+ */
+
+static uint8_t png_test_paeth(uint8_t a,uint8_t b,uint8_t c) {
+  int p=a+b-c;
+  int pa=abs(p-a),pb=abs(p-b),pc=abs(p-c);
+  if ((pa<=pb)&&(pa<=pc)) return a;
+  if (pb<=pc) return b;
+  return c;
+}
+
+static int png_test_chunk(struct sr_encoder *dst,const char *type,const void *v,int c) {
+  if (sr_encode_intbe(dst,c,4)<0) return -1;
+  int p=dst->c;
+  if (sr_encode_raw(dst,type,4)<0) return -1;
+  if (sr_encode_raw(dst,v,c)<0) return -1;
+  return sr_encode_intbe(dst,crc32(crc32(0,0,0),(uint8_t*)dst->v+p,4+c),4);
+}
+
+static int png_test_compose(
+  struct sr_encoder *dst,
+  const uint8_t *raw,int w,int h,int depth,int colortype,int pixelsize,
+  int filter0
+) {
+  int stride=(w*pixelsize+7)>>3;
+  int xstride=pixelsize>>3;
+  if (xstride<1) xstride=1;
+  int filteredc=(1+stride)*h;
+  uint8_t *filtered=malloc(filteredc);
+  if (!filtered) return -1;
+  uint8_t *fp=filtered;
+  int y=0; for (;y<h;y++) {
+    const uint8_t *row=raw+y*stride;
+    const uint8_t *prv=y?(row-stride):0;
+    int filter=(y+filter0)%5;
+    *(fp++)=filter;
+    int x=0; for (;x<stride;x++,fp++) {
+      uint8_t a=(x>=xstride)?row[x-xstride]:0;
+      uint8_t b=prv?prv[x]:0;
+      uint8_t c=(prv&&(x>=xstride))?prv[x-xstride]:0;
+      uint8_t pred=0;
+      switch (filter) {
+        case 1: pred=a; break;
+        case 2: pred=b; break;
+        case 3: pred=(a+b)>>1; break;
+        case 4: pred=png_test_paeth(a,b,c); break;
+      }
+      *fp=row[x]-pred;
+    }
+  }
+  uLongf zc=compressBound(filteredc);
+  uint8_t *z=malloc(zc);
+  if (!z||(compress(z,&zc,filtered,filteredc)!=Z_OK)) {
+    free(filtered);
+    if (z) free(z);
+    return -1;
+  }
+  free(filtered);
+  uint8_t ihdr[13]={w>>24,w>>16,w>>8,w,h>>24,h>>16,h>>8,h,depth,colortype,0,0,0};
+  int err=0;
+  if (sr_encode_raw(dst,"\x89PNG\r\n\x1a\n",8)<0) err=-1;
+  else if (png_test_chunk(dst,"IHDR",ihdr,13)<0) err=-1;
+  else if (png_test_chunk(dst,"IDAT",z,zc)<0) err=-1;
+  else if (png_test_chunk(dst,"IEND",0,0)<0) err=-1;
+  free(z);
+  return err;
+}
+
+/* Noise with some flat regions, so the predictors see both.
+ */
+
+static void png_test_fill(uint8_t *v,int c,uint32_t seed) {
+  int i=0; for (;i<c;i++) {
+    seed=seed*1103515245+12345;
+    if ((i>>5)&1) v[i]=v[i-1];
+    else v[i]=seed>>16;
+  }
+}
+
+EGG_ITEST(png_unfilter_all_filters) {
+  const struct { int depth,colortype,pixelsize; } formatv[]={
+    {8,0,8},   // xstride 1
+    {8,4,16},  // xstride 2
+    {8,2,24},  // xstride 3, SIMD
+    {8,6,32},  // xstride 4, SIMD
+    {1,0,1},   // sub-byte
+  };
+  int fi=0; for (;fi<sizeof(formatv)/sizeof(formatv[0]);fi++) {
+    int filter0=0; for (;filter0<5;filter0++) {
+      int w=37,h=13;
+      int stride=(w*formatv[fi].pixelsize+7)>>3;
+      uint8_t *raw=malloc(stride*h);
+      EGG_ASSERT(raw)
+      png_test_fill(raw,stride*h,fi*100+filter0);
+      struct sr_encoder png={0};
+      EGG_ASSERT_CALL(png_test_compose(&png,raw,w,h,formatv[fi].depth,formatv[fi].colortype,formatv[fi].pixelsize,filter0))
+      struct image *image=image_decode(png.v,png.c);
+      EGG_ASSERT(image,"pixelsize=%d filter0=%d",formatv[fi].pixelsize,filter0)
+      EGG_ASSERT_INTS(image->pixelsize,formatv[fi].pixelsize)
+      EGG_ASSERT_INTS(image->stride,stride)
+      EGG_ASSERT(!memcmp(image->v,raw,stride*h),"pixelsize=%d filter0=%d",formatv[fi].pixelsize,filter0)
+      image_del(image);
+      sr_encoder_cleanup(&png);
+      free(raw);
+    }
+  }
+  return 0;
+}
+
+EGG_ITEST(image_force_rgba_fast_paths) {
+  // 1-bit: 10 pixels, so both the whole-byte and leftover loops run.
+  struct image *image=image_new_alloc(1,10,1);
+  EGG_ASSERT(image)
+  ((uint8_t*)image->v)[0]=0xa5;
+  ((uint8_t*)image->v)[1]=0x80;
+  EGG_ASSERT_CALL(image_force_rgba(image))
+  const uint8_t *v=image->v;
+  const uint8_t expect1[]={1,0,1,0,0,1,0,1,1,0};
+  int i=0; for (;i<10;i++) EGG_ASSERT_INTS(v[i*4+1],expect1[i]?0xff:0x00,"i=%d",i)
+  image_del(image);
+
+  // 24-bit comes out opaque.
+  EGG_ASSERT(image=image_new_alloc(24,2,1))
+  memcpy(image->v,"\x11\x22\x33\x44\x55\x66",6);
+  EGG_ASSERT_CALL(image_force_rgba(image))
+  EGG_ASSERT(!memcmp(image->v,"\x11\x22\x33\xff\x44\x55\x66\xff",8))
+  image_del(image);
+
+  // 8-bit is alpha, black.
+  EGG_ASSERT(image=image_new_alloc(8,2,1))
+  memcpy(image->v,"\x80\xff",2);
+  EGG_ASSERT_CALL(image_force_rgba(image))
+  EGG_ASSERT(!memcmp(image->v,"\0\0\0\x80\0\0\0\xff",8))
+  image_del(image);
+  return 0;
+}
+
+/* Encode at each effort and thread count, and decode back.
+ * The image is large enough to split into several row groups.
+ * Output must not depend on thread count, or builds wouldn't be reproducible.
+ */
+
+EGG_ITEST(png_encode_effort_and_threads) {
+  const int pixelsizev[]={1,8,24,32};
+  const int effortv[]={IMAGE_EFFORT_FAST,IMAGE_EFFORT_DEFAULT,IMAGE_EFFORT_MAX};
+  int pi=0; for (;pi<sizeof(pixelsizev)/sizeof(int);pi++) {
+    int w=(pixelsizev[pi]==1)?4000:400,h=400;
+    struct image *image=image_new_alloc(pixelsizev[pi],w,h);
+    EGG_ASSERT(image)
+    png_test_fill(image->v,image->stride*image->h,pi);
+    int ei=0; for (;ei<3;ei++) {
+      struct sr_encoder single={0};
+      int threadc=1; for (;threadc<=4;threadc+=3) {
+        png_encode_configure(effortv[ei],threadc);
+        struct sr_encoder dst={0};
+        EGG_ASSERT_CALL(png_encode(&dst,image),"pixelsize=%d effort=%d threadc=%d",pixelsizev[pi],effortv[ei],threadc)
+        struct image *decoded=image_decode(dst.v,dst.c);
+        EGG_ASSERT(decoded,"pixelsize=%d effort=%d threadc=%d",pixelsizev[pi],effortv[ei],threadc)
+        EGG_ASSERT_INTS(decoded->pixelsize,pixelsizev[pi])
+        EGG_ASSERT_INTS(decoded->stride,image->stride)
+        EGG_ASSERT(!memcmp(decoded->v,image->v,image->stride*image->h),"pixelsize=%d effort=%d threadc=%d",pixelsizev[pi],effortv[ei],threadc)
+        image_del(decoded);
+        if (threadc==1) single=dst;
+        else {
+          EGG_ASSERT(
+            (dst.c==single.c)&&!memcmp(dst.v,single.v,dst.c),
+            "pixelsize=%d effort=%d: %d bytes single-threaded, %d with %d threads",pixelsizev[pi],effortv[ei],single.c,dst.c,threadc
+          )
+          sr_encoder_cleanup(&dst);
+        }
+      }
+      sr_encoder_cleanup(&single);
+    }
+    image_del(image);
+  }
+  png_encode_configure(IMAGE_EFFORT_DEFAULT,1);
+  return 0;
+}
+
+/* Decode every image in the demo, as the runtime would: image_decode then image_force_rgba.
+ */
+
+static double png_bench_now() {
+  struct timespec tv={0};
+  clock_gettime(CLOCK_MONOTONIC,&tv);
+  return (double)tv.tv_sec+(double)tv.tv_nsec/1000000000.0;
+}
+
+struct png_bench_file {
+  void *v;
+  int c;
+  char name[64];
+};
+
+static int png_bench_cb(const char *path,const char *base,char ftype,void *userdata) {
+  struct png_bench_file *filev=userdata;
+  int i=0; while (filev[i].v) i++;
+  if (i>=31) return 0;
+  int basec=0; while (base[basec]) basec++;
+  if ((basec<4)||memcmp(base+basec-4,".png",4)) return 0;
+  if ((filev[i].c=file_read(&filev[i].v,path))<0) return -1;
+  snprintf(filev[i].name,sizeof(filev[i].name),"%s",base);
+  return 0;
+}
+
+XXX_EGG_ITEST(png_decode_bench,bench) {
+  struct png_bench_file filev[32]={0};
+  EGG_ASSERT_CALL(dir_read("src/demo/data/image",png_bench_cb,filev))
+  EGG_ASSERT(filev[0].v,"No images found. Run from the repo root.")
+  const int repc=200;
+  double total=0.0;
+  int i=0; for (;filev[i].v;i++) {
+    double starttime=png_bench_now();
+    int rep=repc; while (rep-->0) {
+      struct image *image=image_decode(filev[i].v,filev[i].c);
+      EGG_ASSERT(image,"%s",filev[i].name)
+      EGG_ASSERT_CALL(image_force_rgba(image),"%s",filev[i].name)
+      image_del(image);
+    }
+    double elapsed=(png_bench_now()-starttime)/repc;
+    total+=elapsed;
+    fprintf(stderr,"%s: %-24s %8d b %9.03f ms\n",__func__,filev[i].name,filev[i].c,elapsed*1000.0);
+    free(filev[i].v);
+  }
+  fprintf(stderr,"%s: Total %.03f ms to decode all demo images once.\n",__func__,total*1000.0);
+  return 0;
+}
+
+/* Encode a large synthetic image at each effort, single-threaded and with 4 threads.
+ */
+
+XXX_EGG_ITEST(png_encode_bench,bench) {
+  struct image *image=image_new_alloc(32,1024,1024);
+  EGG_ASSERT(image)
+  png_test_fill(image->v,image->stride*image->h,1);
+  const int effortv[]={IMAGE_EFFORT_FAST,IMAGE_EFFORT_DEFAULT,IMAGE_EFFORT_MAX};
+  const char *namev[]={"fast","default","max"};
+  int ei=0; for (;ei<3;ei++) {
+    int threadc=1; for (;threadc<=4;threadc+=3) {
+      png_encode_configure(effortv[ei],threadc);
+      struct sr_encoder dst={0};
+      double starttime=png_bench_now();
+      EGG_ASSERT_CALL(png_encode(&dst,image))
+      double elapsed=png_bench_now()-starttime;
+      fprintf(stderr,"%s: %-7s threadc=%d %9d b %9.03f ms\n",__func__,namev[ei],threadc,dst.c,elapsed*1000.0);
+      sr_encoder_cleanup(&dst);
+    }
+  }
+  png_encode_configure(IMAGE_EFFORT_DEFAULT,1);
+  image_del(image);
+  return 0;
+}
@@ -0,0 +1,58 @@
+#include "test/egg_test.h"
+#include "opt/image/image.h"
+#include "opt/serial/serial.h"
+
+/* Fill an image with something that has both runs and noise, like real art does.
+ */
+
+static struct image *rawimg_test_image(int pixelsize,int w,int h) {
+  struct image *image=image_new_alloc(pixelsize,w,h);
+  if (!image) return 0;
+  uint8_t *v=image->v;
+  int len=image->stride*image->h,i=0;
+  uint32_t seed=12345;
+  for (;i<len;i++) {
+    if ((i/image->stride)&4) v[i]=0xa5;
+    else {
+      seed=seed*1103515245+12345;
+      v[i]=seed>>16;
+    }
+  }
+  return image;
+}
+
+EGG_ITEST(rawimg_round_trip) {
+  const int pixelsizev[]={1,8,32};
+  const int formatv[]={IMAGE_FORMAT_rawimg,IMAGE_FORMAT_lzimg};
+  int pi=0; for (;pi<3;pi++) {
+    int fi=0; for (;fi<2;fi++) {
+      struct image *image=rawimg_test_image(pixelsizev[pi],77,41);
+      EGG_ASSERT(image)
+      struct sr_encoder dst={0};
+      EGG_ASSERT_CALL(image_encode(&dst,image,formatv[fi]))
+      EGG_ASSERT_INTS(image_format_guess(dst.v,dst.c),formatv[fi])
+      struct image *decoded=image_decode(dst.v,dst.c);
+      EGG_ASSERT(decoded,"pixelsize=%d format=%s",pixelsizev[pi],image_format_repr(formatv[fi]))
+      EGG_ASSERT_INTS(decoded->w,77)
+      EGG_ASSERT_INTS(decoded->h,41)
+      EGG_ASSERT_INTS(decoded->pixelsize,pixelsizev[pi])
+      EGG_ASSERT_INTS(decoded->stride,image->stride)
+      EGG_ASSERT(!memcmp(decoded->v,image->v,image->stride*image->h),"pixelsize=%d format=%s",pixelsizev[pi],image_format_repr(formatv[fi]))
+
+      struct image weak={0};
+      if (formatv[fi]==IMAGE_FORMAT_rawimg) {
+        EGG_ASSERT_INTS(rawimg_decode_weak(&weak,dst.v,dst.c),image->stride*image->h)
+        EGG_ASSERT(!memcmp(weak.v,image->v,image->stride*image->h))
+      } else {
+        EGG_ASSERT_FAILURE(rawimg_decode_weak(&weak,dst.v,dst.c))
+        // Truncated LZ payload must fail cleanly.
+        EGG_ASSERT_NOT(image_decode(dst.v,dst.c-1))
+      }
+
+      image_del(decoded);
+      image_del(image);
+      sr_encoder_cleanup(&dst);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,156 @@
+#include "test/egg_test.h"
+#include "opt/render/render_internal.h"
+#include <time.h>
+
+/* Renderer benchmarks.
+ * Disabled by default; run with EGG_TEST_FILTER=bench.
+ * There's no GL context here. We replace the GL calls with counters and build the renderer's GL side right into this unit.
+ * The software side, render_soft.c, is built into test_render_soft.c, and links against this.
+ * So timing is CPU-side only, and the main thing to watch is the call counts.
+ */
+ 
+static struct render_bench_gl {
+  int callc;
+  int drawc;
+  GLuint nextid;
+} render_bench_gl={0};
+
+#define COUNT (render_bench_gl.callc++)
+#define glActiveTexture(...) COUNT
+#define glAttachShader(...) COUNT
+#define glBindAttribLocation(...) COUNT
+#define glBindBuffer(...) COUNT
+#define glBindFramebuffer(...) COUNT
+#define glBindTexture(...) COUNT
+#define glBlendFunc(...) COUNT
+#define glBufferData(...) COUNT
+#define glBufferSubData(...) COUNT
+#define glClear(...) COUNT
+#define glClearColor(...) COUNT
+#define glCompileShader(...) COUNT
+#define glCreateProgram() (COUNT,1)
+#define glCreateShader(...) (COUNT,1)
+#define glDeleteBuffers(...) COUNT
+#define glDeleteFramebuffers(...) COUNT
+#define glDeleteProgram(...) COUNT
+#define glDeleteShader(...) COUNT
+#define glDeleteTextures(...) COUNT
+#define glDisable(...) COUNT
+#define glDisableVertexAttribArray(...) COUNT
+#define glDrawArrays(...) (COUNT,render_bench_gl.drawc++)
+#define glEnable(...) COUNT
+#define glEnableVertexAttribArray(...) COUNT
+#define glFlush() COUNT
+#define glFramebufferTexture2D(...) COUNT
+#define glGenBuffers(c,v) (COUNT,*(v)=++(render_bench_gl.nextid))
+#define glGenFramebuffers(c,v) (COUNT,*(v)=++(render_bench_gl.nextid))
+#define glGenTextures(c,v) (COUNT,*(v)=++(render_bench_gl.nextid))
+#define glGetProgramInfoLog(...) COUNT
+#define glGetProgramiv(pid,k,v) (COUNT,*(v)=1)
+#define glGetShaderInfoLog(...) COUNT
+#define glGetShaderiv(sid,k,v) (COUNT,*(v)=1)
+#define glGetUniformLocation(...) (COUNT,0)
+#define glLinkProgram(...) COUNT
+#define glReadPixels(...) COUNT
+#define glShaderSource(...) COUNT
+#define glTexImage2D(...) COUNT
+#define glTexParameteri(...) COUNT
+#define glTexSubImage2D(...) COUNT
+#define glUniform1f(...) COUNT
+#define glUniform1i(...) COUNT
+#define glUniform2f(...) COUNT
+#define glUniform4f(...) COUNT
+#define glUseProgram(...) COUNT
+#define glVertexAttribPointer(...) COUNT
+#define glViewport(...) COUNT
+
+#include "opt/render/render_context.c"
+#include "opt/render/render_draw.c"
+
+static double render_bench_now() {
+  struct timespec tv={0};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID,&tv);
+  return (double)tv.tv_sec+(double)tv.tv_nsec/1000000000.0;
+}
+
+/* Run (framec) frames of (draw) against a fresh renderer with a 320x180 main and 64x64 source texture 2.
+ * Report GL calls and draws per frame.
+ */
+ 
+static int render_bench_run(const char *name,void (*draw)(struct render *render),int soft) {
+  struct render *render=soft?render_new_soft():render_new();
+  EGG_ASSERT(render)
+  EGG_ASSERT_CALL(render_texture_require(render,2))
+  EGG_ASSERT_CALL(render_texture_load(render,1,320,180,320*4,EGG_TEX_FMT_RGBA,0,0))
+  EGG_ASSERT_CALL(render_texture_load(render,2,64,64,64*4,EGG_TEX_FMT_RGBA,0,0))
+  
+  const int framec=10000;
+  render_bench_gl.callc=render_bench_gl.drawc=0;
+  double starttime=render_bench_now();
+  int i=framec; while (i-->0) {
+    draw(render);
+    render_draw_to_main(render,640,360,1);
+  }
+  double elapsed=render_bench_now()-starttime;
+  struct render_stats frame={0},total={0};
+  render_get_stats(&frame,&total,render);
+  fprintf(stderr,
+    "%s: %12s: %4d GL calls, %3d draws, %3d state changes per frame. %.03f us CPU per frame.\n",
+    __func__,name,render_bench_gl.callc/framec,render_bench_gl.drawc/framec,frame.statec,(elapsed*1000000.0)/framec
+  );
+  EGG_ASSERT_INTS(total.framec,framec)
+  EGG_ASSERT_INTS(total.drawc,render_bench_gl.drawc)
+  
+  render_del(render);
+  return 0;
+}
+
+/* A HUD's worth of rects, one egg_draw_rect call per frame.
+ */
+ 
+static void render_bench_draw_hud(struct render *render) {
+  struct egg_draw_rect rectv[300];
+  int i=0; for (;i<sizeof(rectv)/sizeof(rectv[0]);i++) {
+    rectv[i]=(struct egg_draw_rect){(i*7)%320,(i*13)%180,8,8,i,i*3,i*5,0xff};
+  }
+  render_draw_rect(render,1,rectv,sizeof(rectv)/sizeof(rectv[0]));
+}
+
+/* What a typical game does: Clear, tile a background, then sprites and flat shapes one at a time.
+ */
+ 
+static void render_bench_draw_mixed(struct render *render) {
+  struct egg_draw_rect bg={0,0,320,180,0x20,0x30,0x40,0xff};
+  render_draw_rect(render,1,&bg,1);
+  struct egg_draw_tile tilev[20*12];
+  int i=0; for (;i<sizeof(tilev)/sizeof(tilev[0]);i++) {
+    tilev[i]=(struct egg_draw_tile){(i%20)*16+8,(i/20)*16+8,i&0xff,0};
+  }
+  render_draw_tile(render,1,2,tilev,sizeof(tilev)/sizeof(tilev[0]));
+  for (i=0;i<50;i++) {
+    struct egg_draw_decal decal={i*6,i*3,(i&3)*16,0,16,16,0};
+    render_draw_decal(render,1,2,&decal,1);
+  }
+  for (i=0;i<50;i++) {
+    struct egg_draw_rect rect={i*6,100,4,4,0xff,0xff,0x00,0xff};
+    struct egg_draw_line line={i*6,110,i*6+4,114,0x00,0xff,0xff,0xff};
+    render_draw_rect(render,1,&rect,1);
+    render_draw_line(render,1,&line,1);
+  }
+}
+
+XXX_EGG_ITEST(render_bench_gl_calls,bench) {
+  if (render_bench_run("hud",render_bench_draw_hud,0)<0) return -1;
+  if (render_bench_run("mixed",render_bench_draw_mixed,0)<0) return -1;
+  return 0;
+}
+
+/* Same scenarios against the software renderer. GL counts should be zero.
+ */
+
+XXX_EGG_ITEST(render_bench_soft,bench) {
+  if (render_bench_run("soft hud",render_bench_draw_hud,1)<0) return -1;
+  if (render_bench_run("soft mixed",render_bench_draw_mixed,1)<0) return -1;
+  EGG_ASSERT_INTS(render_bench_gl.callc,0)
+  return 0;
+}
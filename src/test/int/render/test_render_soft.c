@@ -0,0 +1,112 @@
+#include "test/egg_test.h"
+#include "opt/render/render_internal.h"
+
+/* Software renderer.
+ * We build render_soft.c into this unit, for access to its private blender.
+ * The rest of the renderer comes from test_render_bench.c, built against stub GL, which the software path never calls.
+ */
+
+#include "opt/render/render_soft.c"
+
+/* Software renderer, a few known pixels.
+ */
+
+#define SOFT_PIXEL(x,y) ({ \
+  const uint8_t *_p=render->texturev[0].softv+(((y)*4+(x))<<2); \
+  (uint32_t)((_p[0]<<24)|(_p[1]<<16)|(_p[2]<<8)|_p[3]); \
+})
+
+EGG_ITEST(render_soft_pixels) {
+  struct render *render=render_new_soft();
+  EGG_ASSERT(render)
+  EGG_ASSERT_CALL(render_texture_require(render,2))
+  EGG_ASSERT_CALL(render_texture_load(render,1,4,4,16,EGG_TEX_FMT_RGBA,0,0))
+  const uint8_t srcpixels[]={
+    0xff,0x00,0x00,0xff, 0x00,0xff,0x00,0xff,
+    0x00,0x00,0xff,0xff, 0x00,0x00,0x00,0x00,
+  };
+  EGG_ASSERT_CALL(render_texture_load(render,2,2,2,8,EGG_TEX_FMT_RGBA,srcpixels,sizeof(srcpixels)))
+  
+  // Opaque rect, clipped.
+  struct egg_draw_rect rect={2,2,5,5,0x11,0x22,0x33,0xff};
+  render_draw_rect(render,1,&rect,1);
+  EGG_ASSERT_INTS(SOFT_PIXEL(1,1),0)
+  EGG_ASSERT_INTS(SOFT_PIXEL(2,2),0x112233ff)
+  EGG_ASSERT_INTS(SOFT_PIXEL(3,3),0x112233ff)
+  
+  // Half-alpha white over it: Blends all four channels, same as our GL setup.
+  render_alpha(render,0x80);
+  rect=(struct egg_draw_rect){3,3,1,1,0xff,0xff,0xff,0xff};
+  render_draw_rect(render,1,&rect,1);
+  render_alpha(render,0xff);
+  EGG_ASSERT_INTS(SOFT_PIXEL(3,3),0x889199bf)
+  
+  // Decal with XREV|SWAP. Transparent source pixels leave the output alone.
+  render_texture_clear(render,1);
+  struct egg_draw_decal decal={0,0,0,0,2,2,EGG_XFORM_XREV|EGG_XFORM_SWAP};
+  render_draw_decal(render,1,2,&decal,1);
+  EGG_ASSERT_INTS(SOFT_PIXEL(0,0),0x00ff00ff)
+  EGG_ASSERT_INTS(SOFT_PIXEL(1,0),0)
+  EGG_ASSERT_INTS(SOFT_PIXEL(0,1),0xff0000ff)
+  EGG_ASSERT_INTS(SOFT_PIXEL(1,1),0x0000ffff)
+  
+  // Tint replaces color in proportion to its alpha.
+  render_texture_clear(render,1);
+  render_tint(render,0xffffffff);
+  decal=(struct egg_draw_decal){1,1,0,0,1,1,0};
+  render_draw_decal(render,1,2,&decal,1);
+  render_tint(render,0);
+  EGG_ASSERT_INTS(SOFT_PIXEL(1,1),0xffffffff)
+  
+  // Output at 2x with no border. Row zero on top.
+  render_draw_to_main(render,8,8,1);
+  int mainw=0,mainh=0;
+  const uint8_t *mainv=render_get_main(&mainw,&mainh,render);
+  EGG_ASSERT(mainv)
+  EGG_ASSERT_INTS(mainw,8)
+  EGG_ASSERT_INTS(mainh,8)
+  EGG_ASSERT_INTS(mainv[(2*8+2)*4],0xff)
+  EGG_ASSERT_INTS(mainv[(3*8+3)*4+3],0xff)
+  EGG_ASSERT_INTS(mainv[(4*8+4)*4+3],0)
+  
+  // Sub-rect load overwrites without blending, and leaves its neighbors alone.
+  render_texture_clear(render,1);
+  rect=(struct egg_draw_rect){0,0,4,4,0x11,0x22,0x33,0xff};
+  render_draw_rect(render,1,&rect,1);
+  EGG_ASSERT_CALL(render_texture_load_sub(render,1,1,2,2,2,8,srcpixels,sizeof(srcpixels)))
+  EGG_ASSERT_INTS(SOFT_PIXEL(0,2),0x112233ff)
+  EGG_ASSERT_INTS(SOFT_PIXEL(1,2),0xff0000ff)
+  EGG_ASSERT_INTS(SOFT_PIXEL(2,2),0x00ff00ff)
+  EGG_ASSERT_INTS(SOFT_PIXEL(1,3),0x0000ffff)
+  EGG_ASSERT_INTS(SOFT_PIXEL(2,3),0)
+  EGG_ASSERT_INTS(SOFT_PIXEL(3,3),0x112233ff)
+  EGG_ASSERT_INTS(SOFT_PIXEL(1,1),0x112233ff)
+  EGG_ASSERT_FAILURE(render_texture_load_sub(render,1,3,3,2,2,8,srcpixels,sizeof(srcpixels)))
+  EGG_ASSERT_FAILURE(render_texture_load_sub(render,1,0,0,2,2,8,srcpixels,sizeof(srcpixels)-1))
+  
+  render_del(render);
+  return 0;
+}
+
+/* SIMD blend must match the scalar path exactly.
+ */
+
+EGG_ITEST(render_soft_blend_exact) {
+  uint8_t src[67*4],dst[67*4],expect[67*4];
+  uint32_t seed=12345;
+  int pass=0; for (;pass<200;pass++) {
+    int i=0; for (;i<sizeof(src);i++) {
+      seed=seed*1103515245+12345;
+      src[i]=seed>>16;
+      dst[i]=expect[i]=seed>>24;
+    }
+    if (pass&1) for (i=3;i<sizeof(src);i+=4) src[i]=(i&4)?0xff:0x00;
+    for (i=0;i<sizeof(src);i+=4) {
+      int a=src[i+3],k=0;
+      for (;k<4;k++) expect[i+k]=(expect[i+k]*(255-a)+src[i+k]*a+127)/255;
+    }
+    render_soft_blend(dst,src,67);
+    EGG_ASSERT_INTS(memcmp(dst,expect,sizeof(dst)),0,"pass %d",pass)
+  }
+  return 0;
+}
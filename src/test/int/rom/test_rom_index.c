@@ -0,0 +1,92 @@
+#include "test/egg_test.h"
+#include "opt/rom/rom.h"
+#include <stdint.h>
+#include <time.h>
+
+/* Plain binary search over (tid,rid), what rom_index replaces. Our reference.
+ */
+
+static int rom_index_test_bsearch(const struct rom_res *resv,int resc,int tid,int rid) {
+  int lo=0,hi=resc;
+  while (lo<hi) {
+    int ck=(lo+hi)>>1;
+    const struct rom_res *q=resv+ck;
+         if (tid<q->tid) hi=ck;
+    else if (tid>q->tid) lo=ck+1;
+    else if (rid<q->rid) hi=ck;
+    else if (rid>q->rid) lo=ck+1;
+    else return ck;
+  }
+  return -lo-1;
+}
+
+/* Dense types, sparse types, and gaps between types.
+ * Sparse when (tid%3==0), and tids jump by 2 so some are absent.
+ */
+
+static int rom_index_test_list(struct rom_res *resv,int resa,int pertype) {
+  int resc=0,tid=1;
+  for (;(tid<256)&&(resc<resa);tid+=2) {
+    int i=0; for (;(i<pertype)&&(resc<resa);i++) {
+      struct rom_res *res=resv+resc++;
+      res->tid=tid;
+      res->rid=(tid%3)?(i+1):(i*7+3);
+      res->v=res;
+      res->c=1;
+    }
+  }
+  return resc;
+}
+
+EGG_ITEST(rom_index_matches_bsearch) {
+  struct rom_res resv[600];
+  int resc=rom_index_test_list(resv,600,20);
+  struct rom_index index;
+  EGG_ASSERT_CALL(rom_index_init(&index,resv,resc,sizeof(struct rom_res)))
+  EGG_ASSERT(index.typev[1].dense)
+  EGG_ASSERT_NOT(index.typev[3].dense)
+  EGG_ASSERT_NOT(index.typev[2].c)
+  int tid=0; for (;tid<=0x3f;tid++) {
+    int rid=0; for (;rid<=160;rid++) {
+      EGG_ASSERT_INTS(rom_index_search(&index,tid,rid),rom_index_test_bsearch(resv,resc,tid,rid),"%d:%d",tid,rid)
+    }
+  }
+  // Empty list is legal, and unsorted is not.
+  EGG_ASSERT_CALL(rom_index_init(&index,0,0,sizeof(struct rom_res)))
+  EGG_ASSERT_INTS(rom_index_search(&index,1,1),-1)
+  resv[1].rid=resv[0].rid;
+  EGG_ASSERT_FAILURE(rom_index_init(&index,resv,resc,sizeof(struct rom_res)))
+  return 0;
+}
+
+/* Lookups per second with plain binary search and with rom_index.
+ */
+
+static double rom_index_bench_now() {
+  struct timespec tv={0};
+  clock_gettime(CLOCK_MONOTONIC,&tv);
+  return (double)tv.tv_sec+(double)tv.tv_nsec/1000000000.0;
+}
+
+XXX_EGG_ITEST(rom_index_bench,bench) {
+  static struct rom_res resv[4000];
+  int resc=rom_index_test_list(resv,4000,100);
+  struct rom_index index;
+  EGG_ASSERT_CALL(rom_index_init(&index,resv,resc,sizeof(struct rom_res)))
+  const int repc=10000000;
+  int pass=0; for (;pass<2;pass++) {
+    uint32_t seed=1;
+    int hitc=0,i=repc;
+    double starttime=rom_index_bench_now();
+    while (i-->0) {
+      seed=seed*1103515245+12345;
+      const struct rom_res *q=resv+(seed>>8)%resc;
+      int p=pass?rom_index_search(&index,q->tid,q->rid):rom_index_test_bsearch(resv,resc,q->tid,q->rid);
+      if (p>=0) hitc++;
+    }
+    double elapsed=rom_index_bench_now()-starttime;
+    EGG_ASSERT_INTS(hitc,repc)
+    fprintf(stderr,"%s: %-9s %d resources, %.01f M lookups/s\n",__func__,pass?"rom_index":"bsearch",resc,repc/elapsed/1000000.0);
+  }
+  return 0;
+}
@@ -0,0 +1,69 @@
+#include "test/egg_test.h"
+#include "eggdev/eggdev_internal.h"
+
+/* Build a ROM with a few types, including gaps in rid and one long resource.
+ */
+
+static int rom_toc_test_add(struct eggdev_rom *rom,int tid,int rid,int c) {
+  int p=eggdev_rom_search(rom,tid,rid);
+  if (p>=0) return -1;
+  struct eggdev_res *res=eggdev_rom_insert(rom,-p-1,tid,rid);
+  if (!res) return -1;
+  uint8_t *v=malloc(c);
+  if (!v) return -1;
+  int i=0; for (;i<c;i++) v[i]=tid+rid+i;
+  eggdev_res_handoff_serial(res,v,c);
+  return 0;
+}
+
+EGG_ITEST(rom_toc_matches_reader) {
+  struct eggdev_rom rom={0};
+  EGG_ASSERT_CALL(rom_toc_test_add(&rom,EGG_TID_metadata,1,10))
+  EGG_ASSERT_CALL(rom_toc_test_add(&rom,EGG_TID_image,1,20000))
+  EGG_ASSERT_CALL(rom_toc_test_add(&rom,EGG_TID_image,7,3))
+  EGG_ASSERT_CALL(rom_toc_test_add(&rom,EGG_TID_image,40000,1))
+  EGG_ASSERT_CALL(rom_toc_test_add(&rom,EGG_TID_sound,2,5))
+  EGG_ASSERT_CALL(rom_toc_test_add(&rom,200,1,5))
+  struct sr_encoder dst={0};
+  EGG_ASSERT_CALL(sr_encode_raw(&dst,"junk",4)) // TOC offsets are relative to the ROM, not the buffer.
+  EGG_ASSERT_CALL(eggdev_rom_encode(&dst,&rom))
+  EGG_ASSERT_CALL(eggdev_rom_append_toc(&dst,4))
+  const uint8_t *src=(uint8_t*)dst.v+4;
+  int srcc=dst.c-4;
+
+  struct rom_toc toc={0};
+  EGG_ASSERT_CALL(rom_toc_init(&toc,src,srcc))
+  EGG_ASSERT_INTS(toc.typec,4)
+  EGG_ASSERT_INTS(toc.recordc,6)
+  struct rom_reader reader;
+  EGG_ASSERT_CALL(rom_reader_init(&reader,src,srcc))
+  struct rom_res *expect;
+  int tid=0,p=0;
+  while (expect=rom_reader_next(&reader)) {
+    if (expect->tid!=tid) { tid=expect->tid; p=0; }
+    struct rom_res actual={0};
+    EGG_ASSERT_INTS(rom_toc_get(&actual,&toc,expect->tid,expect->rid),1,"%d:%d",expect->tid,expect->rid)
+    EGG_ASSERT(actual.v==expect->v,"%d:%d",expect->tid,expect->rid)
+    EGG_ASSERT_INTS(actual.c,expect->c,"%d:%d",expect->tid,expect->rid)
+    EGG_ASSERT_INTS(rom_toc_get_by_index(&actual,&toc,expect->tid,p),1,"%d:%d",expect->tid,expect->rid)
+    EGG_ASSERT_INTS(actual.rid,expect->rid)
+    p++;
+  }
+  EGG_ASSERT_INTS(reader.status,1)
+  struct rom_res res;
+  EGG_ASSERT_NOT(rom_toc_get(&res,&toc,EGG_TID_image,2))
+  EGG_ASSERT_NOT(rom_toc_get(&res,&toc,EGG_TID_song,1))
+  EGG_ASSERT_NOT(rom_toc_get_by_index(&res,&toc,EGG_TID_image,3))
+
+  // Any damage to the footer, or a ROM without one, and there's no TOC.
+  EGG_ASSERT_FAILURE(rom_toc_init(&toc,src,srcc-1))
+  ((uint8_t*)dst.v)[dst.c-5]++;
+  EGG_ASSERT_FAILURE(rom_toc_init(&toc,src,srcc))
+  dst.c=0;
+  EGG_ASSERT_CALL(eggdev_rom_encode(&dst,&rom))
+  EGG_ASSERT_FAILURE(rom_toc_init(&toc,dst.v,dst.c))
+
+  sr_encoder_cleanup(&dst);
+  eggdev_rom_cleanup(&rom);
+  return 0;
+}
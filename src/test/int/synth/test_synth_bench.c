@@ -0,0 +1,100 @@
+#include "test/egg_test.h"
+#include "opt/synth/synth.h"
+#include "opt/synth/synth_internal.h"
+#include <time.h>
+
+/* Synthesizer benchmarks.
+ * Disabled by default; run with EGG_TEST_FILTER=bench.
+ */
+
+static double synth_bench_now() {
+  struct timespec tv={0};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID,&tv);
+  return (double)tv.tv_sec+(double)tv.tv_nsec/1000000000.0;
+}
+
+/* Level env with a sustain, and a pitch env that wobbles a little.
+ */
+#define LEVELENV 0x04,0x01,0x03, 0x0a,0xff,0xff, 0x14,0x80,0x00, 0x81,0x48,0x00,0x00
+#define PITCHENV 0x01,0x80,0x00,0x02, 0x64,0x90,0x00, 0x81,0x00,0x80,0x00
+#define LEVELENV_LEN 13
+#define PITCHENV_LEN 11
+
+static const uint8_t synth_bench_song[]={
+  0x00,'E','G','S',
+  0x00,0xff,2,0,0,LEVELENV_LEN+1,LEVELENV,3,
+  0x01,0xff,2,0,0,LEVELENV_LEN+1+PITCHENV_LEN,LEVELENV,3,PITCHENV,
+  0x02,0xff,3,0,0,LEVELENV_LEN+4,LEVELENV,0x02,0x00,0x01,0x00,
+  0x03,0xff,3,0,0,LEVELENV_LEN+4+PITCHENV_LEN,LEVELENV,0x02,0x00,0x01,0x00,PITCHENV,
+  0x04,0xff,4,0,0,LEVELENV_LEN+2,LEVELENV,0x00,0xc8,
+  0xff,
+  0x7f,0x7f,0x7f,0x7f,
+};
+
+/* Make a WAV file of noise, 44 kHz, a little over 2 seconds.
+ */
+ 
+static void *synth_bench_wav(int *dstc) {
+  int samplec=100000;
+  int len=44+samplec*2;
+  uint8_t *dst=calloc(1,len);
+  if (!dst) return 0;
+  memcpy(dst,"RIFF",4);
+  dst[24]=44100&0xff; dst[25]=44100>>8;
+  dst[40]=(samplec*2); dst[41]=(samplec*2)>>8; dst[42]=(samplec*2)>>16;
+  uint8_t *p=dst+44;
+  int i=samplec;
+  for (;i-->0;p+=2) { int16_t s=(rand()&0x3fff)-0x2000; p[0]=s; p[1]=s>>8; }
+  *dstc=len;
+  return dst;
+}
+
+/* Run one synth for one second with (voicec) voices on (chid), or sounds if (chid<0).
+ * Returns voice-milliseconds of output per millisecond of CPU time.
+ */
+ 
+static double synth_bench_run(int chid,int voicec,const void *wav,int wavc) {
+  int rate=44100;
+  struct synth *synth=synth_new(rate,1);
+  if (!synth) return -1.0;
+  synth_play_song_borrow(synth,synth_bench_song,sizeof(synth_bench_song),1);
+  if (synth_install_sound(synth,1,wav,wavc)<0) { synth_del(synth); return -1.0; }
+  int i=0; for (;i<voicec;i++) {
+    if (chid<0) synth_play_sound(synth,1);
+    else synth_event(synth,chid,0x98,0x30+(i%48),0x40+(i%64),5000);
+  }
+  float buf[512];
+  int framec=rate,audioms=1000;
+  double starttime=synth_bench_now();
+  while (framec>0) {
+    int c=sizeof(buf)/sizeof(buf[0]);
+    if (c>framec) c=framec;
+    synth_updatef(buf,c,synth);
+    framec-=c;
+  }
+  double elapsed=synth_bench_now()-starttime;
+  synth_del(synth);
+  if (elapsed<=0.0) return 0.0;
+  return ((double)voicec*audioms)/(elapsed*1000.0);
+}
+
+XXX_EGG_ITEST(synth_bench_voice_throughput,bench) {
+  int wavc=0;
+  void *wav=synth_bench_wav(&wavc);
+  EGG_ASSERT(wav)
+  const struct { int chid; const char *name; } typev[]={
+    {0,"wave"},
+    {1,"wave+pitch"},
+    {2,"fm"},
+    {3,"fm+pitch"},
+    {4,"sub"},
+    {-1,"pcm"},
+  };
+  int i=0; for (;i<sizeof(typev)/sizeof(typev[0]);i++) {
+    double score=synth_bench_run(typev[i].chid,SYNTH_VOICE_LIMIT,wav,wavc);
+    EGG_ASSERT(score>0.0)
+    fprintf(stderr,"%s: %12s: %10.1f voices/ms (%s)\n",__func__,typev[i].name,score,synth_mix_impl);
+  }
+  free(wav);
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include "test/egg_test.h"
+#include "opt/synth/synth.h"
+#include "opt/synth/synth_internal.h"
+
+/* Per-channel pan, rendered as interleaved stereo.
+ * One long SUB note on channel zero, same as test_synth_steal.
+ */
+
+static const uint8_t synth_pan_song[]={
+  0x00,'E','G','S',
+  0x00,0xff,4,0,0,15, 0x04,0x01,0x03, 0x0a,0xff,0xff, 0x14,0x80,0x00, 0x81,0x48,0x00,0x00, 0x00,0xc8,
+  0xff,
+  0x7f,
+};
+
+#define SYNTH_PAN_FRAMEC 4096
+
+/* Render one note at (pan) into (v), (chanc) interleaved channels.
+ * Pan is the raw MIDI value, or <0 to not send Control Change at all.
+ */
+static int synth_pan_render(float *v,int chanc,int pan) {
+  struct synth *synth=synth_new(44100,chanc);
+  if (!synth) return -1;
+  synth_play_song_borrow(synth,synth_pan_song,sizeof(synth_pan_song),0);
+  if (pan>=0) synth_event(synth,0,0xb0,0x0a,pan,0);
+  synth_event(synth,0,0x98,0x40,0x40,10000);
+  if (synth->voicec!=1) {
+    synth_del(synth);
+    return -1;
+  }
+  synth_updatef(v,SYNTH_PAN_FRAMEC*chanc,synth);
+  synth_del(synth);
+  return 0;
+}
+
+/* Sum of squares of one channel of stereo (v).
+ */
+static double synth_pan_energy(const float *v,int chp) {
+  double sum=0.0;
+  int i=SYNTH_PAN_FRAMEC;
+  for (v+=chp;i-->0;v+=2) sum+=(*v)*(*v);
+  return sum;
+}
+
+EGG_ITEST(synth_pan_stereo) {
+  float mono[SYNTH_PAN_FRAMEC];
+  float stereo[SYNTH_PAN_FRAMEC*2];
+  EGG_ASSERT_CALL(synth_pan_render(mono,1,-1))
+  double monoe=0.0;
+  int i=SYNTH_PAN_FRAMEC; while (i-->0) monoe+=mono[i]*mono[i];
+  EGG_ASSERT(monoe>0.0,"Mono reference is silent.")
+
+  // Hard left: Right is exactly silent, and left gets the full signal.
+  EGG_ASSERT_CALL(synth_pan_render(stereo,2,0x00))
+  EGG_ASSERT(synth_pan_energy(stereo,1)==0.0,"right=%f",synth_pan_energy(stereo,1))
+  EGG_ASSERT(synth_pan_energy(stereo,0)>=monoe*0.999,"left=%f mono=%f",synth_pan_energy(stereo,0),monoe)
+
+  // Hard right: The mirror image.
+  EGG_ASSERT_CALL(synth_pan_render(stereo,2,0x7f))
+  EGG_ASSERT(synth_pan_energy(stereo,0)==0.0,"left=%f",synth_pan_energy(stereo,0))
+  EGG_ASSERT(synth_pan_energy(stereo,1)>=monoe*0.999,"right=%f mono=%f",synth_pan_energy(stereo,1),monoe)
+
+  // Center: Both sides carry the mono signal exactly.
+  EGG_ASSERT_CALL(synth_pan_render(stereo,2,0x40))
+  for (i=0;i<SYNTH_PAN_FRAMEC;i++) {
+    if ((stereo[i*2]!=mono[i])||(stereo[i*2+1]!=mono[i])) {
+      EGG_FAIL_MORE("frame","%d",i)
+      EGG_FAIL_MORE("mono","%f",mono[i])
+      EGG_FAIL_MORE("left","%f",stereo[i*2])
+      EGG_FAIL_MORE("right","%f",stereo[i*2+1])
+      EGG_FAIL("Centered stereo must match mono.")
+    }
+  }
+
+  // Partly left: Left full, right attenuated linearly.
+  EGG_ASSERT_CALL(synth_pan_render(stereo,2,0x20))
+  double gain=1.0-(0x40-0x20)/63.0;
+  double le=synth_pan_energy(stereo,0),re=synth_pan_energy(stereo,1);
+  EGG_ASSERT(le>=monoe*0.999,"left=%f mono=%f",le,monoe)
+  EGG_ASSERT((re>=monoe*gain*gain*0.99)&&(re<=monoe*gain*gain*1.01),"right=%f expected=%f",re,monoe*gain*gain)
+
+  return 0;
+}
+
+/* Pan is captured at Note On, and a new song resets it to center.
+ */
+
+EGG_ITEST(synth_pan_lifecycle) {
+  struct synth *synth=synth_new(44100,2);
+  EGG_ASSERT(synth)
+  synth_play_song_borrow(synth,synth_pan_song,sizeof(synth_pan_song),0);
+  synth_event(synth,0,0xb0,0x0a,0x00,0);
+  synth_event(synth,0,0x98,0x40,0x40,10000);
+  EGG_ASSERT_INTS(synth->voicec,1)
+  synth_event(synth,0,0xb0,0x0a,0x7f,0);
+  EGG_ASSERT(synth->voicev[0]->pan==-1.0f,"Changing pan must not move a playing voice.")
+  EGG_ASSERT(synth->channelv[0].pan==1.0f)
+  synth_play_song_borrow(synth,synth_pan_song,sizeof(synth_pan_song),0);
+  EGG_ASSERT(synth->channelv[0].pan==0.0f,"New song must reset pan.")
+  synth_del(synth);
+  return 0;
+}
@@ -0,0 +1,202 @@
+#include "test/egg_test.h"
+#include "opt/synth/synth.h"
+#include "opt/synth/synth_internal.h"
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Stress test for the synth's command queue.
+ * An audio thread renders under a mutex, standing in for the hostio lock.
+ * Its voices are all 'sub', our most expensive, so each render holds the lock a while.
+ * The game thread fires thousands of events per frame, either through the lock or through the queue,
+ * and we measure how long each frame's worth of calls blocked it.
+ * Disabled by default; run with EGG_TEST_FILTER=bench.
+ */
+ 
+#define RATE 44100
+#define CHANC 2
+#define BUFFER_FRAMES 1024
+#define GAME_FRAMES 180
+#define EVENTS_PER_FRAME 2000
+
+static const uint8_t synth_queue_test_song[]={
+  0x00,'E','G','S',
+  0x00,0xff,4,0,0,15, 0x04,0x01,0x03, 0x0a,0xff,0xff, 0x14,0x80,0x00, 0x81,0x48,0x00,0x00, 0x00,0xc8,
+  0xff,
+  0x7f,
+};
+
+static struct synth *synth=0;
+static pthread_mutex_t synth_queue_mutex=PTHREAD_MUTEX_INITIALIZER;
+static volatile int synth_queue_stop=0;
+
+static double synth_queue_now() {
+  struct timespec tv={0};
+  clock_gettime(CLOCK_MONOTONIC,&tv);
+  return (double)tv.tv_sec+(double)tv.tv_nsec/1000000000.0;
+}
+
+static void *synth_queue_audio_thread(void *dummy) {
+  int16_t buf[BUFFER_FRAMES*CHANC];
+  while (!synth_queue_stop) {
+    pthread_mutex_lock(&synth_queue_mutex);
+    synth_updatei(buf,BUFFER_FRAMES*CHANC,synth);
+    pthread_mutex_unlock(&synth_queue_mutex);
+    usleep((BUFFER_FRAMES*1000000)/RATE);
+  }
+  return 0;
+}
+
+/* Run the game side for GAME_FRAMES frames, and report the worst and average stall in seconds.
+ */
+ 
+static int synth_queue_run_game(double *worst,double *avg,int use_queue) {
+  *worst=*avg=0.0;
+  int frame=0; for (;frame<GAME_FRAMES;frame++) {
+    double starttime=synth_queue_now();
+    int i=0; for (;i<EVENTS_PER_FRAME;i++) {
+      // Mostly no-op channel, which is cheap to apply. Plus one real note per frame.
+      uint8_t chid=i?15:0;
+      if (use_queue) {
+        if (synth_queue_event(synth,chid,0x98,0x40,0x40,100)>=0) continue;
+        pthread_mutex_lock(&synth_queue_mutex);
+        synth_flush_commands(synth);
+        synth_event(synth,chid,0x98,0x40,0x40,100);
+        pthread_mutex_unlock(&synth_queue_mutex);
+      } else {
+        pthread_mutex_lock(&synth_queue_mutex);
+        synth_event(synth,chid,0x98,0x40,0x40,100);
+        pthread_mutex_unlock(&synth_queue_mutex);
+      }
+    }
+    double stall=synth_queue_now()-starttime;
+    if (stall>*worst) *worst=stall;
+    (*avg)+=stall;
+    usleep(16666);
+  }
+  (*avg)/=GAME_FRAMES;
+  return 0;
+}
+
+XXX_EGG_ITEST(synth_queue_stress,bench) {
+  EGG_ASSERT(synth=synth_new(RATE,CHANC))
+  synth_play_song_borrow(synth,synth_queue_test_song,sizeof(synth_queue_test_song),1);
+  int i=0; for (;i<40;i++) synth_event(synth,0,0x98,0x30+i,0x40,60000);
+  
+  pthread_t thread;
+  EGG_ASSERT_INTS(pthread_create(&thread,0,synth_queue_audio_thread,0),0)
+  double lock_worst,lock_avg,queue_worst,queue_avg;
+  synth_queue_run_game(&lock_worst,&lock_avg,0);
+  synth_queue_run_game(&queue_worst,&queue_avg,1);
+  synth_queue_stop=1;
+  pthread_join(thread,0);
+  
+  fprintf(stderr,
+    "%s: %d events/frame. Locked: worst %.3f ms, avg %.3f ms. Queued: worst %.3f ms, avg %.3f ms.\n",
+    __func__,EVENTS_PER_FRAME,lock_worst*1000.0,lock_avg*1000.0,queue_worst*1000.0,queue_avg*1000.0
+  );
+  
+  // Final update must drain everything.
+  int16_t buf[CHANC];
+  synth_updatei(buf,CHANC,synth);
+  EGG_ASSERT_INTS(synth->queue_head,synth->queue_tail)
+  synth_del(synth);
+  synth=0;
+  return 0;
+}
+
+/* Submit more print jobs at once than the worker ring holds.
+ * The overflow must print during update instead, never fall back to silence.
+ */
+
+static const uint8_t synth_queue_test_sound[]={
+  0x00,'E','G','S',
+  0x00,0xff,4,0,0,15, 0x04,0x01,0x03, 0x0a,0xff,0xff, 0x14,0x80,0x00, 0x81,0x48,0x00,0x00, 0x00,0xc8,
+  0xff,
+  0x90,0x91,0xe0, // Note 0x48, 64 ms.
+  0x3f,
+};
+
+EGG_ITEST(synth_workers_overflow) {
+  const int soundc=SYNTH_WORKER_QUEUE_SIZE+64;
+  EGG_ASSERT(synth=synth_new(RATE,CHANC))
+  int rid=1; for (;rid<=soundc;rid++) {
+    EGG_ASSERT_CALL(synth_install_sound(synth,rid,synth_queue_test_sound,sizeof(synth_queue_test_sound)))
+  }
+  EGG_ASSERT_CALL(synth_start_printers(synth,1))
+  synth_preprint_sounds(synth);
+  double deadline=synth_queue_now()+10.0;
+  int16_t buf[BUFFER_FRAMES*CHANC];
+  int pendingc=soundc;
+  while (pendingc) {
+    EGG_ASSERT(synth_queue_now()<deadline,"%d of %d sounds still printing",pendingc,soundc)
+    synth_updatei(buf,BUFFER_FRAMES*CHANC,synth);
+    pendingc=0;
+    struct synth_res *res=synth->resv;
+    int i=synth->resc; for (;i-->0;res++) {
+      if (synth_resolve_pcm(&res->pcm,&res->job)<=0) pendingc++;
+    }
+  }
+  struct synth_res *res=synth->resv;
+  int i=synth->resc; for (;i-->0;res++) {
+    EGG_ASSERT(res->pcm->c>1,"rid %d printed only %d samples",res->rid,res->pcm->c)
+  }
+  synth_del(synth);
+  synth=0;
+  return 0;
+}
+
+/* Drums in installed songs print once, from synth_preprint_sounds.
+ * Starting the song, on the audio thread, only adds references to that job.
+ */
+
+EGG_ITEST(synth_preprint_song_drums) {
+  const int drumlen=sizeof(synth_queue_test_sound);
+  uint8_t song[64];
+  int songc=0;
+  memcpy(song,"\0EGS",4); songc=4;
+  song[songc++]=0x00; // chid
+  song[songc++]=0xff; // trim
+  song[songc++]=0x01; // DRUM
+  song[songc++]=0;
+  song[songc++]=0;
+  song[songc++]=5+drumlen;
+  song[songc++]=0x23; // noteid
+  song[songc++]=0x80;
+  song[songc++]=0xff;
+  song[songc++]=drumlen>>8;
+  song[songc++]=drumlen;
+  memcpy(song+songc,synth_queue_test_sound,drumlen); songc+=drumlen;
+  song[songc++]=0xff;
+  song[songc++]=0x7f;
+  
+  EGG_ASSERT(synth=synth_new(RATE,CHANC))
+  EGG_ASSERT_CALL(synth_install_song(synth,1,song,songc))
+  EGG_ASSERT_CALL(synth_start_printers(synth,1))
+  synth_preprint_sounds(synth);
+  EGG_ASSERT_INTS(synth->drumprintc,1)
+  struct synth_drumprint *drumprint=synth->drumprintv;
+  EGG_ASSERT(drumprint->pcm||drumprint->job)
+  
+  int pass=0; for (;pass<2;pass++) {
+    synth_play_song(synth,1,1,1);
+    EGG_ASSERT_INTS(synth_get_song(synth),1)
+    struct synth_channel *channel=synth->channelv;
+    EGG_ASSERT_INTS(channel->mode,SYNTH_CHANNEL_MODE_DRUM)
+    struct synth_drum *drum=channel->drumv+0x23;
+    if (drum->job) EGG_ASSERT(drum->job==drumprint->job,"Song start must share the preprinted job, not make a new one.")
+    else EGG_ASSERT(drum->pcm&&(drum->pcm==drumprint->pcm))
+    EGG_ASSERT_INTS(synth->drumprintc,1)
+  }
+  
+  double deadline=synth_queue_now()+10.0;
+  int16_t buf[BUFFER_FRAMES*CHANC];
+  while (synth_resolve_pcm(&drumprint->pcm,&drumprint->job)<=0) {
+    EGG_ASSERT(synth_queue_now()<deadline,"Drum never printed.")
+    synth_updatei(buf,BUFFER_FRAMES*CHANC,synth);
+  }
+  EGG_ASSERT(drumprint->pcm->c>1)
+  synth_del(synth);
+  synth=0;
+  return 0;
+}
@@ -0,0 +1,143 @@
+#include "test/egg_test.h"
+#include "opt/synth/synth.h"
+#include "opt/synth/synth_internal.h"
+
+/* Voice stealing policies.
+ * We fill the synth with long SUB notes from outside any update, so they all belong to "sound effects",
+ * then flag some of them as song voices by hand.
+ */
+
+static const uint8_t synth_steal_song[]={
+  0x00,'E','G','S',
+  0x00,0xff,4,0,0,15, 0x04,0x01,0x03, 0x0a,0xff,0xff, 0x14,0x80,0x00, 0x81,0x48,0x00,0x00, 0x00,0xc8,
+  0xff,
+  0x7f,
+};
+
+static struct synth *synth_steal_setup(int policy) {
+  struct synth *synth=synth_new(44100,1);
+  if (!synth) return 0;
+  synth_set_steal_policy(synth,policy);
+  synth_play_song_borrow(synth,synth_steal_song,sizeof(synth_steal_song),0);
+  int i=0; for (;i<SYNTH_VOICE_LIMIT;i++) {
+    synth_event(synth,0,0x98,0x40,0x40,10000);
+  }
+  if (synth->voicec!=SYNTH_VOICE_LIMIT) {
+    synth_del(synth);
+    return 0;
+  }
+  return synth;
+}
+
+static int synth_steal_has_serial(const struct synth *synth,unsigned int serial) {
+  int i=synth->voicec;
+  while (i-->0) if (synth->voicev[i]->serial==serial) return 1;
+  return 0;
+}
+
+EGG_ITEST(synth_steal_policies) {
+  int stolen,rejected;
+  struct synth *synth;
+
+  // REJECT: The old behavior. New voice is dropped and everything else keeps running.
+  EGG_ASSERT(synth=synth_steal_setup(SYNTH_STEAL_REJECT))
+  synth_event(synth,0,0x98,0x40,0x40,10000);
+  synth_get_voice_stats(synth,&stolen,&rejected);
+  EGG_ASSERT_INTS(stolen,0)
+  EGG_ASSERT_INTS(rejected,1)
+  EGG_ASSERT_INTS(synth->voicec,SYNTH_VOICE_LIMIT)
+  synth_del(synth);
+
+  // OLDEST|SONG_FIRST: A sound effect takes the oldest song voice, even though sound effects are older.
+  EGG_ASSERT(synth=synth_steal_setup(SYNTH_STEAL_OLDEST|SYNTH_STEAL_SONG_FIRST))
+  struct synth_voice *oldest=0,*oldestsong=0;
+  int i=synth->voicec;
+  while (i-->0) {
+    struct synth_voice *voice=synth->voicev[i];
+    if (voice->serial>=SYNTH_VOICE_LIMIT/2) voice->song=1;
+    if (!oldest||(voice->serial<oldest->serial)) oldest=voice;
+    if (voice->song&&(!oldestsong||(voice->serial<oldestsong->serial))) oldestsong=voice;
+  }
+  unsigned int oldestserial=oldest->serial,oldestsongserial=oldestsong->serial;
+  synth_event(synth,0,0x98,0x40,0x40,10000);
+  synth_get_voice_stats(synth,&stolen,&rejected);
+  EGG_ASSERT_INTS(stolen,1)
+  EGG_ASSERT_INTS(rejected,0)
+  EGG_ASSERT_INTS(synth->voicec,SYNTH_VOICE_LIMIT)
+  EGG_ASSERT(synth_steal_has_serial(synth,oldestserial))
+  EGG_ASSERT_NOT(synth_steal_has_serial(synth,oldestsongserial))
+  synth_del(synth);
+
+  // QUIETEST: Released voices go before held ones, regardless of level or age.
+  EGG_ASSERT(synth=synth_steal_setup(SYNTH_STEAL_QUIETEST))
+  struct synth_voice *victim=synth->voicev[SYNTH_VOICE_LIMIT/2];
+  unsigned int victimserial=victim->serial;
+  victim->release(victim);
+  synth_event(synth,0,0x98,0x40,0x40,10000);
+  synth_get_voice_stats(synth,&stolen,&rejected);
+  EGG_ASSERT_INTS(stolen,1)
+  EGG_ASSERT_NOT(synth_steal_has_serial(synth,victimserial))
+  synth_del(synth);
+
+  return 0;
+}
+
+/* At the limit, a note that wouldn't have produced a voice anyway must not steal one.
+ * Channel 0 is the only one the song defines, so channel 1 is NOOP.
+ */
+
+EGG_ITEST(synth_steal_only_when_needed) {
+  int stolen,rejected;
+  struct synth *synth;
+  EGG_ASSERT(synth=synth_steal_setup(SYNTH_STEAL_OLDEST))
+  unsigned int serialv[SYNTH_VOICE_LIMIT];
+  int i=0; for (;i<SYNTH_VOICE_LIMIT;i++) serialv[i]=synth->voicev[i]->serial;
+  synth_event(synth,1,0x98,0x40,0x40,10000); // NOOP channel.
+  synth_event(synth,0,0x98,0x80,0x40,10000); // Invalid noteid.
+  synth_play_sound(synth,123); // No such sound.
+  synth_get_voice_stats(synth,&stolen,&rejected);
+  EGG_ASSERT_INTS(stolen,0)
+  EGG_ASSERT_INTS(rejected,0)
+  EGG_ASSERT_INTS(synth->voicec,SYNTH_VOICE_LIMIT)
+  for (i=0;i<SYNTH_VOICE_LIMIT;i++) EGG_ASSERT(synth_steal_has_serial(synth,serialv[i]),"i=%d",i)
+  
+  // And a real note still steals.
+  synth_event(synth,0,0x98,0x40,0x40,10000);
+  synth_get_voice_stats(synth,&stolen,&rejected);
+  EGG_ASSERT_INTS(stolen,1)
+  EGG_ASSERT_INTS(synth->voicec,SYNTH_VOICE_LIMIT)
+  synth_del(synth);
+  return 0;
+}
+
+/* A stolen voice leaves a short tail that ramps to silence, and it plays out over the next update.
+ */
+
+EGG_ITEST(synth_steal_fades) {
+  struct synth *synth;
+  EGG_ASSERT(synth=synth_steal_setup(SYNTH_STEAL_OLDEST))
+  float v[1024];
+  synth_updatef(v,1024,synth); // Get past the attack, so the victim is making noise.
+  EGG_ASSERT_INTS(synth->stealc,0)
+  synth_event(synth,0,0x98,0x40,0x40,10000);
+  EGG_ASSERT_INTS(synth->stealc,SYNTH_STEAL_FADE_FRAMES)
+  EGG_ASSERT_INTS(synth->stealp,0)
+  float peak=0.0f,endpeak=0.0f;
+  int i=0; for (;i<SYNTH_STEAL_FADE_FRAMES;i++) {
+    float a=synth->steall[i];
+    if (a<0.0f) a=-a;
+    if (a>peak) peak=a;
+    if ((i>=SYNTH_STEAL_FADE_FRAMES-8)&&(a>endpeak)) endpeak=a;
+  }
+  EGG_ASSERT(peak>0.0f,"Stolen voice's tail is silent; was it sounding?")
+  EGG_ASSERT(endpeak<=peak*(8.0f/SYNTH_STEAL_FADE_FRAMES)+0.0001f,"peak=%f endpeak=%f",peak,endpeak)
+
+  // Play it out in two pieces.
+  synth_updatef(v,SYNTH_STEAL_FADE_FRAMES/2,synth);
+  EGG_ASSERT_INTS(synth->stealp,SYNTH_STEAL_FADE_FRAMES/2)
+  synth_updatef(v,SYNTH_STEAL_FADE_FRAMES,synth);
+  EGG_ASSERT_INTS(synth->stealc,0)
+  EGG_ASSERT_INTS(synth->stealp,0)
+  synth_del(synth);
+  return 0;
+}
@@ -0,0 +1,131 @@
+#include "test/egg_test.h"
+#define USE_REAL_STDLIB 1
+#include "opt/text/strings.c"
+#include "opt/serial/serial.h"
+#include <time.h>
+
+/* strings.c is a client library, so we supply the one platform call it makes.
+ */
+
+#define STRINGS_TEST_LANG 0x0123
+
+int egg_get_language() {
+  return STRINGS_TEST_LANG;
+}
+
+/* Build a ROM with metadata:1 and one strings resource at (lang,1).
+ * String (i) is empty every 7th, long enough for a two-byte length every 11th, and otherwise short.
+ */
+
+static int strings_test_resource(struct sr_encoder *dst,int stringc) {
+  if (sr_encode_raw(dst,"\0ES\xff",4)<0) return -1;
+  char tmp[300];
+  int i=0; for (;i<stringc;i++) {
+    int len=0;
+    if (!(i%7)) len=0;
+    else if (!(i%11)) len=200+i%50;
+    else len=snprintf(tmp,sizeof(tmp),"String %d.",i);
+    if (len>=128) {
+      memset(tmp,'a'+i%26,len);
+      if (sr_encode_u8(dst,0x80|(len>>8))<0) return -1;
+    }
+    if (sr_encode_u8(dst,len)<0) return -1;
+    if (sr_encode_raw(dst,tmp,len)<0) return -1;
+  }
+  return 0;
+}
+
+static int strings_test_rom(struct sr_encoder *dst,int stringc) {
+  struct sr_encoder res={0};
+  if (strings_test_resource(&res,stringc)<0) return -1;
+  if (sr_encode_raw(dst,"\0EGG",4)<0) return -1;
+  if (sr_encode_raw(dst,"\x80\x03\0EM\xff",6)<0) return -1; // metadata:1, empty.
+  if (sr_encode_u8(dst,EGG_TID_strings-EGG_TID_metadata)<0) return -1;
+  int d=((STRINGS_TEST_LANG<<6)|1)-1;
+  for (;d>0x3fff;d-=0x3fff) if (sr_encode_intbe(dst,0x7fff,2)<0) return -1;
+  if (sr_encode_intbe(dst,0x4000|d,2)<0) return -1;
+  if (res.c>=16385) {
+    if (sr_encode_intbe(dst,0xc00000|(res.c-16385),3)<0) return -1;
+  } else {
+    if (sr_encode_intbe(dst,0x8000|(res.c-1),2)<0) return -1;
+  }
+  if (sr_encode_raw(dst,res.v,res.c)<0) return -1;
+  if (sr_encode_u8(dst,0)<0) return -1;
+  sr_encoder_cleanup(&res);
+  return 0;
+}
+
+/* What strings_get used to do: Walk the resource with rom_read_strings until we reach the index.
+ */
+
+static int strings_test_scan(void *dstpp,int index) {
+  const void *src=0;
+  int p=rom_index_search(&strings.index,EGG_TID_strings,(STRINGS_TEST_LANG<<6)|1);
+  if (p<0) return 0;
+  struct strings_get_ctx ctx={.dstpp=dstpp,.index=index};
+  rom_read_strings(strings.resv[p].v,strings.resv[p].c,strings_get_cb,&ctx);
+  return ctx.dstc;
+}
+
+EGG_ITEST(strings_get_indexed) {
+  struct sr_encoder rom={0};
+  EGG_ASSERT_CALL(strings_test_rom(&rom,500))
+  strings_set_rom(rom.v,rom.c);
+  const char *v=0;
+  EGG_ASSERT_INTS(strings_get(&v,1,1),9) // Make sure the ROM is right, or everything would match at zero.
+  int i=0; for (;i<510;i++) {
+    const char *expect=0,*actual=0;
+    int expectc=strings_test_scan(&expect,i);
+    int actualc=strings_get(&actual,1,i);
+    EGG_ASSERT_STRINGS(actual,actualc,expect,expectc,"index %d",i)
+    // Same thing by exact rid.
+    actualc=strings_get(&actual,(STRINGS_TEST_LANG<<6)|1,i);
+    EGG_ASSERT_STRINGS(actual,actualc,expect,expectc,"index %d",i)
+  }
+  EGG_ASSERT_INTS(strings_get(&v,2,0),0)
+  EGG_ASSERT_INTS(strings_get(&v,1,-1),0)
+
+  // Setting the ROM again drops the index, and the new ROM gets its own.
+  struct sr_encoder rom2={0};
+  EGG_ASSERT_CALL(strings_test_rom(&rom2,20))
+  strings_set_rom(rom2.v,rom2.c);
+  EGG_ASSERT_INTS(strings_get(&v,1,100),0)
+  int c=strings_get(&v,1,3);
+  EGG_ASSERT_STRINGS(v,c,"String 3.",-1)
+
+  strings_cleanup();
+  sr_encoder_cleanup(&rom);
+  sr_encoder_cleanup(&rom2);
+  return 0;
+}
+
+/* Random access into a 5000-string resource, old scan vs strings_get.
+ */
+
+static double strings_bench_now() {
+  struct timespec tv={0};
+  clock_gettime(CLOCK_MONOTONIC,&tv);
+  return (double)tv.tv_sec+(double)tv.tv_nsec/1000000000.0;
+}
+
+XXX_EGG_ITEST(strings_get_bench,bench) {
+  struct sr_encoder rom={0};
+  EGG_ASSERT_CALL(strings_test_rom(&rom,5000))
+  strings_set_rom(rom.v,rom.c);
+  int pass=0; for (;pass<2;pass++) {
+    int repc=pass?10000000:20000;
+    uint32_t seed=1;
+    int total=0,i=repc;
+    double starttime=strings_bench_now();
+    while (i-->0) {
+      seed=seed*1103515245+12345;
+      const char *v;
+      total+=pass?strings_get(&v,1,(seed>>8)%5000):strings_test_scan(&v,(seed>>8)%5000);
+    }
+    double elapsed=strings_bench_now()-starttime;
+    fprintf(stderr,"%s: %-7s %.03f M lookups/s (%d)\n",__func__,pass?"indexed":"scan",repc/elapsed/1000000.0,total);
+  }
+  strings_cleanup();
+  sr_encoder_cleanup(&rom);
+  return 0;
+}
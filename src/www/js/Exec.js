@@ -37,6 +37,8 @@ export class Exec {
       egg_texture_get_pixels: (dstp, dsta, texid) => this.rt.video.egg_texture_get_pixels(dstp, dsta, texid),
       egg_texture_load_image: (texid, rid) => this.rt.video.egg_texture_load_image(texid, rid),
       egg_texture_load_raw: (texid, fmt, w, h, stride, srcp, srcc) => this.rt.video.egg_texture_load_raw(texid, fmt, w, h, stride, srcp, srcc),
+      egg_texture_load_image_sub: (texid, x, y, w, h, rid) => this.rt.video.egg_texture_load_image_sub(texid, x, y, w, h, rid),
+      egg_image_get_size: (wp, hp, rid) => this.rt.video.egg_image_get_size(wp, hp, rid),
       egg_draw_globals: (t, a) => this.rt.video.egg_draw_globals(t, a),
       egg_draw_clear: (dt, rgba) => this.rt.video.egg_draw_clear(dt, rgba),
       egg_draw_line: (dt, vp, c) => this.rt.video.egg_draw_line(dt, vp, c),
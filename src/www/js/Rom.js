@@ -26,9 +26,15 @@ export class Rom {
     for (const res of this.resv) {
       switch (res.tid) {
         case Rom.TID_image: {
-            promises.push(this.preloadImage(res.serial).then(img => {
-              res.image = img;
-            }));
+            if ((res.serial[0] === 0x00) && (res.serial[1] === 0x45) && (res.serial[2] === 0x49) && (res.serial[3] === 0xff)) {
+              // rawimg or lzimg, produced by `eggdev pack --image-format=`. Browser can't read it, but it's trivial.
+              const pixels = this.decodeRawImage(res.serial);
+              if (pixels) res.pixels = pixels;
+            } else {
+              promises.push(this.preloadImage(res.serial).then(img => {
+                res.image = img;
+              }));
+            }
           } break;
       }
     }
@@ -53,6 +59,79 @@ export class Rom {
     });
   }
   
+  /* Decode rawimg or lzimg to RGBA, see src/opt/image/rawimg.c.
+   * Returns { w, h, rgba } or null.
+   */
+  decodeRawImage(src) {
+    if (src.length < 12) return null;
+    const w = (src[4] << 8) | src[5];
+    const h = (src[6] << 8) | src[7];
+    const pixelsize = src[8];
+    const compression = src[9];
+    if ((w < 1) || (h < 1)) return null;
+    const stride = (w * pixelsize + 7) >> 3;
+    let pixels;
+    if (compression === 0) {
+      if (src.length < 12 + stride * h) return null;
+      pixels = src.slice(12, 12 + stride * h);
+    } else if (compression === 1) {
+      if (!(pixels = this.decompressLz(src, 12, stride * h))) return null;
+    } else {
+      return null;
+    }
+    let rgba;
+    switch (pixelsize) {
+      case 32: rgba = pixels; break;
+      case 8: { // Same as image_force_rgba: Black with alpha.
+          rgba = new Uint8Array(w * h * 4);
+          for (let i=0, dstp=3; i<pixels.length; i++, dstp+=4) rgba[dstp] = pixels[i];
+        } break;
+      case 1: {
+          rgba = new Uint8Array(w * h * 4);
+          for (let y=0, dstp=0, rowp=0; y<h; y++, rowp+=stride) {
+            for (let x=0; x<w; x++, dstp+=4) {
+              if (pixels[rowp + (x >> 3)] & (0x80 >> (x & 7))) {
+                rgba[dstp] = rgba[dstp + 1] = rgba[dstp + 2] = rgba[dstp + 3] = 0xff;
+              }
+            }
+          }
+        } break;
+      default: return null;
+    }
+    return { w, h, rgba };
+  }
+  
+  decompressLz(src, srcp, dstc) {
+    const dst = new Uint8Array(dstc);
+    let dstp = 0;
+    while (srcp < src.length) {
+      const token = src[srcp++];
+      let litc = token >> 4;
+      if (litc === 15) {
+        let more;
+        do { litc += (more = src[srcp++]); } while (more === 0xff);
+      }
+      if ((srcp + litc > src.length) || (dstp + litc > dstc)) return null;
+      dst.set(src.subarray(srcp, srcp + litc), dstp);
+      srcp += litc;
+      dstp += litc;
+      if (srcp >= src.length) break;
+      const offset = src[srcp] | (src[srcp + 1] << 8);
+      srcp += 2;
+      if ((offset < 1) || (offset > dstp)) return null;
+      let matchc = token & 15;
+      if (matchc === 15) {
+        let more;
+        do { matchc += (more = src[srcp++]); } while (more === 0xff);
+      }
+      matchc += 4;
+      if (dstp + matchc > dstc) return null;
+      for (; matchc-->0; dstp++) dst[dstp] = dst[dstp - offset];
+    }
+    if (dstp !== dstc) return null;
+    return dst;
+  }
+  
   getResource(tid, rid) {
     return this.resv.find(r => ((r.tid === tid) && (r.rid === rid)))?.serial || [];
   }
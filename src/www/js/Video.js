@@ -263,10 +263,53 @@ export class Video {
     const tex = this.textures[texid];
     if (!tex) return -1;
     const res = this.rt.rom.getResourceEntry(Rom.TID_image, rid);
+    if (res?.pixels) return this.loadTexture(tex, res.pixels.w, res.pixels.h, 0, res.pixels.rgba);
     if (!res || !res.image) return -1;
     return this.loadTexture(tex, res.image.naturalWidth, res.image.naturalHeight, 0, res.image);
   }
   
+  egg_texture_load_image_sub(texid, x, y, w, h, rid) {
+    const tex = this.textures[texid];
+    if (!tex) return -1;
+    if ((w < 1) || (h < 1) || (x < 0) || (y < 0) || (x > tex.w - w) || (y > tex.h - h)) return -1;
+    const res = this.rt.rom.getResourceEntry(Rom.TID_image, rid);
+    let imgw, imgh;
+    if (res?.pixels) { imgw = res.pixels.w; imgh = res.pixels.h; }
+    else if (res?.image) { imgw = res.image.naturalWidth; imgh = res.image.naturalHeight; }
+    else return -1;
+    if ((imgw > w) || (imgh > h)) return -1;
+    
+    // Clear the whole box, then write the image over its top-left corner.
+    if (!this.requireFramebuffer(tex)) return -1;
+    this.gl.bindFramebuffer(this.gl.FRAMEBUFFER, tex.fbid);
+    this.gl.viewport(0, 0, tex.w + tex.edge_extra * 2, tex.h + tex.edge_extra * 2);
+    this.gl.enable(this.gl.SCISSOR_TEST);
+    this.gl.scissor(x + tex.edge_extra, y + tex.edge_extra, w, h);
+    this.gl.clearColor(0.0, 0.0, 0.0, 0.0);
+    this.gl.clear(this.gl.COLOR_BUFFER_BIT);
+    this.gl.disable(this.gl.SCISSOR_TEST);
+    
+    this.gl.bindTexture(this.gl.TEXTURE_2D, tex.id);
+    const dstx = x + tex.edge_extra, dsty = y + tex.edge_extra;
+    if (res.pixels) {
+      this.gl.texSubImage2D(this.gl.TEXTURE_2D, 0, dstx, dsty, imgw, imgh, this.gl.RGBA, this.gl.UNSIGNED_BYTE, res.pixels.rgba);
+    } else {
+      this.gl.texSubImage2D(this.gl.TEXTURE_2D, 0, dstx, dsty, this.gl.RGBA, this.gl.UNSIGNED_BYTE, res.image);
+    }
+    return 0;
+  }
+  
+  egg_image_get_size(wp, hp, rid) {
+    const res = this.rt.rom.getResourceEntry(Rom.TID_image, rid);
+    let w, h;
+    if (res?.pixels) { w = res.pixels.w; h = res.pixels.h; }
+    else if (res?.image) { w = res.image.naturalWidth; h = res.image.naturalHeight; }
+    else return -1;
+    if (wp) this.rt.exec.mem32[wp >> 2] = w;
+    if (hp) this.rt.exec.mem32[hp >> 2] = h;
+    return 0;
+  }
+  
   egg_texture_load_raw(texid, w, h, stride, srcp, srcc) {
     const tex = this.textures[texid];
     if (!tex) return -1;
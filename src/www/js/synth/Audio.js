@@ -23,6 +23,7 @@ export class Audio {
     this.songNode = null; // GainNode, if current song is PCM.
     this.globalTrim = 0.333;
     this.liveChannels = [];
+    this.livePanners = []; // StereoPannerNode per live channel, created as needed.
     
     /* (sounds) is populated lazy, as sound effects get asked for.
      * So an entry in (sounds) with (serial) present needs to be decoded first.
@@ -53,6 +54,8 @@ export class Audio {
     if (!this.ctx) return;
     for (const channel of this.liveChannels) channel?.cancel(this.ctx);
     this.liveChannels = [];
+    for (const panner of this.livePanners) panner?.disconnect();
+    this.livePanners = [];
     if (this.ctx.state === "running") {
       this.ctx.suspend();
     }
@@ -130,6 +133,8 @@ export class Audio {
     }
     this.songBufferNode = null;
     this.songid = 0;
+    // Native clears its channels here, pan included. Match it, so pan doesn't leak into the next song.
+    for (const panner of this.livePanners) if (panner) panner.pan.value = 0;
   }
   
   setLiveChannel(chcfg) {
@@ -141,10 +146,22 @@ export class Audio {
     if (channel) {
       channel.cancelHard(this.ctx);
     }
-    channel = new Channel(chcfg, this.ctx, this.ctx.destination, 1.0/*this.globalTrim*/);
+    const panner = this.getLivePanner(chid);
+    panner.pan.value = 0;
+    channel = new Channel(chcfg, this.ctx, panner, 1.0/*this.globalTrim*/);
     this.liveChannels[chid] = channel;
   }
   
+  getLivePanner(chid) {
+    while (chid >= this.livePanners.length) this.livePanners.push(null);
+    let panner = this.livePanners[chid];
+    if (!panner) {
+      panner = this.livePanners[chid] = new StereoPannerNode(this.ctx);
+      panner.connect(this.ctx.destination);
+    }
+    return panner;
+  }
+  
   /* Platform entry points.
    ****************************************************************************/
   
@@ -182,12 +199,15 @@ export class Audio {
       if (!channel) {
         const cfg = this.configureLiveChannel(chid);
         if (!cfg) return;
-        channel = this.liveChannels[chid] = new Channel(cfg, this.ctx, this.ctx.destination, this.globalTrim);
+        channel = this.liveChannels[chid] = new Channel(cfg, this.ctx, this.getLivePanner(chid), this.globalTrim);
       }
       switch (opcode) {
         case 0x89: channel.playNote(this.ctx, this.ctx.currentTime, a, b / 127.0, durms); break;
         case 0x80: channel.endNote(this.ctx, this.ctx.currentTime, a, b / 127.0); break;
         case 0x90: channel.beginNote(this.ctx, this.ctx.currentTime, a, b / 127.0); break;
+        case 0xb0: switch (a) {
+            case 0x0a: this.getLivePanner(chid).pan.value = Math.max(-1, (b - 0x40) / 63); break;
+          } break;
       }
     } else switch (opcode) {
       case 0xff: {